@@ -15,6 +15,11 @@ static constexpr utils::Version VERSION(0, 45, 0, utils::version::prerelease::be
     #include "utils_lib/utils_logger.hpp"
     #include "utils_lib/utils_time.hpp"
     #include "utils_lib/utils_profiler.hpp"
+#elif defined(ENABLE_BENCHMARKS)
+    HEDLEY_WARNING("Warning: BENCHMARKS ENABLED")
+
+    #include "utils_lib/utils_benchmark.hpp"
+    #include "utils_lib/utils_logger.hpp"
 #else
     HEDLEY_WARNING("Warning: TESTS DISABLED")
 
@@ -22,11 +27,14 @@ static constexpr utils::Version VERSION(0, 45, 0, utils::version::prerelease::be
     #include "utils_lib/utils_http.hpp"
 
     #include "utils_lib/utils_exceptions.hpp"
+    #include "utils_lib/utils_aio.hpp"
     #include "utils_lib/utils_algorithm.hpp"
     #include "utils_lib/utils_bits.hpp"
     #include "utils_lib/utils_colour.hpp"
     #include "utils_lib/utils_crc.hpp"
     #include "utils_lib/utils_csv.hpp"
+    #include "utils_lib/utils_fingerprint.hpp"
+    #include "utils_lib/utils_hash.hpp"
 //    #include "utils_lib/utils_http.hpp"
     #include "utils_lib/utils_ini.hpp"
     #include "utils_lib/utils_io.hpp"
@@ -39,6 +47,7 @@ static constexpr utils::Version VERSION(0, 45, 0, utils::version::prerelease::be
     #include "utils_lib/utils_print.hpp"
     #include "utils_lib/utils_profiler.hpp"
     #include "utils_lib/utils_random.hpp"
+    #include "utils_lib/utils_serial.hpp"
     #include "utils_lib/utils_sqlite.hpp"
     #include "utils_lib/utils_string.hpp"
     #include "utils_lib/utils_test.hpp"
@@ -47,7 +56,12 @@ static constexpr utils::Version VERSION(0, 45, 0, utils::version::prerelease::be
     #include "utils_lib/utils_traits.hpp"
     #include "utils_lib/utils_xorstring.hpp"
 
+    #include "utils_lib/algo/algo_histogram.hpp"
+    #include "utils_lib/algo/algo_block_codec.hpp"
+    #include "utils_lib/algo/algo_ans.hpp"
     #include "utils_lib/algo/algo_huffman.hpp"
+    #include "utils_lib/algo/algo_dictionary.hpp"
+    #include "utils_lib/algo/algo_lz.hpp"
     #include "utils_lib/algo/algo_bstree.hpp"
     #include "utils_lib/algo/algo_avltree.hpp"
     #include "utils_lib/crypto/crypto_feistel.hpp"
@@ -145,6 +159,11 @@ int main(int argc, char *argv[]) {
 
     utils::Logger::Notice("Tests completed in %.3f ms (%d)", test_duration, status);
     return status;
+#elif defined(ENABLE_BENCHMARKS)
+    utils::Logger::SetScreenTitle("Benchmarking C++ Utility library " + VERSION.to_string());
+    utils::Logger::WriteLn("Running benchmarks...");
+
+    return utils::benchmark::run(argc, argv, VERSION.to_string());
 #else
     UTILS_PROFILE_BEGIN_SESSION("utils_profile.json");
     UNUSED(argc, argv);
@@ -209,5 +228,5 @@ int main(int argc, char *argv[]) {
     utils::Logger::Stream("\n\n", utils::memory::Metrics, "\n");
 
     return 0;
-#endif  // ENABLE_TESTS
+#endif  // ENABLE_TESTS / ENABLE_BENCHMARKS
 }
@@ -0,0 +1,100 @@
+#ifdef ENABLE_BENCHMARKS
+#include "../utils_lib/utils_benchmark.hpp"
+
+#include "../utils_lib/utils_string.hpp"
+#include "../utils_lib/algo/algo_ans.hpp"
+#include "../utils_lib/algo/algo_huffman.hpp"
+#include "../utils_lib/algo/algo_lz.hpp"
+#include "../utils_lib/crypto/crypto_aes.hpp"
+#include "../utils_lib/crypto/crypto_feistel.hpp"
+
+#include <array>
+
+/**
+ *  Codecs on the BitStreamReader/-Writer interface, with \p Coder constructed per call.
+ */
+template<class Coder, class... Args>
+static utils::benchmark::Codec stream_codec(std::string name, Args... args) {
+    return utils::benchmark::Codec{
+        std::move(name),
+        [args...](const std::vector<uint8_t>& data) {
+            utils::io::BitStreamReader reader(data);
+            Coder coder(args...);
+            const auto writer = coder.encode(reader);
+            return std::vector<uint8_t>(writer->get_buffer(), writer->get_buffer() + writer->get_last_byte_position());
+        },
+        [args...](const std::vector<uint8_t>& data) {
+            utils::io::BitStreamReader reader(data);
+            Coder coder(args...);
+            const auto decoded = coder.decode(reader);
+            return std::vector<uint8_t>(decoded->get_buffer(), decoded->get_buffer() + decoded->get_size());
+        }
+    };
+}
+
+/**
+ *  Adapts the compress/decompress names of algo::LZ.
+ */
+template<int LEVEL, bool ENTROPY>
+struct LZCoder : utils::algo::LZ {
+    LZCoder(void) : utils::algo::LZ(LEVEL, ENTROPY) {}
+
+    auto encode(utils::io::BitStreamReader& reader) { return this->compress(reader); }
+    auto decode(utils::io::BitStreamReader& reader) { return this->decompress(reader); }
+};
+
+static const std::array<uint8_t, 32> aes_key = {
+    0x60, 0x3d, 0xeb, 0x10, 0x15, 0xca, 0x71, 0xbe, 0x2b, 0x73, 0xae, 0xf0, 0x85, 0x7d, 0x77, 0x81,
+    0x1f, 0x35, 0x2c, 0x07, 0x3b, 0x61, 0x08, 0xd7, 0x2d, 0x98, 0x10, 0xa3, 0x09, 0x14, 0xdf, 0xf4
+};
+static const std::array<uint8_t, 16> aes_iv = {
+    0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f
+};
+
+static const utils::benchmark::Register huffman{ stream_codec<utils::algo::Huffman<uint8_t>>("huffman") };
+static const utils::benchmark::Register huffman_mt{ [] {
+    auto codec = stream_codec<utils::algo::Huffman<uint8_t>>("huffman-4t");
+    codec.encode = [](const std::vector<uint8_t>& data) {
+        utils::io::BitStreamReader reader(data);
+        const auto writer = utils::algo::Huffman<uint8_t>().encode(reader, size_t(4));
+        return std::vector<uint8_t>(writer->get_buffer(), writer->get_buffer() + writer->get_last_byte_position());
+    };
+    return codec;
+}() };
+static const utils::benchmark::Register rans{ stream_codec<utils::algo::RANS>("rans") };
+static const utils::benchmark::Register lz_fast{ stream_codec<LZCoder<1, false>>("lz-1") };
+static const utils::benchmark::Register lz{ stream_codec<LZCoder<utils::algo::LZ::DEFAULT_LEVEL, false>>("lz-6") };
+static const utils::benchmark::Register lz_huffman{ stream_codec<LZCoder<utils::algo::LZ::DEFAULT_LEVEL, true>>("lz-6-huffman") };
+static const utils::benchmark::Register feistel{ [] {
+    auto codec = stream_codec<utils::crypto::FeistelCipher<>>("feistel");
+    codec.alignment = 8;
+    return codec;
+}() };
+
+static const utils::benchmark::Register aes{ utils::benchmark::Codec{
+    "aes-256-cbc",
+    [](const std::vector<uint8_t>& data) {
+        uint32_t length = 0;
+        const auto out = utils::crypto::AES(256).EncryptCBC(data.data(), uint32_t(data.size()), aes_key.data(), aes_iv.data(), length);
+        return std::vector<uint8_t>(out.get(), out.get() + length);
+    },
+    [](const std::vector<uint8_t>& data) {
+        const auto out = utils::crypto::AES(256).DecryptCBC(data.data(), uint32_t(data.size()), aes_key.data(), aes_iv.data());
+        return std::vector<uint8_t>(out.get(), out.get() + data.size());
+    },
+    16
+} };
+
+static const utils::benchmark::Register base64{ utils::benchmark::Codec{
+    "base64",
+    [](const std::vector<uint8_t>& data) {
+        const std::string encoded = utils::string::to_base64(data.data(), data.size());
+        return std::vector<uint8_t>(encoded.begin(), encoded.end());
+    },
+    [](const std::vector<uint8_t>& data) {
+        const std::string decoded = utils::string::from_base64(data.data(), data.size());
+        return std::vector<uint8_t>(decoded.begin(), decoded.end());
+    }
+} };
+
+#endif
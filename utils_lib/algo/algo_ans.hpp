@@ -0,0 +1,380 @@
+#ifndef ALGO_ANS_HPP
+#define ALGO_ANS_HPP
+
+#include "../utils_compiler.hpp"
+#include "../utils_bits.hpp"
+#include "../utils_exceptions.hpp"
+#include "../utils_io.hpp"
+#include "algo_block_codec.hpp"
+#include "algo_histogram.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+
+namespace utils::algo {
+
+    /**
+     *  @brief  Range asymmetric numeral systems (rANS) coder for bytes.
+     *
+     *          Symbol frequencies are normalized to a total of 2^PROB_BITS, a symbol
+     *          with frequency f costs close to PROB_BITS - log2(f) bits, so skewed
+     *          distributions code below the one bit per symbol of Huffman codes.
+     *          The state is 32 bits, kept in [STATE_LOW, STATE_LOW * 256) by moving
+     *          whole bytes. STATES states are interleaved: symbol i uses state i % STATES,
+     *          so the decoder works on independent dependency chains sharing one stream.
+     *
+     *          Blocks are framed by BlockCodec. A rANS block's payload is the table, the
+     *          highest used symbol (8 bits) then per symbol up to it its frequency as an
+     *          Exp-Golomb code, zero padded to a byte, then the final encoder states
+     *          (little endian, 32 bits each, state 0 first) and the renormalization bytes
+     *          in decoding order.
+     *
+     *          Tables are sized once per object, coding a block does not allocate beyond
+     *          the reused scratch buffer.
+     */
+    class RANS : public BlockCodec<RANS> {
+        friend class BlockCodec<RANS>;
+
+        public:
+            static constexpr inline uint32_t PROB_BITS = 12u;                    ///< Frequencies sum to 2^PROB_BITS
+            static constexpr inline uint32_t PROB_SCALE = 1u << PROB_BITS;
+            static constexpr inline uint32_t STATE_LOW = 1u << 23;               ///< Lower bound of a normalized state
+            static constexpr inline size_t   STATES    = 4u;                     ///< Interleaved states
+
+            static_assert(STATES == 4u, "utils::algo::RANS: Decoding is unrolled for 4 states.");
+
+            static constexpr inline uint32_t FRAME_MAGIC   = 0x5552414Eu;          ///< "URAN"
+            static constexpr inline uint8_t  FRAME_VERSION = 1u;
+
+            /**
+             *  How a block is stored.
+             */
+            enum BlockType : uint8_t {
+                BLOCK_RANS = 1u,    ///< Frequency table and rANS stream
+            };
+
+        private:
+            static constexpr inline const char *NAME = "RANS";  ///< Log prefix
+
+            /**
+             *  Encoder parameters of a symbol, the division by the frequency
+             *  is a multiplication by its reciprocal.
+             */
+            struct EncSymbol {
+                uint32_t x_max;      ///< States at or above are renormalized first
+                uint32_t rcp_freq;   ///< Fixed point reciprocal of the frequency
+                uint32_t bias;
+                uint32_t cmpl_freq;  ///< PROB_SCALE - frequency
+                uint32_t rcp_shift;
+            };
+
+            /**
+             *  Decoder slot, one per value of the low PROB_BITS bits of the state.
+             */
+            struct DecSlot {
+                uint16_t freq;
+                uint16_t start;      ///< Cumulative frequency of the symbol
+                uint8_t  symbol;
+            };
+
+            std::vector<uint32_t>  freqs;    ///< Normalized frequency per symbol
+            std::vector<EncSymbol> enc;
+            std::vector<DecSlot>   slots;
+            std::vector<uint8_t>   scratch;  ///< Encoder output, written backward
+
+            ATTR_NORETURN
+            static void error(const std::string& msg) {
+                throw utils::exceptions::Exception("utils::algo::RANS", msg);
+            }
+
+            /**
+             *  @brief  Normalize the histogram of the \p size bytes at \p data, every
+             *          present symbol keeps a frequency of at least 1.
+             */
+            void normalize(const uint8_t *data, size_t size) {
+                uint32_t counts[HISTOGRAM_BINS];
+                algo::histogram(data, size, counts);
+
+                uint32_t total = 0;
+                size_t largest = 0;
+
+                for (size_t symbol = 0; symbol < HISTOGRAM_BINS; symbol++) {
+                    const uint32_t count = counts[symbol];
+                    this->freqs[symbol] = count == 0 ? 0u : std::max<uint32_t>(1u, uint32_t((uint64_t(count) * PROB_SCALE + size / 2u) / size));
+
+                    total += this->freqs[symbol];
+                    if (counts[symbol] > counts[largest]) {
+                        largest = symbol;
+                    }
+                }
+
+                if (total < PROB_SCALE) {
+                    this->freqs[largest] += PROB_SCALE - total;
+                }
+
+                // Rounding overshot, take the excess from the most frequent symbols
+                while (total > PROB_SCALE) {
+                    const auto most = std::max_element(this->freqs.begin(), this->freqs.end());
+                    const uint32_t take = std::min(total - PROB_SCALE, *most / 2u);
+
+                    *most -= take;
+                    total -= take;
+                }
+            }
+
+            /**
+             *  @brief  Build the encoder parameters from the normalized frequencies.
+             */
+            void build_encoder(void) {
+                uint32_t start = 0;
+
+                for (size_t symbol = 0; symbol < HISTOGRAM_BINS; symbol++) {
+                    const uint32_t freq = this->freqs[symbol];
+                    EncSymbol& s = this->enc[symbol];
+
+                    s.x_max     = ((STATE_LOW >> PROB_BITS) << 8) * freq;
+                    s.cmpl_freq = PROB_SCALE - freq;
+
+                    if (freq < 2u) {
+                        // x / 1 == (x * (2^32 - 1)) >> 32 + 1, the +1 folded into the bias
+                        s.rcp_freq  = ~0u;
+                        s.rcp_shift = 32u;
+                        s.bias      = start + PROB_SCALE - 1u;
+                    } else {
+                        uint32_t shift = 0;
+                        while (freq > (1u << shift)) {
+                            shift++;
+                        }
+
+                        s.rcp_freq  = uint32_t(((uint64_t(1) << (shift + 31u)) + freq - 1u) / freq);
+                        s.rcp_shift = shift - 1u + 32u;
+                        s.bias      = start;
+                    }
+
+                    start += freq;
+                }
+            }
+
+            /**
+             *  @brief  Build the decoder slots from the normalized frequencies.
+             *  @exception Exception
+             *      Throws Exception if the frequencies do not sum to PROB_SCALE.
+             */
+            void build_decoder(void) {
+                uint32_t start = 0;
+
+                for (size_t symbol = 0; symbol < HISTOGRAM_BINS; symbol++) {
+                    const uint32_t freq = this->freqs[symbol];
+
+                    if (HEDLEY_UNLIKELY(freq > PROB_SCALE - start)) {
+                        error("Invalid frequency table.");
+                    }
+
+                    std::fill_n(this->slots.begin() + start, freq, DecSlot{ uint16_t(freq), uint16_t(start), uint8_t(symbol) });
+                    start += freq;
+                }
+
+                if (HEDLEY_UNLIKELY(start != PROB_SCALE)) {
+                    error("Invalid frequency table.");
+                }
+            }
+
+            void write_table(utils::io::BitStreamWriter& writer) const {
+                size_t last = HISTOGRAM_BINS - 1u;
+                while (this->freqs[last] == 0) {
+                    last--;
+                }
+
+                writer.put(8, last);
+                for (size_t symbol = 0; symbol <= last; symbol++) {
+                    writer.put_exp_golomb(this->freqs[symbol]);
+                }
+            }
+
+            /**
+             *  @exception Exception
+             *      Throws Exception if the table is invalid.
+             */
+            void read_table(utils::io::BitStreamReader& reader) {
+                std::fill(this->freqs.begin(), this->freqs.end(), 0u);
+
+                const size_t last = reader.get(8);
+
+                for (size_t symbol = 0; symbol <= last; symbol++) {
+                    const uint64_t freq = reader.get_exp_golomb();
+
+                    if (HEDLEY_UNLIKELY(freq > PROB_SCALE)) {
+                        error("Invalid frequency table.");
+                    }
+                    this->freqs[symbol] = uint32_t(freq);
+                }
+
+                if (HEDLEY_UNLIKELY(reader.get_position() > reader.get_size_bits())) {
+                    error("Truncated table.");
+                }
+
+                this->build_decoder();
+            }
+
+            /**
+             *  @brief  Encode \p symbol into \p state, renormalizing into the bytes before \p ptr.
+             */
+            HEDLEY_ALWAYS_INLINE
+            static void put(uint32_t& state, uint8_t*& ptr, const EncSymbol& s) {
+                uint32_t x = state;
+
+                while (x >= s.x_max) {
+                    *--ptr = uint8_t(x);
+                    x >>= 8;
+                }
+
+                const uint32_t q = uint32_t((uint64_t(x) * s.rcp_freq) >> s.rcp_shift);
+                state = x + s.bias + q * s.cmpl_freq;
+            }
+
+            /**
+             *  @brief  Decode one symbol from \p state without renormalizing.
+             */
+            HEDLEY_ALWAYS_INLINE
+            uint8_t get(uint32_t& state) const {
+                const DecSlot& slot = this->slots[state & (PROB_SCALE - 1u)];
+                state = slot.freq * (state >> PROB_BITS) + (state & (PROB_SCALE - 1u)) - slot.start;
+                return slot.symbol;
+            }
+
+            /**
+             *  @brief  Append the payload of the block with the \p size input bytes
+             *          at \p data to \p writer.
+             *  @return Returns the block type.
+             */
+            uint8_t encode_payload(const uint8_t *data, size_t size, utils::io::BitStreamWriter& writer) {
+                this->normalize(data, size);
+                this->build_encoder();
+                this->write_table(writer);
+                writer.flush();
+
+                // At most 2 renormalization bytes per symbol
+                this->scratch.resize(2u * size + STATES * 4u);
+                uint8_t *const end = this->scratch.data() + this->scratch.size();
+                uint8_t *ptr = end;
+
+                uint32_t states[STATES] = { STATE_LOW, STATE_LOW, STATE_LOW, STATE_LOW };
+
+                // Backward, the decoder reads the stream forward
+                for (size_t i = size; i-- > 0; ) {
+                    put(states[i % STATES], ptr, this->enc[data[i]]);
+                }
+
+                for (size_t i = STATES; i-- > 0; ) {
+                    ptr -= 4;
+                    utils::bits::store_little_endian(ptr, states[i]);
+                }
+
+                writer.write_bytes(ptr, size_t(end - ptr));
+
+                return BLOCK_RANS;
+            }
+
+            /**
+             *  @brief  Decode the payload \p block of type \p type into the \p size bytes at \p out.
+             *  @exception Exception
+             *      Throws Exception if the payload is corrupt.
+             */
+            void decode_payload(uint8_t type, utils::io::BitStreamReader& block, uint8_t *out, size_t size) {
+                if (HEDLEY_UNLIKELY(type != BLOCK_RANS)) {
+                    error("Unknown block type.");
+                }
+
+                this->read_table(block);
+                block.flush();
+
+                const size_t offset = block.get_position() / 8u;
+                if (HEDLEY_UNLIKELY(offset > block.get_size() || block.get_size() - offset < STATES * 4u)) {
+                    error("Truncated block.");
+                }
+
+                const uint8_t *ptr = block.get_buffer() + offset;
+                const uint8_t *const end = block.get_buffer() + block.get_size();
+
+                uint32_t states[STATES];
+                for (size_t i = 0; i < STATES; i++, ptr += 4) {
+                    states[i] = utils::bits::load_little_endian<uint32_t>(ptr);
+
+                    // Keeps every step below 2 renormalization bytes
+                    if (HEDLEY_UNLIKELY(states[i] < STATE_LOW || states[i] >= STATE_LOW << 8)) {
+                        error("Invalid state.");
+                    }
+                }
+
+                const auto renormalize = [](uint32_t& state, const uint8_t*& p) {
+                    while (state < STATE_LOW) {
+                        state = (state << 8) | *p++;
+                    }
+                };
+
+                size_t i = 0;
+
+                // A round reads at most 2 bytes per state, no bounds checks while 8 remain
+                for (; i + STATES <= size && end - ptr >= 8; i += STATES) {
+                    out[i + 0] = this->get(states[0]);
+                    out[i + 1] = this->get(states[1]);
+                    out[i + 2] = this->get(states[2]);
+                    out[i + 3] = this->get(states[3]);
+
+                    renormalize(states[0], ptr);
+                    renormalize(states[1], ptr);
+                    renormalize(states[2], ptr);
+                    renormalize(states[3], ptr);
+                }
+
+                for (; i < size; i++) {
+                    uint32_t& state = states[i % STATES];
+                    out[i] = this->get(state);
+
+                    while (state < STATE_LOW) {
+                        if (HEDLEY_UNLIKELY(ptr == end)) {
+                            error("Truncated block.");
+                        }
+                        state = (state << 8) | *ptr++;
+                    }
+                }
+
+                // The encoder started from STATE_LOW in every state
+                for (const uint32_t state : states) {
+                    if (HEDLEY_UNLIKELY(state != STATE_LOW)) {
+                        error("Invalid final state.");
+                    }
+                }
+
+                if (HEDLEY_UNLIKELY(ptr != end)) {
+                    error("Trailing bytes in block.");
+                }
+            }
+
+        public:
+            /**
+             *  @brief  Default ctor
+             *
+             *  @param  block_size
+             *      Input bytes per independently coded block.
+             *      Only used for encoding, decoding takes it from the frame.
+             */
+            explicit RANS(size_t block_size = DEFAULT_BLOCK_SIZE)
+                : BlockCodec<RANS>(block_size)
+                , freqs(HISTOGRAM_BINS), enc(HISTOGRAM_BINS), slots(PROB_SCALE)
+            {
+                // Empty
+            }
+
+            /**
+             *  @brief  The normalized frequency per byte value of the last coded block.
+             */
+            inline const std::vector<uint32_t>& get_freqs(void) const {
+                return this->freqs;
+            }
+    };
+}
+
+#endif // ALGO_ANS_HPP
@@ -0,0 +1,579 @@
+#ifndef ALGO_BLOCK_CODEC_HPP
+#define ALGO_BLOCK_CODEC_HPP
+
+#include "../utils_memory.hpp"
+#include "../utils_bits.hpp"
+#include "../utils_crc.hpp"
+#include "../utils_exceptions.hpp"
+#include "../utils_logger.hpp"
+#include "../utils_io.hpp"
+#include "../utils_threading.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <future>
+#include <vector>
+
+namespace utils::algo {
+
+    /**
+     *  @brief  Block framing shared by the entropy coders.
+     *
+     *          Input is split in blocks that are coded independently. The frame (big endian) is:
+     *              magic (32 bits), version (8 bits), LEB128 input size, LEB128 block size
+     *              index: per block its size in bytes, header included (32 bits)
+     *              per block: type (8 bits), payload size (32 bits),
+     *                         CRC-32 of the block's input (32 bits), payload
+     *          A block that does not compress is stored as is. The index locates every block
+     *          without reading the ones before it, for random access and for encoding and
+     *          decoding the blocks in parallel on a ThreadPool.
+     *
+     *          Derived provides FRAME_MAGIC, FRAME_VERSION, NAME, error(msg), a ctor taking
+     *          the block size and the payload coding (befriend BlockCodec to keep it private):
+     *              uint8_t encode_payload(const uint8_t *data, size_t size, BitStreamWriter& writer)
+     *                  appends the byte aligned payload of a block, returns its type (not BLOCK_STORED)
+     *              void decode_payload(uint8_t type, BitStreamReader& payload, uint8_t *out, size_t size)
+     *
+     *  @tparam Derived The coder.
+     *  @tparam Align   Block sizes are multiples of this (the symbol size).
+     */
+    template<class Derived, size_t Align = 1>
+    class BlockCodec {
+        public:
+            static constexpr inline size_t  DEFAULT_BLOCK_SIZE = 128u * 1024u;     ///< Input bytes per block
+            static constexpr inline size_t  MAX_BLOCK_SIZE     = 64u * 1024u * 1024u;
+            static constexpr inline size_t  BLOCK_HEADER_BYTES = 9u;
+            static constexpr inline uint8_t BLOCK_STORED       = 0u;               ///< Block type of input bytes as is
+
+        protected:
+            size_t block_size;
+
+            explicit BlockCodec(size_t block_size)
+                : block_size(std::clamp(block_size - block_size % Align, Align, MAX_BLOCK_SIZE))
+            {
+                // Empty
+            }
+
+            static inline uint32_t checksum(const uint8_t *data, size_t size) {
+                static const utils::CRC::Table<uint32_t, 32> table(utils::CRC::CRC_32());
+                return utils::CRC::Calculate(data, size, table);
+            }
+
+        private:
+            inline Derived& derived(void) {
+                return static_cast<Derived&>(*this);
+            }
+
+            /**
+             *  @brief  Append one block with the \p size input bytes at \p data to \p writer,
+             *          which must be byte aligned.
+             */
+            void encode_block(const uint8_t *data, size_t size, utils::io::BitStreamWriter& writer) {
+                const size_t start = writer.get_position();
+                const uint32_t crc = checksum(data, size);
+
+                writer.put(8, 0);               // Type and payload size, set below
+                writer.put(32, 0);
+                writer.put(32, crc);
+
+                const size_t  payload_start = writer.get_position() / 8u;
+                const uint8_t type          = this->derived().encode_payload(data, size, writer);
+                const size_t  payload       = writer.get_position() / 8u - payload_start;
+
+                if (payload >= size) {
+                    // No gain, store the input instead
+                    writer.set_position(start);
+                    writer.put(8, BLOCK_STORED);
+                    writer.put(32, size);
+                    writer.put(32, crc);
+                    writer.write_bytes(data, size);
+                } else {
+                    writer.get_buffer()[payload_start - 9u] = type;
+                    utils::bits::store_big_endian(writer.get_buffer() + payload_start - 8u, uint32_t(payload));
+                }
+            }
+
+            /**
+             *  @brief  Decode the block at the (byte aligned) position of \p reader into
+             *          the \p size bytes at \p out and move past it.
+             *  @exception Exception
+             *      Throws Exception if the block is corrupt.
+             */
+            void decode_block(utils::io::BitStreamReader& reader, uint8_t *out, size_t size) {
+                const uint8_t  type    = uint8_t(reader.get(8));
+                const size_t   payload = reader.get(32);
+                const uint32_t crc     = reader.get(32);
+                const size_t   offset  = reader.get_position() / 8u;
+
+                if (HEDLEY_UNLIKELY(offset > reader.get_size() || payload > reader.get_size() - offset)) {
+                    Derived::error("Truncated block.");
+                }
+
+                uint8_t *const data = reader.get_buffer() + offset;
+
+                if (type == BLOCK_STORED) {
+                    if (HEDLEY_UNLIKELY(payload != size)) {
+                        Derived::error("Invalid stored block.");
+                    }
+                    std::memcpy(out, data, size);
+                } else {
+                    utils::io::BitStreamReader block(data, payload);
+                    this->derived().decode_payload(type, block, out, size);
+                }
+
+                if (HEDLEY_UNLIKELY(checksum(out, size) != crc)) {
+                    Derived::error("Checksum mismatch.");
+                }
+
+                reader.set_position((offset + payload) * 8u);
+            }
+
+            /**
+             *  Layout of a frame, as read from its header and index.
+             */
+            struct Frame {
+                uint64_t            length;      ///< Decoded size in bytes
+                size_t              block_size;  ///< Input bytes per block
+                std::vector<size_t> offsets;     ///< Byte offset of every block in the stream, then of the end
+            };
+
+            /**
+             *  @brief  Write the frame header and a zeroed index for \p blocks blocks.
+             *  @return Returns the byte offset of the index.
+             */
+            size_t write_header(utils::io::BitStreamWriter& writer, size_t original_length, size_t blocks) const {
+                writer.put(32, Derived::FRAME_MAGIC);
+                writer.put(8, Derived::FRAME_VERSION);
+                writer.put_leb128(original_length);
+                writer.put_leb128(this->block_size);
+
+                const size_t index = writer.get_position() / 8u;
+                for (size_t i = 0; i < blocks; i++) {
+                    writer.put(32, 0);
+                }
+
+                return index;
+            }
+
+            /**
+             *  @brief  Read the frame header and index of \p reader.
+             *  @exception Exception
+             *      Throws Exception if the header or index is invalid.
+             */
+            static Frame read_frame(utils::io::BitStreamReader& reader) {
+                reader.reset();
+                if (reader.get(32) != Derived::FRAME_MAGIC || reader.get(8) != Derived::FRAME_VERSION) {
+                    Derived::error(std::string("Not a ") + Derived::NAME + " frame.");
+                }
+
+                Frame frame;
+                frame.length = reader.get_leb128();
+
+                const uint64_t frame_block = reader.get_leb128();
+                if (HEDLEY_UNLIKELY(frame_block == 0 || frame_block > MAX_BLOCK_SIZE || frame_block % Align != 0)) {
+                    Derived::error("Invalid block size.");
+                }
+                frame.block_size = size_t(frame_block);
+
+                // Every block needs its index entry and header, bounds the output size by the input size
+                const size_t   size   = reader.get_size();
+                const size_t   start  = reader.get_position() / 8u;
+                const uint64_t blocks = frame.length / frame_block + (frame.length % frame_block != 0);
+
+                if (HEDLEY_UNLIKELY(start > size || blocks > (size - start) / (4u + BLOCK_HEADER_BYTES))) {
+                    Derived::error("Truncated frame.");
+                }
+
+                // Blocks is bounded by the input size above, so this cannot overflow
+                if (HEDLEY_UNLIKELY((blocks == 0 && frame.length != 0) || frame.length > blocks * frame_block)) {
+                    Derived::error("Invalid frame length.");
+                }
+
+                frame.offsets.resize(size_t(blocks) + 1u);
+
+                size_t offset = start + size_t(blocks) * 4u;
+                for (size_t i = 0; i < blocks; i++) {
+                    const size_t length = reader.get(32);
+
+                    if (HEDLEY_UNLIKELY(length < BLOCK_HEADER_BYTES || length > size - offset)) {
+                        Derived::error("Truncated frame.");
+                    }
+
+                    frame.offsets[i] = offset;
+                    offset += length;
+                }
+                frame.offsets[blocks] = offset;
+
+                return frame;
+            }
+
+            /**
+             *  @brief  Encode the blocks \p first, \p first + \p step, ... of the \p size
+             *          bytes at \p data into \p parts.
+             */
+            void encode_blocks(const uint8_t *data, size_t size, std::vector<std::vector<uint8_t>>& parts,
+                               size_t first, size_t step)
+            {
+                utils::io::BitStreamWriter writer(this->block_size + BLOCK_HEADER_BYTES + 32u);
+
+                for (size_t i = first; i < parts.size(); i += step) {
+                    const size_t offset = i * this->block_size;
+
+                    writer.reset();
+                    this->encode_block(data + offset, std::min(this->block_size, size - offset), writer);
+                    parts[i].assign(writer.get_buffer(), writer.get_buffer() + writer.get_last_byte_position());
+                }
+            }
+
+            /**
+             *  @brief  Decode the blocks \p first, \p first + \p step, ... of \p frame,
+             *          stored in the \p size bytes at \p data, into \p out.
+             *  @exception Exception
+             *      Throws Exception if a block is corrupt.
+             */
+            void decode_blocks(uint8_t *data, size_t size, const Frame& frame, uint8_t *out,
+                               size_t first, size_t step)
+            {
+                utils::io::BitStreamReader reader(data, size);
+
+                for (size_t i = first; i + 1u < frame.offsets.size(); i += step) {
+                    const size_t begin = i * frame.block_size;
+
+                    reader.set_position(frame.offsets[i] * 8u);
+                    this->decode_block(reader, out + begin, size_t(std::min<uint64_t>(frame.block_size, frame.length - begin)));
+
+                    if (HEDLEY_UNLIKELY(reader.get_position() != frame.offsets[i + 1u] * 8u)) {
+                        Derived::error("Invalid block index.");
+                    }
+                }
+            }
+
+            /**
+             *  @brief  Run \p f(task) for \p tasks tasks on \p pool and wait for all of them.
+             *  @exception
+             *      Rethrows the exception of the first failed task.
+             */
+            template<class F>
+            static void run_parallel(utils::threading::ThreadPool& pool, size_t tasks, F&& f) {
+                std::vector<std::future<void>> futures;
+                futures.reserve(tasks);
+
+                for (size_t task = 0; task < tasks; task++) {
+                    futures.emplace_back(pool.enqueue(f, task));
+                }
+
+                // Tasks reference the caller's buffers, let all finish before rethrowing
+                for (auto& future : futures) {
+                    future.wait();
+                }
+                for (auto& future : futures) {
+                    future.get();
+                }
+            }
+
+            /**
+             *  @brief  Decode \p reader with the blocks spread over \p pool, sequentially if null.
+             */
+            utils::memory::unique_t<utils::io::BitStreamReader> decode_frame(utils::io::BitStreamReader& reader,
+                                                                             utils::threading::ThreadPool *pool)
+            {
+                utils::memory::unique_t<utils::io::BitStreamReader> result;
+
+                if (reader.get_size() == 0) {
+                    // Nothing to decode?
+                    result.reset(nullptr);
+                    return result;
+                }
+
+                const Frame frame = read_frame(reader);
+                const size_t blocks = frame.offsets.size() - 1u;
+                const uint64_t original_length = frame.length;
+
+                auto writer = utils::memory::new_unique_var<utils::io::BitStreamWriter>(std::max<size_t>(original_length, 1u));
+                uint8_t *out = writer->get_buffer();
+                uint8_t *data = reader.get_buffer();
+                const size_t size = reader.get_size();
+
+                if (pool == nullptr || blocks < 2u) {
+                    this->decode_blocks(data, size, frame, out, 0, 1);
+                } else {
+                    const size_t tasks = std::clamp<size_t>(pool->size(), 1u, blocks);
+
+                    run_parallel(*pool, tasks, [data, size, &frame, out, tasks](size_t task) {
+                        Derived coder;
+                        coder.decode_blocks(data, size, frame, out, task, tasks);
+                    });
+                }
+
+                reader.set_position(frame.offsets.back() * 8u);
+                writer->set_position(original_length * 8u);
+
+                result.reset(utils::memory::new_var<utils::io::BitStreamReader>(writer->get_buffer(), size_t(original_length)));
+
+                // Transfer ownership of buffer from writer to result stream
+                writer->set_managed(false);
+                result->set_managed(true);
+
+                utils::Logger::Info("[%s]           Input file size: %8d bytes", Derived::NAME, reader.get_size());
+                utils::Logger::Info("[%s]         Decompressed size: %8d bytes  => Ratio: %.2f%%",
+                                      Derived::NAME,
+                                      original_length,
+                                      float(original_length) / reader.get_size() * 100.0f);
+
+                return result;
+            }
+
+            static void log_encoded(size_t original_length, size_t total_length) {
+                utils::Logger::Info("[%s]           Input file size: %8d bytes", Derived::NAME, original_length);
+                utils::Logger::Info("[%s]           Compressed size: %8d bytes  => Ratio: %.2f%%",
+                                      Derived::NAME,
+                                      total_length,
+                                      float(total_length) / original_length * 100.0f);
+            }
+
+        public:
+            inline size_t get_block_size(void) const {
+                return this->block_size;
+            }
+
+            /**
+             *  @brief  Encode the stream and write the framed blocks to an outputstream.
+             *
+             *  @param  reader
+             *      The bytestream to read from.
+             *  @return Returns a new bitstream with the encoded data, nullptr if the input is empty.
+             */
+            utils::memory::unique_t<utils::io::BitStreamWriter> encode(utils::io::BitStreamReader& reader) {
+                const size_t original_length = reader.get_size();
+                const uint8_t *data = reader.get_buffer();
+
+                utils::memory::unique_t<utils::io::BitStreamWriter> writer;
+
+                if (original_length == 0) {
+                    // Nothing to encode?
+                    writer.reset(nullptr);
+                    return writer;
+                }
+
+                const size_t blocks = (original_length + this->block_size - 1u) / this->block_size;
+
+                writer.reset(utils::memory::new_var<utils::io::BitStreamWriter>(
+                    original_length + blocks * (4u + BLOCK_HEADER_BYTES) + 32u));
+
+                const size_t index = this->write_header(*writer, original_length, blocks);
+
+                for (size_t i = 0; i < blocks; i++) {
+                    const size_t offset = i * this->block_size;
+                    const size_t start  = writer->get_position() / 8u;
+
+                    this->encode_block(data + offset, std::min(this->block_size, original_length - offset), *writer);
+                    utils::bits::store_big_endian(writer->get_buffer() + index + i * 4u,
+                                                  uint32_t(writer->get_position() / 8u - start));
+                }
+
+                log_encoded(original_length, writer->get_last_byte_position());
+
+                return writer;
+            }
+
+            /**
+             *  @brief  Encode like encode(reader), with the blocks spread over \p pool.
+             *          The output is the same as the sequential one.
+             *
+             *  @param  reader
+             *      The bytestream to read from.
+             *  @param  pool
+             *      The pool to run on, must not be the pool of the calling thread.
+             *  @return Returns a new bitstream with the encoded data, nullptr if the input is empty.
+             */
+            utils::memory::unique_t<utils::io::BitStreamWriter> encode(utils::io::BitStreamReader& reader,
+                                                                       utils::threading::ThreadPool& pool)
+            {
+                const size_t original_length = reader.get_size();
+                const uint8_t *data = reader.get_buffer();
+
+                const size_t blocks = (original_length + this->block_size - 1u) / this->block_size;
+
+                if (blocks < 2u) {
+                    return this->encode(reader);
+                }
+
+                std::vector<std::vector<uint8_t>> parts(blocks);
+                const size_t tasks = std::clamp<size_t>(pool.size(), 1u, blocks);
+                const size_t block = this->block_size;
+
+                run_parallel(pool, tasks, [data, original_length, &parts, tasks, block](size_t task) {
+                    Derived coder(block);
+                    coder.encode_blocks(data, original_length, parts, task, tasks);
+                });
+
+                size_t total = 0;
+                for (const auto& part : parts) {
+                    total += part.size();
+                }
+
+                utils::memory::unique_t<utils::io::BitStreamWriter> writer(
+                    utils::memory::new_var<utils::io::BitStreamWriter>(total + blocks * 4u + 32u));
+
+                const size_t index = this->write_header(*writer, original_length, blocks);
+
+                for (size_t i = 0; i < blocks; i++) {
+                    utils::bits::store_big_endian(writer->get_buffer() + index + i * 4u, uint32_t(parts[i].size()));
+                    writer->write_bytes(parts[i].data(), parts[i].size());
+                }
+
+                log_encoded(original_length, writer->get_last_byte_position());
+
+                return writer;
+            }
+
+            /**
+             *  @brief  Encode on a temporary pool of \p threads threads.
+             */
+            utils::memory::unique_t<utils::io::BitStreamWriter> encode(utils::io::BitStreamReader& reader, size_t threads) {
+                utils::threading::ThreadPool pool(threads);
+                return this->encode(reader, pool);
+            }
+
+            /**
+             *  @brief  Read the framed blocks from the stream and
+             *          write the decoded data to an outputstream.
+             *
+             *  @param  reader
+             *      The bytestream to read from.
+             *  @return Returns a new bitstream with the decoded data, nullptr if the input is empty.
+             *  @exception Exception
+             *      Throws Exception if the stream is corrupt.
+             */
+            utils::memory::unique_t<utils::io::BitStreamReader> decode(utils::io::BitStreamReader& reader) {
+                return this->decode_frame(reader, nullptr);
+            }
+
+            /**
+             *  @brief  Decode like decode(reader), with the blocks spread over \p pool.
+             *
+             *  @param  reader
+             *      The bytestream to read from.
+             *  @param  pool
+             *      The pool to run on, must not be the pool of the calling thread.
+             *  @return Returns a new bitstream with the decoded data, nullptr if the input is empty.
+             *  @exception Exception
+             *      Throws Exception if the stream is corrupt.
+             */
+            utils::memory::unique_t<utils::io::BitStreamReader> decode(utils::io::BitStreamReader& reader,
+                                                                       utils::threading::ThreadPool& pool)
+            {
+                return this->decode_frame(reader, &pool);
+            }
+
+            /**
+             *  @brief  Decode on a temporary pool of \p threads threads.
+             */
+            utils::memory::unique_t<utils::io::BitStreamReader> decode(utils::io::BitStreamReader& reader, size_t threads) {
+                utils::threading::ThreadPool pool(threads);
+                return this->decode(reader, pool);
+            }
+
+            /**
+             *  @brief  The number of blocks in the frame of \p reader.
+             *  @exception Exception
+             *      Throws Exception if the header or index is invalid.
+             */
+            static size_t block_count(utils::io::BitStreamReader& reader) {
+                return read_frame(reader).offsets.size() - 1u;
+            }
+
+            /**
+             *  @brief  Decode only block \p index of the frame in \p reader, it holds
+             *          the input bytes from \p index times the frame's block size.
+             *
+             *  @exception Exception
+             *      Throws Exception if the frame or the block is corrupt,
+             *      or \p index is out of range.
+             */
+            std::vector<uint8_t> decode_block(utils::io::BitStreamReader& reader, size_t index) {
+                const Frame frame = read_frame(reader);
+
+                if (HEDLEY_UNLIKELY(index + 1u >= frame.offsets.size())) {
+                    Derived::error("Block index out of range.");
+                }
+
+                const size_t begin = index * frame.block_size;
+                std::vector<uint8_t> out(size_t(std::min<uint64_t>(frame.block_size, frame.length - begin)));
+
+                reader.set_position(frame.offsets[index] * 8u);
+                this->decode_block(reader, out.data(), out.size());
+
+                if (HEDLEY_UNLIKELY(reader.get_position() != frame.offsets[index + 1u] * 8u)) {
+                    Derived::error("Invalid block index.");
+                }
+
+                return out;
+            }
+
+            /**
+             * @brief encode
+             * @param rawfile
+             * @param encfile
+             * @param threads
+             * @return
+             */
+            static bool encode(const std::string& rawfile, const std::string& encfile, size_t threads = 1) {
+                try {
+                    auto enc = utils::io::BitStreamReader::from_file(rawfile);
+
+                    Derived coder;
+                    auto writer = threads > 1 ? coder.encode(*enc, threads) : coder.encode(*enc);
+
+                    if (writer) {
+                        utils::io::bytes_to_file(encfile,
+                                                 writer->get_buffer(),
+                                                 writer->get_last_byte_position());
+                    } else {
+                        utils::Logger::Warn("[%s] Nothing to encode! Check contents of '%s'" + utils::Logger::CRLF, Derived::NAME, rawfile.c_str());
+                        return false;
+                    }
+
+                    return true;
+                } catch (utils::exceptions::FileReadException const& e) {
+                    utils::Logger::Error(e.getMessage());
+                }
+
+                return false;
+            }
+
+            /**
+             * @brief decode
+             * @param encfile
+             * @param decfile
+             * @param threads
+             * @return
+             */
+            static bool decode(const std::string& encfile, const std::string& decfile, size_t threads = 1) {
+                try {
+                    auto enc = utils::io::BitStreamReader::from_file(encfile);
+
+                    Derived coder;
+                    auto writer = threads > 1 ? coder.decode(*enc, threads) : coder.decode(*enc);
+
+                    if (writer) {
+                        utils::io::bytes_to_file(decfile,
+                                                 writer->get_buffer(),
+                                                 writer->get_size());
+                    } else {
+                        utils::Logger::Warn("[%s] Nothing to decode! Check contents of '%s'" + utils::Logger::CRLF, Derived::NAME, encfile.c_str());
+                        return false;
+                    }
+
+                    return true;
+                } catch (utils::exceptions::Exception const& e) {
+                    utils::Logger::Error(e.getMessage());
+                }
+
+                return false;
+            }
+    };
+}
+
+#endif // ALGO_BLOCK_CODEC_HPP
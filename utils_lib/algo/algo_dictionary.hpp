@@ -0,0 +1,398 @@
+#ifndef ALGO_DICTIONARY_HPP
+#define ALGO_DICTIONARY_HPP
+
+#include "../utils_memory.hpp"
+#include "../utils_bits.hpp"
+#include "../utils_exceptions.hpp"
+#include "../utils_io.hpp"
+#include "algo_huffman.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <iterator>
+#include <unordered_map>
+#include <vector>
+
+namespace utils::algo {
+
+    /**
+     *  @brief  Huffman code trained on sample messages and shared between them.
+     *
+     *          Many small messages each carrying their own table spend more on the
+     *          tables than they save. A dictionary holds one canonical code for every
+     *          symbol, built from the summed frequencies of a sample set, and is saved
+     *          once under its ID. Messages then only reference the ID (big endian):
+     *              LEB128 dictionary ID, LEB128 input size * 2 + stored flag,
+     *              the codes zero padded to a byte, or the input as is if stored
+     *          Messages carry no checksum, leave integrity to the package around them.
+     *
+     *          Every symbol gets a code, also those missing from the samples, so any
+     *          input can be encoded. The saved form is:
+     *              magic (32 bits), version (8 bits), ID (32 bits),
+     *              the code lengths as in a Huffman block, zero padded to a byte,
+     *              CRC-32 of everything before it (32 bits)
+     *
+     *          Encoding and decoding do not change the dictionary, one dictionary can
+     *          be used from multiple threads.
+     */
+    template<class T=uint8_t>
+    class HuffmanDictionary {
+        public:
+            using coder_t = utils::algo::Huffman<T>;
+
+            static constexpr inline uint32_t DICT_MAGIC   = 0x55484443u;   ///< "UHDC"
+            static constexpr inline uint8_t  DICT_VERSION = 1u;
+
+        private:
+            uint32_t id = 0;
+            coder_t  coder;     ///< Holds the code lengths, codes and decoder tables
+
+            ATTR_NORETURN
+            static void error(const std::string& msg) {
+                throw utils::exceptions::Exception("utils::algo::HuffmanDictionary", msg);
+            }
+
+            /**
+             *  @exception Exception
+             *      Throws Exception if a symbol has no code.
+             */
+            void check_coverage(void) const {
+                if (HEDLEY_UNLIKELY(std::count(this->coder.lengths.begin(), this->coder.lengths.end(), uint8_t(0)) > 0)) {
+                    error("Dictionary does not cover every symbol.");
+                }
+            }
+
+        public:
+            HuffmanDictionary(void) = default;
+
+            /**
+             *  @brief  Train a dictionary on \p samples.
+             *
+             *          Symbol counts are summed over all samples and scaled to 32 bits,
+             *          every symbol counts at least once.
+             *
+             *  @param  id
+             *      The ID messages use to reference the dictionary.
+             *  @param  samples
+             *      Iterable of byte containers (e.g. std::vector<uint8_t> or std::string),
+             *      representative of the messages to encode.
+             *  @return Returns the trained dictionary.
+             */
+            template<class Samples>
+            static HuffmanDictionary train(uint32_t id, const Samples& samples) {
+                HuffmanDictionary result;
+                result.id = id;
+
+                coder_t& coder = result.coder;
+                std::vector<uint64_t> totals(coder_t::ALPHABET, 0u);
+
+                for (const auto& sample : samples) {
+                    static_assert(sizeof(*std::data(sample)) == 1,
+                                  "utils::algo::HuffmanDictionary::train: Samples must be byte containers.");
+
+                    coder.count_freqs(reinterpret_cast<const uint8_t*>(std::data(sample)), std::size(sample));
+                    for (size_t symbol = 0; symbol < coder_t::ALPHABET; symbol++) {
+                        totals[symbol] += coder.freqs[symbol];
+                    }
+                }
+
+                const uint64_t largest = *std::max_element(totals.begin(), totals.end());
+                uint32_t shift = 0;
+                while ((largest >> shift) >= UINT32_MAX) {
+                    shift++;
+                }
+
+                for (size_t symbol = 0; symbol < coder_t::ALPHABET; symbol++) {
+                    coder.freqs[symbol] = uint32_t(totals[symbol] >> shift) + 1u;
+                }
+
+                coder.build_lengths();
+                coder.build_codes();
+                coder.decoder.build(coder.dict);
+                result.check_coverage();
+
+                return result;
+            }
+
+            inline uint32_t get_id(void) const {
+                return this->id;
+            }
+
+            /**
+             *  @brief  The symbols with their codes, in canonical order.
+             */
+            inline const std::vector<typename coder_t::KeyPair>& get_dict(void) const {
+                return this->coder.get_dict();
+            }
+
+            /**
+             *  @brief  The saved form of the dictionary.
+             */
+            std::vector<uint8_t> to_bytes(void) const {
+                utils::io::BitStreamWriter writer(16u + coder_t::ALPHABET);
+
+                writer.put(32, DICT_MAGIC);
+                writer.put(8, DICT_VERSION);
+                writer.put(32, this->id);
+                this->coder.write_table(writer);
+                writer.flush();
+                writer.put(32, coder_t::checksum(writer.get_buffer(), writer.get_position() / 8u));
+
+                return std::vector<uint8_t>(writer.get_buffer(), writer.get_buffer() + writer.get_last_byte_position());
+            }
+
+            /**
+             *  @brief  Load a dictionary from its saved form.
+             *
+             *  @param  data
+             *      The bytes written by to_bytes().
+             *  @param  size
+             *      The amount of bytes.
+             *  @return Returns the dictionary.
+             *  @exception Exception
+             *      Throws Exception if the bytes are not a valid dictionary.
+             */
+            static HuffmanDictionary from_bytes(const uint8_t *data, size_t size) {
+                utils::io::BitStreamReader reader(const_cast<uint8_t*>(data), size);
+
+                if (reader.get(32) != DICT_MAGIC || reader.get(8) != DICT_VERSION) {
+                    error("Not a dictionary.");
+                }
+
+                HuffmanDictionary result;
+                result.id = uint32_t(reader.get(32));
+                result.coder.read_table(reader);
+                reader.flush();
+
+                const size_t end = reader.get_position() / 8u;
+                if (HEDLEY_UNLIKELY(end + 4u != size)) {
+                    error("Truncated dictionary.");
+                }
+                if (HEDLEY_UNLIKELY(reader.get(32) != coder_t::checksum(data, end))) {
+                    error("Checksum mismatch.");
+                }
+
+                result.check_coverage();
+
+                return result;
+            }
+
+            inline void write_to_file(const std::string& filename) const {
+                const auto bytes = this->to_bytes();
+                utils::io::bytes_to_file(filename, bytes.data(), bytes.size());
+            }
+
+            /**
+             *  @exception FileReadException
+             *      Throws FileReadException if the file could not be read.
+             *  @exception Exception
+             *      Throws Exception if the file is not a valid dictionary.
+             */
+            static HuffmanDictionary from_file(const std::string& filename) {
+                const auto bytes = utils::io::file_to_bytes(filename);
+                return from_bytes(bytes->data(), bytes->size());
+            }
+
+            /**
+             *  @brief  The ID of the dictionary the message in \p reader references.
+             *          Moves \p reader past it.
+             */
+            static uint32_t message_id(utils::io::BitStreamReader& reader) {
+                reader.reset();
+                const uint64_t id = reader.get_leb128();
+
+                if (HEDLEY_UNLIKELY(id > UINT32_MAX || reader.get_position() > reader.get_size_bits())) {
+                    error("Invalid message header.");
+                }
+
+                return uint32_t(id);
+            }
+
+            /**
+             *  @brief  Encode the stream as a message referencing this dictionary.
+             *
+             *  @param  reader
+             *      The bytestream to read from.
+             *  @return Returns a new bitstream with the message, nullptr if the input is empty.
+             */
+            utils::memory::unique_t<utils::io::BitStreamWriter> encode(utils::io::BitStreamReader& reader) const {
+                const size_t size = reader.get_size();
+                const uint8_t *data = reader.get_buffer();
+
+                utils::memory::unique_t<utils::io::BitStreamWriter> writer;
+
+                if (size == 0) {
+                    // Nothing to encode?
+                    writer.reset(nullptr);
+                    return writer;
+                }
+
+                // Grows if the codes do not fit
+                writer.reset(utils::memory::new_var<utils::io::BitStreamWriter>(size + 16u));
+
+                writer->put_leb128(this->id);
+                const size_t header = writer->get_position();
+                writer->put_leb128(uint64_t(size) << 1u);
+
+                const size_t start = writer->get_position() / 8u;
+                this->coder.put_codes(data, size, *writer);
+
+                if (writer->get_position() / 8u - start >= size) {
+                    // No gain, store the input instead, the flag does not change the header size
+                    writer->set_position(header);
+                    writer->put_leb128((uint64_t(size) << 1u) | 1u);
+                    writer->write_bytes(data, size);
+                }
+
+                return writer;
+            }
+
+            /**
+             *  @brief  Decode a message encoded with this dictionary.
+             *
+             *  @param  reader
+             *      The bytestream to read from.
+             *  @return Returns a new bitstream with the decoded data, nullptr if the input is empty.
+             *  @exception Exception
+             *      Throws Exception if the message references another dictionary or is corrupt.
+             */
+            utils::memory::unique_t<utils::io::BitStreamReader> decode(utils::io::BitStreamReader& reader) const {
+                utils::memory::unique_t<utils::io::BitStreamReader> result;
+
+                if (reader.get_size() == 0) {
+                    // Nothing to decode?
+                    result.reset(nullptr);
+                    return result;
+                }
+
+                if (HEDLEY_UNLIKELY(message_id(reader) != this->id)) {
+                    error("Message references another dictionary.");
+                }
+
+                const uint64_t header = reader.get_leb128();
+                const uint64_t size   = header >> 1u;
+                const bool     stored = header & 1u;
+                const size_t   offset = reader.get_position() / 8u;
+
+                if (HEDLEY_UNLIKELY(offset > reader.get_size())) {
+                    error("Truncated message.");
+                }
+
+                // A code is at least one bit, bounds the output size by the input size
+                const size_t payload = reader.get_size() - offset;
+                if (HEDLEY_UNLIKELY(stored ? size != payload : (size + sizeof(T) - 1u) / sizeof(T) > payload * 8u)) {
+                    error("Invalid message size.");
+                }
+
+                auto writer = utils::memory::new_unique_var<utils::io::BitStreamWriter>(std::max<size_t>(size_t(size), 1u));
+                uint8_t *out = writer->get_buffer();
+
+                if (stored) {
+                    std::copy_n(reader.get_buffer() + offset, payload, out);
+                    reader.set_position(reader.get_size_bits());
+                } else {
+                    std::vector<T> symbols;
+                    utils::io::BitStreamReader codes(reader.get_buffer() + offset, payload);
+
+                    this->coder.decode_codes(coder_t::BLOCK_HUFFMAN, codes, out, size_t(size), symbols);
+
+                    if (HEDLEY_UNLIKELY(codes.get_last_byte_position() != payload)) {
+                        error("Trailing bytes in message.");
+                    }
+                    reader.set_position(reader.get_size_bits());
+                }
+
+                writer->set_position(size * 8u);
+
+                result.reset(utils::memory::new_var<utils::io::BitStreamReader>(writer->get_buffer(), size_t(size)));
+
+                // Transfer ownership of buffer from writer to result stream
+                writer->set_managed(false);
+                result->set_managed(true);
+
+                return result;
+            }
+    };
+
+    /**
+     *  @brief  Dictionaries by ID, decodes a message with the dictionary it references.
+     */
+    template<class T=uint8_t>
+    class DictionaryStore {
+        public:
+            using dictionary_t = HuffmanDictionary<T>;
+
+        private:
+            std::unordered_map<uint32_t, dictionary_t> dictionaries;
+
+            ATTR_NORETURN
+            static void error(const std::string& msg) {
+                throw utils::exceptions::Exception("utils::algo::DictionaryStore", msg);
+            }
+
+        public:
+            /**
+             *  @brief  Add \p dictionary, replacing the one with the same ID.
+             */
+            inline void add(dictionary_t dictionary) {
+                const uint32_t id = dictionary.get_id();
+                this->dictionaries.insert_or_assign(id, std::move(dictionary));
+            }
+
+            /**
+             *  @brief  Add the dictionary saved in \p filename.
+             *  @return Returns its ID.
+             */
+            inline uint32_t load(const std::string& filename) {
+                auto dictionary = dictionary_t::from_file(filename);
+                const uint32_t id = dictionary.get_id();
+
+                this->add(std::move(dictionary));
+                return id;
+            }
+
+            inline bool contains(uint32_t id) const {
+                return this->dictionaries.count(id) > 0;
+            }
+
+            inline size_t size(void) const {
+                return this->dictionaries.size();
+            }
+
+            /**
+             *  @exception Exception
+             *      Throws Exception if there is no dictionary with ID \p id.
+             */
+            const dictionary_t& get(uint32_t id) const {
+                const auto it = this->dictionaries.find(id);
+
+                if (HEDLEY_UNLIKELY(it == this->dictionaries.end())) {
+                    error("Unknown dictionary " + std::to_string(id) + ".");
+                }
+
+                return it->second;
+            }
+
+            /**
+             *  @brief  Encode \p reader with the dictionary with ID \p id.
+             */
+            inline utils::memory::unique_t<utils::io::BitStreamWriter> encode(uint32_t id, utils::io::BitStreamReader& reader) const {
+                return this->get(id).encode(reader);
+            }
+
+            /**
+             *  @brief  Decode the message in \p reader with the dictionary it references.
+             *  @exception Exception
+             *      Throws Exception if the dictionary is unknown or the message is corrupt.
+             */
+            utils::memory::unique_t<utils::io::BitStreamReader> decode(utils::io::BitStreamReader& reader) const {
+                if (reader.get_size() == 0) {
+                    return nullptr;
+                }
+
+                return this->get(dictionary_t::message_id(reader)).decode(reader);
+            }
+    };
+}
+
+#endif // ALGO_DICTIONARY_HPP
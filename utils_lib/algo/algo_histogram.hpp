@@ -0,0 +1,57 @@
+#ifndef ALGO_HISTOGRAM_HPP
+#define ALGO_HISTOGRAM_HPP
+
+#include "../utils_compiler.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+
+namespace utils::algo {
+    static constexpr inline size_t HISTOGRAM_BINS = 256u;   ///< Counts per byte histogram
+
+    /**
+     *  @brief  Count every byte value of the \p size bytes at \p data into \p counts.
+     *
+     *          Increments alternate between four tables that are summed at the end, so
+     *          a run of equal bytes does not wait on the store of the previous increment
+     *          of the same counter. The input is loaded 8 bytes at a time.
+     *
+     *  @param  [in] data
+     *      The bytes to count.
+     *  @param  [in] size
+     *      The amount of bytes, less than 2^32.
+     *  @param  [out] counts
+     *      HISTOGRAM_BINS counters, overwritten.
+     */
+    ATTR_MAYBE_UNUSED
+    static inline void histogram(const uint8_t *data, size_t size, uint32_t *counts) {
+        uint32_t tables[4][HISTOGRAM_BINS] = {};
+        size_t i = 0;
+
+        for (; i + 8u <= size; i += 8u) {
+            uint64_t word;
+            std::memcpy(&word, data + i, sizeof(word));
+
+            tables[0][uint8_t(word)      ]++;
+            tables[1][uint8_t(word >>  8)]++;
+            tables[2][uint8_t(word >> 16)]++;
+            tables[3][uint8_t(word >> 24)]++;
+            tables[0][uint8_t(word >> 32)]++;
+            tables[1][uint8_t(word >> 40)]++;
+            tables[2][uint8_t(word >> 48)]++;
+            tables[3][uint8_t(word >> 56)]++;
+        }
+
+        for (; i < size; i++) {
+            tables[0][data[i]]++;
+        }
+
+        for (size_t bin = 0; bin < HISTOGRAM_BINS; bin++) {
+            counts[bin] = tables[0][bin] + tables[1][bin] + tables[2][bin] + tables[3][bin];
+        }
+    }
+}
+
+#endif // ALGO_HISTOGRAM_HPP
@@ -3,597 +3,817 @@
 
 #include "../utils_memory.hpp"
 #include "../utils_bits.hpp"
+#include "../utils_exceptions.hpp"
 #include "../utils_logger.hpp"
 #include "../utils_io.hpp"
+#include "algo_block_codec.hpp"
+#include "algo_histogram.hpp"
 
+#include <algorithm>
 #include <cstdint>
+#include <cstring>
 #include <numeric>
-#include <unordered_map>
-#include <queue>
 #include <vector>
 
 namespace utils::algo {
 
     /**
-     *  @brief  Huffman Node class
+     *  Data struct for Huffman dictionary entries.
+     */
+    struct Codeword {
+        uint32_t word;
+        uint32_t len;
+    };
+
+    /**
+     *  @brief  Table driven decoder for prefix codes written MSB first.
+     *
+     *          A primary table is indexed by the next PRIMARY_BITS bits of the stream.
+     *          Entries hold up to two symbols whose codes fit in those bits together,
+     *          so frequent symbols decode two at a time. Codes longer than PRIMARY_BITS
+     *          continue in secondary tables indexed by the remaining bits.
+     *
+     *          decode_interleaved() advances STREAMS independent streams in one loop,
+     *          as in zstd's Huff0, to overlap their serial bit position updates.
      */
     template<class T=uint8_t>
-    class Node {
+    class HuffmanDecoder {
         public:
-            const T       data;     ///< The actual data in this node.
-            const size_t  freq;     ///< The frequency at which this data occured.
-            Node         *left;     ///< A reference to child on the left ('0')
-            Node         *right;    ///< A reference to child on the right ('1')
+            static constexpr inline uint32_t PRIMARY_BITS = 11u;   ///< Index bits of the primary table
+            static constexpr inline uint32_t MAX_CODE_BITS = 32u;  ///< Longest supported code
 
-            /**
-             *  @brief  Default ctor
-             *
-             *  @param  data
-             *      Initial data in this node.
-             *  @param  freq
-             *      Initial frequency of this data element.
-             *  @param  left
-             *      A reference to the left child.
-             *  @param  right
-             *      A reference to the right child.
-             */
-            Node(const T& data, size_t freq=1u, Node *left=nullptr, Node *right=nullptr)
-                : data(data), freq(freq), left(left), right(right)
-            {
-                // Empty
-            }
+        private:
+            struct Entry {
+                T        symbols[2];
+                uint8_t  count;     ///< Decoded symbols, 0 for a link to a secondary table (or an unused entry)
+                uint8_t  bits;      ///< Bits consumed by the symbols, or index bits of the secondary table
+                uint32_t link;      ///< Offset of the secondary table, or the bits of the first symbol of a pair
+            };
 
-            /**
-             *  @brief  Default dtor
-             *          Deleting children will implicitly delete entire tree
-             *          by recursive dtor calls on every Node.
-             */
-            ~Node(void) {
-                utils::memory::delete_var(left);
-                utils::memory::delete_var(right);
+            std::vector<Entry> table;   ///< Primary table followed by the secondary tables
+            uint32_t table_bits = 0;    ///< Index bits of the primary table
+            uint32_t peek_bits  = 0;    ///< Bits looked at per step: max(table_bits, longest code)
+
+            ATTR_NORETURN
+            static void error(const std::string& msg) {
+                throw utils::exceptions::Exception("utils::algo::HuffmanDecoder", msg);
             }
 
             /**
-             *  @brief  Returns true if this Node has no children,
-             *          and therefor is a leaf.
+             *  @brief  Set \p count entries from \p first to a single symbol.
              */
-            inline bool isLeaf(void) const {
-                return this->left == nullptr && this->right == nullptr;
+            void fill(size_t first, size_t count, const T& symbol, uint32_t bits) {
+                for (size_t i = first; i < first + count; i++) {
+                    Entry& entry = this->table[i];
+
+                    if (HEDLEY_UNLIKELY(entry.count != 0 || entry.bits != 0)) {
+                        error("Codes are not prefix free.");
+                    }
+
+                    entry = Entry{ { symbol, symbol }, 1u, uint8_t(bits), 0u };
+                }
             }
 
+        public:
+            HuffmanDecoder() = default;
+
             /**
-             *  @brief  Comparison operator.
-             *          Nodes with lower frequency has a higher priority.
+             *  @brief  Build the tables for the given codes.
              *
-             *  @param  first
-             *      The first Node to compare with.
-             *  @param  second
-             *      The second Node to compare with.
-             *  @return Returns true if current Node has higher frequency.
+             *  @param  [in] codes
+             *      The symbols with their codewords, all codes must be prefix free.
+             *      A single code of length 0 decodes to that symbol without consuming bits.
+             *  @exception Exception
+             *      Throws Exception if codes are too long or not prefix free.
              */
-            struct comparator {
-                inline bool operator()(const Node<T> * const first, const Node<T> * const second) {
-                    return first->freq > second->freq;
+            template<class Iterable>
+            void build(const Iterable& codes) {
+                uint32_t max_len = 0;
+                size_t   count   = 0;
+
+                for (const auto& [symbol, code] : codes) {
+                    UNUSED(symbol);
+                    if (HEDLEY_UNLIKELY(code.len > MAX_CODE_BITS)) {
+                        error("Code too long.");
+                    }
+                    max_len = std::max(max_len, code.len);
+                    count++;
                 }
-            };
 
-            /**
-             *  @brief  Print a tree structure starting from the given Node.
-             *  @param  node
-             *      The Node to start from.
-             *  @param  s
-             *      A string representation of the tree path ('0' for left and '1' for right)
-             */
-            static void printTree(const algo::Node<T> * const node, std::string s = "") {
-                if (node == nullptr) {
-                    return;
+                if (HEDLEY_UNLIKELY(max_len == 0 && count > 1)) {
+                    error("Codes are not prefix free.");
                 }
 
-                if (node->isLeaf()) {
-                    utils::Logger::Writef(s + " => %X" + utils::Logger::CRLF, node->data);
-                    return;
+                this->table_bits = std::min(PRIMARY_BITS, max_len);
+                this->peek_bits  = max_len;
+                this->table.assign(size_t(1) << this->table_bits, Entry{ { T(), T() }, 0u, 0u, 0u });
+
+                // Short codes fill every primary entry starting with them
+                for (const auto& [symbol, code] : codes) {
+                    if (code.len <= this->table_bits) {
+                        const uint32_t free_bits = this->table_bits - code.len;
+                        this->fill(size_t(code.word) << free_bits, size_t(1) << free_bits, symbol, code.len);
+                    }
                 }
 
-                printTree(node->left , s + "0");
-                printTree(node->right, s + "1");
-            }
-    };
+                // Long codes: one secondary table per primary prefix, sized for its longest code
+                if (max_len > this->table_bits) {
+                    std::vector<uint32_t> sub_bits(this->table.size(), 0u);
 
-    /**
-     *  Data struct for Huffman dictionary entries.
-     */
-    struct Codeword {
-        uint32_t word;
-        uint32_t len;
-    };
+                    for (const auto& [symbol, code] : codes) {
+                        UNUSED(symbol);
+                        if (code.len > this->table_bits) {
+                            const uint32_t prefix = code.word >> (code.len - this->table_bits);
+                            sub_bits[prefix] = std::max(sub_bits[prefix], code.len - this->table_bits);
+                        }
+                    }
 
-    /**
-     *  @brief Huffman class
-     */
-    template<class T=uint8_t>
-    class Huffman {
-        public:
-            using KeyPair = std::pair<T, Codeword>;
+                    const size_t primary_size = this->table.size();
+                    for (size_t prefix = 0; prefix < primary_size; prefix++) {
+                        if (sub_bits[prefix] == 0) {
+                            continue;
+                        }
+
+                        if (HEDLEY_UNLIKELY(this->table[prefix].count != 0)) {
+                            error("Codes are not prefix free.");
+                        }
+
+                        this->table[prefix] = Entry{ { T(), T() }, 0u, uint8_t(sub_bits[prefix]), uint32_t(this->table.size()) };
+                        this->table.resize(this->table.size() + (size_t(1) << sub_bits[prefix]), Entry{ { T(), T() }, 0u, 0u, 0u });
+                    }
+
+                    for (const auto& [symbol, code] : codes) {
+                        if (code.len > this->table_bits) {
+                            const uint32_t suffix_bits = code.len - this->table_bits;
+                            const Entry&   link        = this->table[code.word >> suffix_bits];
+                            const uint32_t free_bits   = link.bits - suffix_bits;
+                            const uint32_t suffix      = code.word & utils::bits::mask_lsb<uint32_t>(suffix_bits);
+
+                            this->fill(link.link + (size_t(suffix) << free_bits), size_t(1) << free_bits, symbol, code.len);
+                        }
+                    }
+                }
+
+                // Pair up primary entries whose bits also hold the complete next code
+                const std::vector<Entry> singles(this->table.begin(), this->table.begin() + (size_t(1) << this->table_bits));
+                const size_t index_mask = singles.size() - 1u;
+
+                for (size_t i = 0; i < singles.size(); i++) {
+                    const Entry& first = singles[i];
+
+                    if (first.count != 1 || first.bits == 0 || first.bits >= this->table_bits) {
+                        continue;
+                    }
+
+                    const Entry& second = singles[(i << first.bits) & index_mask];
+                    if (second.count == 1 && second.bits + first.bits <= this->table_bits) {
+                        this->table[i].symbols[1] = second.symbols[0];
+                        this->table[i].count      = 2u;
+                        this->table[i].bits       = uint8_t(first.bits + second.bits);
+                        this->table[i].link       = first.bits;
+                    }
+                }
+            }
 
         private:
-            algo::Node<T> *tree_root;
+            /**
+             *  @brief  Decode the symbols at the start of the peek_bits \p bits of \p reader
+             *          into \p out, at most \p left of them, and move past their codes.
+             *  @return Returns the number of decoded symbols.
+             */
+            template<class Order>
+            HEDLEY_ALWAYS_INLINE
+            static size_t step(utils::io::BasicBitStreamReader<Order>& reader, const Entry *table, uint32_t shift,
+                               uint64_t bits, T *out, size_t left)
+            {
+                const Entry *entry = &table[bits >> shift];
+
+                if (HEDLEY_UNLIKELY(entry->count == 0)) {
+                    if (HEDLEY_UNLIKELY(entry->bits == 0)) {
+                        error("Invalid code.");
+                    }
+
+                    const uint32_t sub_shift = shift - entry->bits;
+                    entry = &table[entry->link + ((bits >> sub_shift) & utils::bits::mask_lsb<uint64_t>(entry->bits))];
 
-            std::unordered_map<T, Codeword> dict;
+                    if (HEDLEY_UNLIKELY(entry->count == 0)) {
+                        error("Invalid code.");
+                    }
+                }
+
+                out[0] = entry->symbols[0];
+                if (entry->count == 2) {
+                    if (HEDLEY_UNLIKELY(left == 1)) {
+                        // Only the first symbol of the pair is left
+                        reader.skip(entry->link);
+                        return 1u;
+                    }
+                    out[1] = entry->symbols[1];
+                }
+
+                reader.skip(entry->bits);
+                return entry->count;
+            }
 
             /**
-             *  @brief  Add the given settings to the output stream according to the amount of bits
-             *          specified in the Huffman class.
-             *  @param  length
-             *      The length of the sequence that will follow this header.
-             *      If the length is 0, only one '0' bit will be written.
-             *  @param  bit_length
-             *      The amount of bits needed for every data element in the sequence following this header.
-             *      Keys always use KEY_BITS as length, and values use bit_length, which is different for each group.
-             *      This is done to minimize the amoutn of bits needed to save the Huffman dictionary.
-             *  @param  writer
-             *      The outputstream to write to.
+             *  @brief  Steps \p reader can take with unchecked loads: 8 bytes must
+             *          remain before each, a step consumes at most peek_bits.
              */
-            static void add_huffman_dict_header(uint32_t length, uint32_t bit_length, utils::io::BitStreamWriter& writer) {
-                if (length > 0) {
-                    // MSB is HAS_ITEMS setting + 7 bits length
-                    writer.put(algo::Huffman<T>::DICT_HDR_HAS_ITEMS_BITS, 1);
-                    writer.put(algo::Huffman<T>::DICT_HDR_SEQ_LENGTH_BITS,
-                               utils::bits::select_lsb<uint32_t>(length, algo::Huffman<T>::DICT_HDR_SEQ_LENGTH_BITS));
-
-                    // 4 bits for bit length of every dict item
-                    writer.put(algo::Huffman<T>::DICT_HDR_ITEM_BITS,
-                               utils::bits::select_lsb<uint32_t>(bit_length, algo::Huffman<T>::DICT_HDR_ITEM_BITS));
-                } else {
-                    writer.put_bit(0);
+            template<class Order>
+            size_t safe_steps(const utils::io::BasicBitStreamReader<Order>& reader) const {
+                const size_t byte = reader.get_position() / 8u;
+
+                if (byte + 8u > reader.get_size()) {
+                    return 0;
                 }
+                return (reader.get_size() - 8u - byte) * 8u / this->peek_bits;
             }
 
             /**
-             *  @brief  Read a dictionary header from the inputstream and set the given variables.
-             *
-             *  @param  reader
-             *      The inputstream to read from.
-             *  @param  length
-             *      The length of the sequence that will follow this header (will be set).
-             *  @param  bit_length
-             *      The amount of bits for every value element in the following sequence (will be set).
-             *
-             *  @return Returns true if there is data after this header. (first bit was set)
+             *  @brief  Fill \p out for tables without bits to read.
+             *  @return Returns true if there is nothing left to decode.
              */
-            static bool read_huffman_dict_header(utils::io::BitStreamReader& reader, uint32_t& length, uint32_t& bit_length) {
-                if (reader.get_bit()) {
-                    length     = reader.get(algo::Huffman<T>::DICT_HDR_SEQ_LENGTH_BITS);
-                    bit_length = reader.get(algo::Huffman<T>::DICT_HDR_ITEM_BITS);
+            bool decode_trivial(T *out, size_t count) const {
+                if (HEDLEY_UNLIKELY(this->table.empty())) {
+                    if (count > 0) {
+                        error("No codes.");
+                    }
+                    return true;
+                }
+
+                if (this->peek_bits == 0) {
+                    // Single symbol without bits
+                    std::fill(out, out + count, this->table[0].symbols[0]);
                     return true;
                 }
 
                 return false;
             }
 
+        public:
+            static constexpr inline size_t STREAMS = 4u;  ///< Streams of decode_interleaved()
+
+            static_assert(STREAMS == 4u, "utils::algo::HuffmanDecoder: decode_interleaved() is unrolled for 4 streams.");
+
             /**
-             *  @brief  Traverse Huffman tree starting from node and
-             *          add codes for leafs to the dictionary.
-             *  @param  node
-             *      The starting node.
-             *  @param  stream
-             *      The current stream of bits for a path in the tree.
+             *  @brief  Symbols per stream when \p count symbols are split over STREAMS
+             *          streams, the last stream holds the rest.
              */
-            void buildDict(const algo::Node<T> * const node, std::vector<bool> stream) {
-                if (node == nullptr) {
+            static constexpr size_t stream_symbols(size_t count) {
+                return (count + STREAMS - 1u) / STREAMS;
+            }
+
+            /**
+             *  @brief  Decode \p count symbols from \p reader into \p out.
+             *
+             *  @exception Exception
+             *      Throws Exception if the stream contains a code that is not in the table.
+             */
+            template<class Order>
+            void decode(utils::io::BasicBitStreamReader<Order>& reader, T *out, size_t count) const {
+                if (this->decode_trivial(out, count)) {
                     return;
                 }
 
-                // Check if leaf
-                if (node->isLeaf()) {
-                    this->dict[node->data] = Codeword {
-                        // Concatenate the bits in stream to a value
-                        utils::bits::to_binary<uint32_t>(stream),
-                        // Get the amount of bits
-                        uint32_t(stream.size())
-                    };
+                const Entry *const table = this->table.data();
+                const uint32_t peek_bits = this->peek_bits;
+                const uint32_t shift     = peek_bits - this->table_bits;
+                size_t n = 0;
 
-                    return;
+                // Unchecked loads while 8 bytes remain, 2 symbols of slack for pairs
+                while (n + 2 <= count && reader.get_position() / 8u + 8u <= reader.get_size()) {
+                    n += step(reader, table, shift, reader.peek_unchecked(peek_bits), out + n, count - n);
                 }
 
-                std::vector<bool> lstream(stream);
-                lstream.emplace_back(false);   // Go left  => '0'
-                stream.emplace_back(true);     // Go right => '1'
-
-                this->buildDict(node->left , lstream);
-                this->buildDict(node->right, stream);
+                while (n < count) {
+                    n += step(reader, table, shift, reader.peek(peek_bits), out + n, count - n);
+                }
             }
 
             /**
-             *  @brief  Read the dictionary from the given stream to build a Huffman tree structure.
-             *          Clear the previous tree and overwrite with the data from the dict.
-             *
-             *          Optionally also save dict internally, but only tree is needed for
-             *          proper decoding.
+             *  @brief  Decode \p count symbols from STREAMS independent \p readers into \p out,
+             *          stream i holds the stream_symbols(count) symbols from i times that on.
              *
-             *          If first bit was '0', no key: val sequence follows and reader
-             *          already contains uncompressed data.
+             *          The streams are advanced in the same loop, so the serial dependency on
+             *          the bit position of one stream overlaps with the work on the others.
              *
-             *  @param  reader
-             *      The stream to read from.
+             *  @exception Exception
+             *      Throws Exception if a stream contains a code that is not in the table.
              */
-            void buildTree(utils::io::BitStreamReader& reader) {
-                uint32_t dseq_len = 0u, dbit_len = 0u;
+            template<class Order>
+            void decode_interleaved(utils::io::BasicBitStreamReader<Order> (&readers)[STREAMS], T *out, size_t count) const {
+                if (this->decode_trivial(out, count)) {
+                    return;
+                }
 
-                utils::memory::delete_var(this->tree_root);
-                this->tree_root = utils::memory::new_var<algo::Node<T>>(-1);
-                this->dict.clear();
+                const Entry *const table = this->table.data();
+                const uint32_t peek_bits = this->peek_bits;
+                const uint32_t shift     = peek_bits - this->table_bits;
+                const size_t   per       = stream_symbols(count);
 
-                // While header is followed by sequence
-                while (this->read_huffman_dict_header(reader, dseq_len, dbit_len)) {
-                    while (dseq_len--) {
-                        // For each element, read {key: val}
-                        const KeyPair entry {
-                            T(reader.get(algo::Huffman<T>::KEY_BITS)),
-                            Codeword{ reader.get(dbit_len), dbit_len }
-                        };
+                size_t n[STREAMS];
+                size_t end[STREAMS];
+                for (size_t i = 0; i < STREAMS; i++) {
+                    n[i]   = std::min(i * per, count);
+                    end[i] = std::min(n[i] + per, count);
+                }
 
-                        #if 0  // Optionally add to dict, but not necessary since decoding only needs tree.
-                            dict.insert(entry);
-                            // util::Logger::WriteLn(utils::string::format("%02X: %8X (%d bits)", entry.first, entry.second.word, entry.second.len));
-                        #endif
-                        this->treeAddLeaf(entry);
+                while (true) {
+                    // Rounds without bounds checks: every stream has the input and 2 symbols of slack per step
+                    size_t rounds = SIZE_MAX;
+                    for (size_t i = 0; i < STREAMS; i++) {
+                        rounds = std::min({ rounds, this->safe_steps(readers[i]), (end[i] - n[i]) / 2u });
                     }
-                }
-            }
 
-            /**
-             *  @brief  Add a single <T, Codeword> leaf to the current tree.
-             *
-             *  @param  pair
-             *      The <T, Codeword> pair to add.
-             *      Follow Codeword.word from MSB to LSB and create new Nodes on the way,
-             *      ending withe a Node that has the data T.
-             */
-            void treeAddLeaf(const KeyPair& pair) {
-                const auto& [key, word_value] = pair;
-                const size_t mask = utils::bits::mask_one(word_value.len);  // Mask the word_value.len'th bit
-                      size_t dirs = word_value.word;                        // The directions to follow in the tree
-
-                algo::Node<T> *current = this->tree_root;
-
-                // Grow the tree according to the dirs path, starting from MSB, except for last dir
-                for (size_t bits = word_value.len; --bits; dirs <<= 1) {
-                    // Follow the direction and create a dummy Node if none exists
-                    if (dirs & mask) {
-                        if (current->right == nullptr)
-                            current->right = utils::memory::new_var<algo::Node<T>>(-1);
-                        current = current->right;
-                    } else {
-                        if (current->left == nullptr)
-                            current->left = utils::memory::new_var<algo::Node<T>>(-1);
-                        current = current->left;
+                    if (rounds == 0) {
+                        break;
+                    }
+
+                    for (size_t r = 0; r < rounds; r++) {
+                        n[0] += step(readers[0], table, shift, readers[0].peek_unchecked(peek_bits), out + n[0], 2u);
+                        n[1] += step(readers[1], table, shift, readers[1].peek_unchecked(peek_bits), out + n[1], 2u);
+                        n[2] += step(readers[2], table, shift, readers[2].peek_unchecked(peek_bits), out + n[2], 2u);
+                        n[3] += step(readers[3], table, shift, readers[3].peek_unchecked(peek_bits), out + n[3], 2u);
                     }
                 }
 
-                // Create a new Node at the correct position (the last one in dirs)
-                if (dirs & mask) {
-                    current->right = utils::memory::new_var<algo::Node<T>>(key);
-                } else {
-                    current->left  = utils::memory::new_var<algo::Node<T>>(key);
+                for (size_t i = 0; i < STREAMS; i++) {
+                    while (n[i] < end[i]) {
+                        n[i] += step(readers[i], table, shift, readers[i].peek(peek_bits), out + n[i], end[i] - n[i]);
+                    }
                 }
             }
+    };
 
-            /**
-             *  @brief  Traverse Huffman tree starting from node and
-             *          decode symbols according to the dictionary.
-             *  @param  node
-             *      The starting node.
-             *  @param  reader
-             *      The bytestream to read from.
-             */
-            void decode(utils::io::BitStreamReader& reader, utils::io::BitStreamWriter& writer) {
-                if (this->tree_root == nullptr) {
-                    return;
-                }
+    template<class T>
+    class HuffmanDictionary;
 
-                algo::Node<T> *current = this->tree_root;
+    class LZ;
 
-                while (!current->isLeaf()) {
-                    // Read next bit and go left or right untill a leaf is reached
-                    current = (reader.get_bit() ? current->right : current->left);
-                }
+    /**
+     *  @brief  Canonical Huffman coder.
+     *
+     *          Code lengths are optimal under the MAX_CODE_BITS limit (package-merge),
+     *          codes are assigned canonically from the lengths, so only the lengths are
+     *          stored: the highest used symbol, then per symbol its length in
+     *          TABLE_LEN_BITS bits, where a length of 0 is followed by the run of
+     *          unused symbols (TABLE_RUN_BITS bits, minus one).
+     *
+     *          Blocks are framed by BlockCodec, each with its own table. A Huffman
+     *          block's payload is the table followed by the codes. Blocks of at least
+     *          INTERLEAVE_SYMBOLS symbols split the codes in STREAMS streams instead,
+     *          decoded in one interleaved loop: after the table, zero padded to a byte,
+     *          the byte sizes of the first STREAMS - 1 streams (32 bits each), then the
+     *          streams, each zero padded to a byte.
+     *
+     *          Tables are sized for the alphabet once per object, building them
+     *          does not allocate.
+     */
+    template<class T=uint8_t>
+    class Huffman : public BlockCodec<Huffman<T>, sizeof(T)> {
+        friend class BlockCodec<Huffman<T>, sizeof(T)>;
+        friend class HuffmanDictionary<T>;
+        friend class LZ;
 
-                writer.put(algo::Huffman<T>::KEY_BITS, current->data);
-            }
+        public:
+            using KeyPair = std::pair<T, Codeword>;
+
+            static constexpr inline size_t KEY_BITS = utils::bits::size_of<T>();  ///< Bit length of a symbol
+
+            static_assert(KEY_BITS <= 16, "utils::algo::Huffman: Symbols of at most 16 bits supported.");
+
+            static constexpr inline size_t   ALPHABET      = size_t(1) << KEY_BITS;                   ///< Amount of possible symbols
+            static constexpr inline uint32_t MAX_CODE_BITS = KEY_BITS < 15 ? 15u : uint32_t(KEY_BITS);  ///< Longest code
+
+            static constexpr inline size_t TABLE_LEN_BITS = MAX_CODE_BITS < 16 ? 4ull : 5ull;  ///< Bits per code length in the header
+            static constexpr inline size_t TABLE_RUN_BITS = 4ull;                              ///< Bits per run of unused symbols in the header
+
+            static constexpr inline uint32_t FRAME_MAGIC        = 0x55485546u;      ///< "UHUF"
+            static constexpr inline uint8_t  FRAME_VERSION      = 1u;
+            static constexpr inline size_t   STREAMS            = HuffmanDecoder<T>::STREAMS;
+            static constexpr inline size_t   INTERLEAVE_SYMBOLS = 1024u;            ///< Smallest block coded in STREAMS streams
 
             /**
-             *  @brief  A comparator to sort Codeword pairs by bit length.
+             *  How a block is stored.
              */
-            struct CodewordComparator {
-                inline bool operator()(const KeyPair& first, const KeyPair& second) {
-                    return first.second.len > second.second.len;
-                }
+            enum BlockType : uint8_t {
+                BLOCK_HUFFMAN         = 1u,   ///< Table and codes
+                BLOCK_HUFFMAN_STREAMS = 2u,   ///< Table and codes in STREAMS interleaved streams
             };
 
-        public:
+        private:
+            static constexpr inline const char *NAME = "Huffman";  ///< Log prefix
+
+            std::vector<uint32_t> freqs;    ///< Frequency per symbol
+            std::vector<uint8_t>  lengths;  ///< Code length per symbol, 0 if unused
+            std::vector<Codeword> codes;    ///< Code per symbol
+            std::vector<KeyPair>  dict;     ///< Used symbols with their codes, in canonical order
+            std::vector<T>        symbols;  ///< Decoded symbols, for symbols wider than a byte
+
+            algo::HuffmanDecoder<T> decoder;
+
+            // Package-merge scratch space
+            std::vector<uint32_t> order;
+            std::vector<uint64_t> weights;
+            std::vector<uint8_t>  is_leaf;
+
+            ATTR_NORETURN
+            static void error(const std::string& msg) {
+                throw utils::exceptions::Exception("utils::algo::Huffman", msg);
+            }
+
             /**
-             *  @brief  Default ctor
+             *  @brief  Call \p f with every symbol in \p data, multi-byte symbols are big endian.
+             *          A partial last symbol is padded with zeros.
              */
-            Huffman(void) : tree_root(nullptr) {
-                // Empty
+            template<class F>
+            static inline void for_each_symbol(const uint8_t *data, size_t size, F&& f) {
+                if constexpr (sizeof(T) == 1) {
+                    for (size_t i = 0; i < size; i++) {
+                        f(size_t(data[i]));
+                    }
+                } else {
+                    using uT = utils::bits::uint_of_size_t<sizeof(T)>;
+                    const size_t whole = size / sizeof(T);
+
+                    for (size_t i = 0; i < whole; i++) {
+                        f(size_t(utils::bits::load_big_endian<uT>(data + i * sizeof(T))));
+                    }
+
+                    if (size % sizeof(T)) {
+                        uint8_t last[sizeof(T)] = {};
+                        std::memcpy(last, data + whole * sizeof(T), size % sizeof(T));
+                        f(size_t(utils::bits::load_big_endian<uT>(last)));
+                    }
+                }
             }
 
             /**
-             *  @brief  Default dtor
+             *  @brief  Count the symbols of \p data into freqs.
              */
-            ~Huffman(void) {
-                utils::memory::delete_var(this->tree_root);
+            void count_freqs(const uint8_t *data, size_t size) {
+                if constexpr (sizeof(T) == 1) {
+                    algo::histogram(data, size, this->freqs.data());
+                } else {
+                    std::fill(this->freqs.begin(), this->freqs.end(), 0u);
+
+                    for_each_symbol(data, size, [this](size_t symbol) {
+                        this->freqs[symbol]++;
+                    });
+                }
             }
 
             /**
-             *  @brief  Encode bits of length sizeof(T) with Huffman encoding and
-             *          write the Huffman dict and the encoded data to an outputstream.
+             *  @brief  Set the optimal code lengths for freqs, limited to MAX_CODE_BITS,
+             *          with the package-merge algorithm.
              *
-             *  @param  reader
-             *      The bytestream to read from.
-             *  @return Returns a new bitstream with the encoded data.
+             *          Every level merges the symbols (sorted by frequency) with the pairs
+             *          (packages) of the level below. The first 2n - 2 items of the top level
+             *          determine the lengths: a symbol's length is the amount of levels where
+             *          it is among the selected items, the packages selected on one level
+             *          select twice as many items on the level below.
              */
-            utils::memory::unique_t<utils::io::BitStreamWriter> encode(utils::io::BitStreamReader& reader) {
-                const size_t length          = reader.get_size_bits();
-                const size_t original_length = reader.get_size();
-
-                utils::memory::unique_t<utils::io::BitStreamWriter> writer;
+            void build_lengths(void) {
+                std::fill(this->lengths.begin(), this->lengths.end(), uint8_t(0));
 
-                // Calculate frequencies
-                std::unordered_map<T, uint32_t> freqs;
-
-                reader.reset();
-                while(reader.get_position() != length) {
-                    const T word = T(reader.get(algo::Huffman<T>::KEY_BITS));
-                    freqs[word]++;
+                this->order.clear();
+                for (size_t symbol = 0; symbol < ALPHABET; symbol++) {
+                    if (this->freqs[symbol] > 0) {
+                        this->order.push_back(uint32_t(symbol));
+                    }
                 }
 
-                if (freqs.empty()) {
-                    // Nothing to encode?
-                    writer.reset(nullptr);
-                    return writer;
+                const size_t n = this->order.size();
+                if (n <= 1) {
+                    if (n == 1) {
+                        this->lengths[this->order[0]] = 1;
+                    }
+                    return;
                 }
 
-                // Create priority queue to sort tree with Nodes with data from frequency
-                std::priority_queue<algo::Node<T>*, std::vector<algo::Node<T>*>, typename algo::Node<T>::comparator> pq;
+                std::stable_sort(this->order.begin(), this->order.end(), [this](uint32_t a, uint32_t b) {
+                    return this->freqs[a] < this->freqs[b];
+                });
+
+                const size_t width = 2 * n;
+                this->weights.resize(2 * width);
+                this->is_leaf.resize(MAX_CODE_BITS * width);
+
+                uint64_t *previous = this->weights.data();
+                uint64_t *current  = this->weights.data() + width;
+                size_t previous_size = 0;
+
+                // From the deepest level up
+                for (uint32_t level = MAX_CODE_BITS; level-- > 0; ) {
+                    uint8_t *leaf = this->is_leaf.data() + level * width;
+                    const size_t packages = previous_size / 2;
+                    size_t i = 0, p = 0, k = 0;
+
+                    while (i < n || p < packages) {
+                        const uint64_t package = p < packages ? previous[2 * p] + previous[2 * p + 1] : UINT64_MAX;
+
+                        if (i < n && this->freqs[this->order[i]] <= package) {
+                            current[k] = this->freqs[this->order[i++]];
+                            leaf[k++]  = 1u;
+                        } else {
+                            current[k] = package;
+                            leaf[k++]  = 0u;
+                            p++;
+                        }
+                    }
 
-                for (const auto& [data, freq]: freqs) {
-                    pq.emplace(utils::memory::new_var<algo::Node<T>>(data, freq));
-                    // utils::Logger::Writef("%02X: %d\n", data, freq);
+                    std::swap(previous, current);
+                    previous_size = k;
                 }
 
-                while (pq.size() > 1) {
-                    // Empty out queue and build leaves, starting with lowest freq
-                    // Result is a single Node with references to other Nodes in tree structure.
-                    algo::Node<T> *left  = pq.top(); pq.pop();
-                    algo::Node<T> *right = pq.top(); pq.pop();
+                // Select the first 2n - 2 items of the top level and follow the packages down
+                size_t selected = 2 * n - 2;
+                for (uint32_t level = 0; level < MAX_CODE_BITS && selected > 0; level++) {
+                    const uint8_t *leaf = this->is_leaf.data() + level * width;
+                    const size_t leaves = size_t(std::count(leaf, leaf + selected, uint8_t(1)));
 
-                    pq.emplace(utils::memory::new_var<algo::Node<T>>(-1, left->freq + right->freq, left, right));
-                }
+                    for (size_t i = 0; i < leaves; i++) {
+                        this->lengths[this->order[i]]++;
+                    }
 
-                // Huffman tree root
-                this->tree_root = pq.top();
+                    selected = 2 * (selected - leaves);
+                }
+            }
 
-                // Create dictionary by tree traversal
-                this->buildDict(this->tree_root, {});
+            /**
+             *  @brief  Assign canonical codes to the lengths: shorter codes first,
+             *          symbols of the same length in order, consecutive values.
+             *  @exception Exception
+             *      Throws Exception if the lengths do not form a prefix code.
+             */
+            void build_codes(void) {
+                uint32_t counts[MAX_CODE_BITS + 1] = {};
+                uint32_t next[MAX_CODE_BITS + 1]   = {};
 
-                // Create new list with dict elements sorted by bit length for saving to stream
-                std::vector<KeyPair> sorted_dict(this->dict.begin(), this->dict.end());
+                for (const uint8_t length : this->lengths) {
+                    counts[length]++;
+                }
+                counts[0] = 0;
 
-                // Sort the dictionary by value bit length
-                std::sort(sorted_dict.begin(), sorted_dict.end(), algo::Huffman<T>::CodewordComparator());
+                uint32_t code = 0;
+                for (uint32_t bits = 1; bits <= MAX_CODE_BITS; bits++) {
+                    code       = (code + counts[bits - 1]) << 1u;
+                    next[bits] = code;
 
-                // Determine frequencies of each bit length with {bit_length: freq}
-                std::unordered_map<uint32_t, uint32_t> bit_freqs;
-                for (const auto& [value, word] : sorted_dict) {
-                    UNUSED(value);
-                    bit_freqs[word.len]++;
+                    if (HEDLEY_UNLIKELY(code + counts[bits] > (uint32_t(1) << bits))) {
+                        error("Code lengths do not form a prefix code.");
+                    }
                 }
 
-                // Calculate total needed length for dict
-                size_t h_dict_total_length = (algo::Huffman<T>::KEY_BITS * this->dict.size())  // Amount of bits needed for keys
-                                           + ((algo::Huffman<T>::DICT_HDR_HAS_ITEMS_BITS + algo::Huffman<T>::DICT_HDR_ITEM_BITS + algo::Huffman<T>::DICT_HDR_SEQ_LENGTH_BITS)
-                                              * bit_freqs.size())                             // Amount of bits for each header
-                                           + 1;                                               // Stop bit
-                for (const auto& [bit_length, freq] : bit_freqs) {
-                    h_dict_total_length += bit_length * freq;  // Amount of bits for each header group
+                this->dict.clear();
+                for (uint32_t bits = 1; bits <= MAX_CODE_BITS; bits++) {
+                    for (size_t symbol = 0; symbol < ALPHABET; symbol++) {
+                        if (this->lengths[symbol] == bits) {
+                            this->codes[symbol] = Codeword{ next[bits]++, bits };
+                            this->dict.emplace_back(T(symbol), this->codes[symbol]);
+                        }
+                    }
                 }
+            }
 
-                utils::Logger::Info("[Huffman] Table overhead with %d entries: %.1f bytes.",
-                                    this->dict.size(), float(h_dict_total_length) / 8.0f);
+            /**
+             *  @brief  Write the code lengths.
+             */
+            void write_table(utils::io::BitStreamWriter& writer) const {
+                size_t last = ALPHABET;
+                while (this->lengths[--last] == 0) { }
 
-                // Save the Huffman dictionary to a stream
-                writer.reset(utils::memory::new_var<utils::io::BitStreamWriter>((h_dict_total_length + length) / 8 + 1));
-                uint32_t seq_len = 0u, bit_len = 0u;
+                writer.put(KEY_BITS, last);
 
-                // Add headers for each group of same length key:val pairs
-                // and write them to the stream
-                for (const auto& [value, word] : sorted_dict) {
-                    if (seq_len == 0) {
-                        // New group
-                        bit_len = word.len;
-                        seq_len = bit_freqs[bit_len];
-                        this->add_huffman_dict_header(seq_len, bit_len, *writer);
+                for (size_t symbol = 0; symbol <= last; ) {
+                    if (this->lengths[symbol] > 0) {
+                        writer.put(TABLE_LEN_BITS, this->lengths[symbol++]);
+                        continue;
                     }
 
-                    writer->put(algo::Huffman<T>::KEY_BITS, value);  // Put Key
-                    writer->put(bit_len, word.word);                 // Put Val
-                    seq_len--;
-                }
-
-                this->add_huffman_dict_header(0, 0, *writer);  // Stop bit
-
-                // Store length in bytes of source
-                // FIXME capped at 65k due to LEN_BITS being *only* 16
-                //       Maybe 2 additional bits to indicate length of [0b00: 16, 0b01: 32: 0b10: 48, 0b11: 64]?
-                writer->put(algo::Huffman<T>::LEN_BITS, uint16_t(original_length));
+                    // Run of unused symbols, ends before last
+                    size_t run = 1;
+                    while (run < (size_t(1) << TABLE_RUN_BITS) && this->lengths[symbol + run] == 0) {
+                        run++;
+                    }
 
-                // Encode
-                reader.reset();
-                while (reader.get_position() < length) {
-                    const T word = T(reader.get(algo::Huffman<T>::KEY_BITS));
-                    const auto& pair = this->dict[word];
-                    writer->put(pair.len, pair.word);
+                    writer.put(TABLE_LEN_BITS, 0);
+                    writer.put(TABLE_RUN_BITS, run - 1);
+                    symbol += run;
                 }
+            }
 
-                const size_t total_length = writer->get_last_byte_position();
-
-                utils::Logger::Info("[Huffman]           Input file size: %8d bytes", original_length);
-                utils::Logger::Info("[Huffman]           Compressed size: %8d bytes  => Ratio: %.2f%%",
-                                      total_length,
-                                      float(total_length) / original_length * 100.0f);
+            /**
+             *  @brief  Read the code lengths and build the codes and decoder tables.
+             *  @exception Exception
+             *      Throws Exception if the table is invalid.
+             */
+            void read_table(utils::io::BitStreamReader& reader) {
+                std::fill(this->lengths.begin(), this->lengths.end(), uint8_t(0));
 
-                if (original_length < total_length) {
-                    utils::Logger::Warn("[Huffman] No extra compression achieved, reverting stream to encoded.");
+                const size_t last = reader.get(KEY_BITS);
 
-                    writer.reset(utils::memory::new_var<utils::io::BitStreamWriter>(original_length));
-                    writer->put_bit(0);
+                for (size_t symbol = 0; symbol <= last; ) {
+                    const uint32_t length = reader.get(TABLE_LEN_BITS);
 
-                    reader.reset();
-                    while(reader.get_position() < length) {
-                        writer->put(algo::Huffman<T>::KEY_BITS, reader.get(algo::Huffman<T>::KEY_BITS));
+                    if (length > 0) {
+                        if (HEDLEY_UNLIKELY(length > MAX_CODE_BITS)) {
+                            error("Invalid code length.");
+                        }
+                        this->lengths[symbol++] = uint8_t(length);
+                    } else {
+                        symbol += reader.get(TABLE_RUN_BITS) + 1u;
                     }
                 }
 
-                return writer;
+                if (HEDLEY_UNLIKELY(reader.get_position() > reader.get_size_bits())) {
+                    error("Truncated table.");
+                }
+
+                this->build_codes();
+                this->decoder.build(this->dict);
             }
 
             /**
-             *  @brief  Read the Huffman dict from the stream and
-             *          write the decoded data to an outputstream.
-             *
-             *  @param  reader
-             *      The bytestream to read from.
-             *  @return Returns true if current Node has higher frequency.
+             *  @brief  Write the codes of the \p size bytes at \p data, zero padded to a byte.
              */
-            utils::memory::unique_t<utils::io::BitStreamReader> decode(utils::io::BitStreamReader& reader) {
-                utils::memory::unique_t<utils::io::BitStreamReader> result;
-
-                if (reader.get_size() == 0) {
-                    // Nothing to decode?
-                    result.reset(nullptr);
-                    return result;
-                }
+            void put_codes(const uint8_t *data, size_t size, utils::io::BitStreamWriter& writer) const {
+                for_each_symbol(data, size, [this, &writer](size_t symbol) {
+                    const Codeword& code = this->codes[symbol];
+                    writer.put(code.len, code.word);
+                });
 
-                this->buildTree(reader);
+                writer.put((8u - writer.get_position() % 8u) % 8u, 0);  // Zero padding
+            }
 
-                const size_t raw_bits  = reader.get_size_bits();
-                      size_t data_bits = raw_bits - reader.get_position();
+            /**
+             *  @brief  Append the payload of the block with the \p size input bytes
+             *          at \p data to \p writer.
+             *  @return Returns the block type.
+             */
+            uint8_t encode_payload(const uint8_t *data, size_t size, utils::io::BitStreamWriter& writer) {
+                const size_t count = (size + sizeof(T) - 1u) / sizeof(T);
+                const bool interleave = count >= INTERLEAVE_SYMBOLS;
 
-                if (this->tree_root->isLeaf()) {
-                    // No tree was build => No Huffman used, just use passthrough of buffer by setting pointer
-                    const size_t data_bytes = utils::bits::round_to_byte(data_bits - 8);
+                this->count_freqs(data, size);
+                this->build_lengths();
+                this->build_codes();
+                this->write_table(writer);
 
-                    auto writer = utils::memory::new_unique_var<utils::io::BitStreamWriter>(data_bytes);
+                if (interleave) {
+                    writer.put((8u - writer.get_position() % 8u) % 8u, 0);
 
-                    while (reader.get_position() < raw_bits-8) {
-                        writer->put(algo::Huffman<T>::KEY_BITS, reader.get(algo::Huffman<T>::KEY_BITS));
+                    const size_t sizes = writer.get_position() / 8u;
+                    for (size_t i = 0; i + 1u < STREAMS; i++) {
+                        writer.put(32, 0);      // Stream size, set below
                     }
 
-                    result.reset(utils::memory::new_var<utils::io::BitStreamReader>(writer->get_buffer(),
-                                                                                    writer->get_last_byte_position()));
+                    const size_t per = HuffmanDecoder<T>::stream_symbols(count) * sizeof(T);
 
-                    writer->set_managed(false);
-                    result->set_managed(true);
-                    result->set_position(writer->get_position());
+                    for (size_t i = 0; i < STREAMS; i++) {
+                        const size_t stream_start = writer.get_position() / 8u;
+                        const size_t begin        = std::min(i * per, size);
 
-                    utils::Logger::Warn("[Huffman] No Huffman table present in file. Skipping decompression.");
-                } else {
-                    // Get length in bytes of source
-                    const size_t data_bytes = reader.get(algo::Huffman<T>::LEN_BITS);
-
-                    // Consume all other data, bit by bit and traverse Huffman tree to find word
-                    auto writer = utils::memory::new_unique_var<utils::io::BitStreamWriter>(data_bytes);
+                        this->put_codes(data + begin, std::min(per, size - begin), writer);
 
-                    while (reader.get_position() < raw_bits && writer->get_last_byte_position() < data_bytes) {
-                        this->decode(reader, *writer);
-
-                        if (writer->get_position() + 16 > data_bits) {
-                            // Resize buffer if decompression reaches buffer size.
-                            data_bits = writer->resize() * 8u;
+                        if (i + 1u < STREAMS) {
+                            utils::bits::store_big_endian(writer.get_buffer() + sizes + i * 4u,
+                                                          uint32_t(writer.get_position() / 8u - stream_start));
                         }
                     }
-
-                    const size_t original_length = reader.get_size();
-                    const size_t total_length    = writer->get_last_byte_position();
-
-                    result.reset(utils::memory::new_var<utils::io::BitStreamReader>(writer->get_buffer(),
-                                                                                     total_length));
-
-                    // Transfer ownership of buffer from writer to result stream
-                    writer->set_managed(false);
-                    result->set_managed(true);
-
-                    utils::Logger::Info("[Huffman]           Input file size: %8d bytes", original_length);
-                    utils::Logger::Info("[Huffman]         Decompressed size: %8d bytes  => Ratio: %.2f%%",
-                                          total_length,
-                                          float(total_length) / original_length * 100.0f);
+                } else {
+                    this->put_codes(data, size, writer);
                 }
 
-                return result;
+                return interleave ? BLOCK_HUFFMAN_STREAMS : BLOCK_HUFFMAN;
             }
 
             /**
-             * @brief encode
-             * @param rawfile
-             * @param encfile
-             * @return
+             *  @brief  Decode the \p count symbols of the STREAMS streams following the
+             *          table in \p block into \p out.
+             *  @exception Exception
+             *      Throws Exception if the streams are corrupt.
              */
-            static bool encode(const std::string& rawfile, const std::string& encfile) {
-                try {
-                    auto enc = utils::io::BitStreamReader::from_file(rawfile);
+            void decode_streams(utils::io::BitStreamReader& block, T *out, size_t count) const {
+                block.flush();
 
-                    algo::Huffman<T> hm;
-                    auto writer = hm.encode(*enc);
+                size_t offset = block.get_position() / 8u + (STREAMS - 1u) * 4u;
+                if (HEDLEY_UNLIKELY(offset > block.get_size())) {
+                    error("Truncated block.");
+                }
 
-                    if (writer) {
-                        utils::io::bytes_to_file(encfile,
-                                                 writer->get_buffer(),
-                                                 writer->get_last_byte_position());
-                    } else {
-                        utils::Logger::Warn("[Huffman] Nothing to encode! Check contents of '%s'" + utils::Logger::CRLF, rawfile.c_str());
-                        return false;
-                    }
+                size_t sizes[STREAMS];
+                for (size_t i = 0; i + 1u < STREAMS; i++) {
+                    sizes[i] = block.get(32);
+                }
 
-                    return true;
-                } catch (utils::exceptions::FileReadException const& e) {
-                    utils::Logger::Error(e.getMessage());
+                size_t total = 0;
+                for (size_t i = 0; i + 1u < STREAMS; i++) {
+                    if (HEDLEY_UNLIKELY(sizes[i] > block.get_size() - offset - total)) {
+                        error("Truncated block.");
+                    }
+                    total += sizes[i];
                 }
+                sizes[STREAMS - 1u] = block.get_size() - offset - total;
 
-                return false;
+                uint8_t *data = block.get_buffer() + offset;
+                utils::io::BitStreamReader streams[STREAMS] = {
+                    { data,                                  sizes[0] },
+                    { data + sizes[0],                       sizes[1] },
+                    { data + sizes[0] + sizes[1],            sizes[2] },
+                    { data + sizes[0] + sizes[1] + sizes[2], sizes[3] },
+                };
+
+                this->decoder.decode_interleaved(streams, out, count);
+
+                for (const auto& stream : streams) {
+                    if (HEDLEY_UNLIKELY(stream.get_position() > stream.get_size_bits())) {
+                        error("Truncated block.");
+                    }
+                }
             }
 
             /**
-             * @brief decode
-             * @param encfile
-             * @param decfile
-             * @return
+             *  @brief  Decode the codes following the table in \p block, of type
+             *          BLOCK_HUFFMAN or BLOCK_HUFFMAN_STREAMS, into the \p size bytes at \p out.
+             *
+             *  @param  symbols
+             *      Scratch space for symbols wider than a byte.
+             *  @exception Exception
+             *      Throws Exception if the codes are corrupt.
              */
-            static bool decode(const std::string& encfile, const std::string& decfile) {
-                try {
-                    auto enc = utils::io::BitStreamReader::from_file(encfile);
+            void decode_codes(uint8_t type, utils::io::BitStreamReader& block, uint8_t *out, size_t size,
+                              std::vector<T>& symbols) const
+            {
+                const size_t count = (size + sizeof(T) - 1u) / sizeof(T);
+                T *symbols_out;
 
-                    algo::Huffman<T> hm;
-                    auto writer = hm.decode(*enc);
+                if constexpr (sizeof(T) == 1) {
+                    UNUSED(symbols);
+                    symbols_out = reinterpret_cast<T*>(out);
+                } else {
+                    symbols.resize(count);
+                    symbols_out = symbols.data();
+                }
 
-                    if (writer) {
-                        utils::io::bytes_to_file(decfile,
-                                                 writer->get_buffer(),
-                                                 writer->get_size());
-                    } else {
-                        utils::Logger::Warn("[Huffman] Nothing to decode! Check contents of '%s'" + utils::Logger::CRLF, encfile.c_str());
-                        return false;
+                if (type == BLOCK_HUFFMAN) {
+                    this->decoder.decode(block, symbols_out, count);
+
+                    if (HEDLEY_UNLIKELY(block.get_position() > block.get_size_bits())) {
+                        error("Truncated block.");
                     }
+                } else {
+                    this->decode_streams(block, symbols_out, count);
+                }
 
-                    return true;
-                } catch (utils::exceptions::FileReadException const& e) {
-                    utils::Logger::Error(e.getMessage());
+                if constexpr (sizeof(T) != 1) {
+                    using uT = utils::bits::uint_of_size_t<sizeof(T)>;
+
+                    for (size_t i = 0; i < count; i++) {
+                        uint8_t bytes[sizeof(T)];
+                        utils::bits::store_big_endian(bytes, uT(symbols[i]));
+                        std::memcpy(out + i * sizeof(T), bytes, std::min(sizeof(T), size - i * sizeof(T)));
+                    }
                 }
+            }
 
-                return false;
+            /**
+             *  @brief  Decode the payload \p block of type \p type into the \p size bytes at \p out.
+             *  @exception Exception
+             *      Throws Exception if the payload is corrupt.
+             */
+            void decode_payload(uint8_t type, utils::io::BitStreamReader& block, uint8_t *out, size_t size) {
+                if (type == BLOCK_HUFFMAN || type == BLOCK_HUFFMAN_STREAMS) {
+                    this->read_table(block);
+                    this->decode_codes(type, block, out, size, this->symbols);
+                } else {
+                    error("Unknown block type.");
+                }
+            }
+
+        public:
+            /**
+             *  @brief  Default ctor
+             *
+             *  @param  block_size
+             *      Input bytes per independently coded block, rounded to whole symbols.
+             *      Only used for encoding, decoding takes it from the frame.
+             */
+            explicit Huffman(size_t block_size = Huffman::DEFAULT_BLOCK_SIZE)
+                : BlockCodec<Huffman<T>, sizeof(T)>(block_size)
+                , freqs(ALPHABET), lengths(ALPHABET), codes(ALPHABET)
+            {
+                // Empty
             }
 
-            void printDict(void)  {
+            /**
+             *  @brief  The used symbols with their codes, in canonical order.
+             */
+            inline const std::vector<KeyPair>& get_dict(void) const {
+                return this->dict;
+            }
+
+            void printDict(void) const {
                 utils::Logger::Info("[Huffman] Dictionary:");
 
                 for (const auto& [key, word_value] : this->dict) {
@@ -601,18 +821,6 @@ namespace utils::algo {
                                           key, word_value.word, word_value.len);
                 }
             }
-
-            void printTree(void) {
-                utils::Logger::Info("[Huffman] Tree:");
-                algo::Node<T>::printTree(this->tree_root);
-            }
-
-            static constexpr inline size_t KEY_BITS = utils::bits::size_of<T>();  ///< Bit length for keys in Huffman dict
-            static constexpr inline size_t LEN_BITS = 16ull;                      ///< Bit length to store byte length of source (65k max)
-
-            static constexpr inline size_t DICT_HDR_HAS_ITEMS_BITS  = 1ull;  ///< Whether there are dictionary items following (bit length)
-            static constexpr inline size_t DICT_HDR_SEQ_LENGTH_BITS = 7ull;  ///< Amount of bits to represent the length of following items
-            static constexpr inline size_t DICT_HDR_ITEM_BITS       = 4ull;  ///< Amount of bits to represent the length of following items
     };
 }
 
@@ -0,0 +1,632 @@
+#ifndef ALGO_LZ_HPP
+#define ALGO_LZ_HPP
+
+#include "../utils_memory.hpp"
+#include "../utils_bits.hpp"
+#include "../utils_crc.hpp"
+#include "../utils_exceptions.hpp"
+#include "../utils_io.hpp"
+#include "algo_huffman.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+namespace utils::algo {
+
+    /**
+     *  @brief  LZ77 compressor with LZ4 style sequences and a hash chain match finder.
+     *
+     *          A block is a list of sequences: a token byte with the literal length in
+     *          the high and the match length minus MIN_MATCH in the low nibble (15 is
+     *          continued in bytes of up to 255), the literals, then the match offset
+     *          (16 bits little endian, at most MAX_OFFSET back). The last sequence has
+     *          literals only. Levels trade speed for ratio by the amount of chain
+     *          candidates searched and lazy matching.
+     *
+     *          Input is split in independently coded blocks. The frame (big endian) is:
+     *              "ULZ7", version (8 bits), LEB128 block size
+     *              per block: input size (32 bits), type (8 bits), payload size (32 bits),
+     *                         CRC-32 of the block's input (32 bits), payload
+     *              an input size of 0 ends the blocks, followed by the LEB128 total input size
+     *          With entropy coding enabled, a block's sequences are also Huffman coded when
+     *          that is smaller (a DEFLATE like combination): the payload is the Huffman block
+     *          type (8 bits), the size of the sequences (32 bits), then the Huffman table and
+     *          codes without a frame of their own. A block that does not compress is stored
+     *          as is. Frames are written and read block by block, so they can be streamed
+     *          with StreamBitReader and StreamBitWriter.
+     */
+    class LZ {
+        public:
+            static constexpr inline uint32_t FRAME_MAGIC        = 0x554C5A37u;      ///< "ULZ7"
+            static constexpr inline uint8_t  FRAME_VERSION      = 1u;
+            static constexpr inline size_t   DEFAULT_BLOCK_SIZE = 256u * 1024u;     ///< Input bytes per block
+            static constexpr inline size_t   MAX_BLOCK_SIZE     = 64u * 1024u * 1024u;
+
+            static constexpr inline size_t   MIN_MATCH  = 4u;                       ///< Shortest match
+            static constexpr inline size_t   MAX_OFFSET = 65535u;                   ///< Farthest match
+
+            static constexpr inline int MIN_LEVEL     = 1;
+            static constexpr inline int MAX_LEVEL     = 9;
+            static constexpr inline int DEFAULT_LEVEL = 6;
+
+            /**
+             *  How a block is stored.
+             */
+            enum BlockType : uint8_t {
+                BLOCK_STORED     = 0u,   ///< Input bytes as is
+                BLOCK_LZ         = 1u,   ///< Sequences
+                BLOCK_LZ_HUFFMAN = 2u,   ///< Huffman coded sequences
+            };
+
+        private:
+            /**
+             *  Match finder settings per level.
+             */
+            struct Level {
+                uint32_t attempts;  ///< Chain candidates searched per position
+                uint32_t nice;      ///< Stop searching at a match this long
+                bool     lazy;      ///< Prefer a longer match at the next position
+            };
+
+            static constexpr inline Level LEVELS[MAX_LEVEL] = {
+                {   1u,    16u, false },
+                {   2u,    32u, false },
+                {   4u,    32u, false },
+                {   8u,    64u, false },
+                {  16u,    64u, true  },
+                {  32u,   128u, true  },
+                {  64u,   128u, true  },
+                { 128u,   256u, true  },
+                { 512u, 65535u, true  },
+            };
+
+            static constexpr inline uint32_t HASH_BITS   = 16u;
+            static constexpr inline size_t   WINDOW_MASK = 65535u;  ///< Chain ring, covers MAX_OFFSET
+
+            Level  level;
+            bool   entropy;
+            size_t block_size;
+
+            std::vector<uint32_t> head;     ///< Last position + 1 per hash, 0 if none
+            std::vector<uint32_t> chain;    ///< Previous position + 1 with the same hash, per position in the window
+            std::vector<uint8_t>  input;    ///< Block read from a stream
+            std::vector<uint8_t>  packed;   ///< Sequences of a block
+            std::vector<uint8_t>  output;   ///< Decoded block
+
+            algo::Huffman<uint8_t>     huffman;    ///< Entropy coder of the sequences
+            utils::io::BitStreamWriter coded;      ///< Huffman coded sequences of a block
+            std::vector<uint8_t>       sequences;  ///< Huffman decoded sequences of a block
+
+            ATTR_NORETURN
+            static void error(const std::string& msg) {
+                throw utils::exceptions::Exception("utils::algo::LZ", msg);
+            }
+
+            static inline uint32_t checksum(const uint8_t *data, size_t size) {
+                static const utils::CRC::Table<uint32_t, 32> table(utils::CRC::CRC_32());
+                return utils::CRC::Calculate(data, size, table);
+            }
+
+            static inline uint32_t hash(const uint8_t *p) {
+                return (utils::bits::load_little_endian<uint32_t>(p) * 2654435761u) >> (32u - HASH_BITS);
+            }
+
+            /**
+             *  @brief  Length of the common prefix of \p a and \p b, reading up to \p end.
+             */
+            static inline size_t match_length(const uint8_t *a, const uint8_t *b, const uint8_t *end) {
+                const uint8_t *const start = b;
+
+                while (b + 8u <= end) {
+                    const uint64_t diff = utils::bits::load_little_endian<uint64_t>(a) ^ utils::bits::load_little_endian<uint64_t>(b);
+                    if (diff != 0) {
+                        return size_t(b - start) + (utils::bits::ffs(diff) - 1u) / 8u;
+                    }
+                    a += 8u;
+                    b += 8u;
+                }
+
+                while (b < end && *a == *b) {
+                    a++;
+                    b++;
+                }
+
+                return size_t(b - start);
+            }
+
+            /**
+             *  @brief  Upper bound of the sequences of \p size input bytes.
+             */
+            static constexpr size_t bound(size_t size) {
+                return size + size / 255u + 16u;
+            }
+
+            static inline uint8_t *put_length(uint8_t *op, size_t length) {
+                for (; length >= 255u; length -= 255u) {
+                    *op++ = 255u;
+                }
+                *op++ = uint8_t(length);
+                return op;
+            }
+
+            static inline size_t get_length(const uint8_t *&ip, const uint8_t *iend) {
+                size_t length = 0;
+                uint8_t byte;
+
+                do {
+                    if (HEDLEY_UNLIKELY(ip >= iend)) {
+                        error("Truncated sequence.");
+                    }
+                    byte = *ip++;
+                    length += byte;
+                } while (byte == 255u);
+
+                return length;
+            }
+
+            /**
+             *  @brief  Append a sequence of \p literals bytes at \p lit followed by a match
+             *          of \p length bytes at \p offset back (none if 0) to \p op.
+             */
+            static inline uint8_t *put_sequence(uint8_t *op, const uint8_t *lit, size_t literals, size_t length, size_t offset) {
+                const size_t extra = length > 0 ? length - MIN_MATCH : 0;
+                uint8_t *const token = op++;
+
+                *token = uint8_t((std::min<size_t>(literals, 15u) << 4u) | std::min<size_t>(extra, 15u));
+
+                if (literals >= 15u) {
+                    op = put_length(op, literals - 15u);
+                }
+
+                std::memcpy(op, lit, literals);
+                op += literals;
+
+                if (length > 0) {
+                    utils::bits::store_little_endian(op, uint16_t(offset));
+                    op += 2u;
+
+                    if (extra >= 15u) {
+                        op = put_length(op, extra - 15u);
+                    }
+                }
+
+                return op;
+            }
+
+            inline void insert(const uint8_t *src, size_t pos) {
+                uint32_t& bucket = this->head[hash(src + pos)];
+                this->chain[pos & WINDOW_MASK] = bucket;
+                bucket = uint32_t(pos + 1u);
+            }
+
+            /**
+             *  @brief  Longest match for \p pos among the inserted positions.
+             *  @return Returns the match length, less than MIN_MATCH if none, and sets \p offset.
+             */
+            size_t find(const uint8_t *src, size_t pos, size_t size, size_t& offset) const {
+                const uint8_t *const end = src + size;
+                size_t best = MIN_MATCH - 1u;
+                uint32_t candidate = this->head[hash(src + pos)];
+
+                for (uint32_t attempts = this->level.attempts; candidate != 0 && attempts > 0; attempts--) {
+                    const size_t match = candidate - 1u;
+
+                    if (pos - match > MAX_OFFSET) {
+                        break;
+                    }
+
+                    if (src[match + best] == src[pos + best] &&
+                        utils::bits::load_little_endian<uint32_t>(src + match) == utils::bits::load_little_endian<uint32_t>(src + pos))
+                    {
+                        const size_t length = MIN_MATCH + match_length(src + match + MIN_MATCH, src + pos + MIN_MATCH, end);
+
+                        if (length > best) {
+                            best   = length;
+                            offset = pos - match;
+
+                            if (length >= this->level.nice || pos + length == size) {
+                                break;
+                            }
+                        }
+                    }
+
+                    const uint32_t next = this->chain[match & WINDOW_MASK];
+                    if (next >= candidate) {
+                        break;
+                    }
+                    candidate = next;
+                }
+
+                return best;
+            }
+
+            /**
+             *  @brief  Compress the \p size bytes at \p src into packed.
+             *  @return Returns the size of the sequences.
+             */
+            size_t compress_block(const uint8_t *src, size_t size) {
+                std::fill(this->head.begin(), this->head.end(), 0u);
+                this->packed.resize(bound(size));
+
+                uint8_t *op = this->packed.data();
+
+                // Positions with MIN_MATCH bytes left to hash
+                const size_t limit = size >= MIN_MATCH ? size - MIN_MATCH + 1u : 0;
+                size_t anchor = 0;
+                size_t pos    = 0;
+
+                while (pos < limit) {
+                    size_t offset = 0;
+                    size_t length = this->find(src, pos, size, offset);
+                    this->insert(src, pos);
+
+                    if (length < MIN_MATCH) {
+                        pos++;
+                        continue;
+                    }
+
+                    while (this->level.lazy && pos + 1u < limit && length < this->level.nice) {
+                        size_t next_offset = 0;
+                        const size_t next = this->find(src, pos + 1u, size, next_offset);
+
+                        if (next <= length) {
+                            break;
+                        }
+
+                        this->insert(src, ++pos);
+                        length = next;
+                        offset = next_offset;
+                    }
+
+                    op = put_sequence(op, src + anchor, pos - anchor, length, offset);
+
+                    for (size_t i = pos + 1u; i < std::min(pos + length, limit); i++) {
+                        this->insert(src, i);
+                    }
+
+                    pos   += length;
+                    anchor = pos;
+                }
+
+                op = put_sequence(op, src + anchor, size - anchor, 0, 0);
+
+                return size_t(op - this->packed.data());
+            }
+
+            /**
+             *  @brief  Decompress the \p packed_size bytes of sequences at \p src into
+             *          the \p size bytes at \p dst.
+             *  @exception Exception
+             *      Throws Exception if the sequences are corrupt or do not fill \p dst.
+             */
+            static void decompress_block(const uint8_t *src, size_t packed_size, uint8_t *dst, size_t size) {
+                const uint8_t *ip = src;
+                const uint8_t *const iend = src + packed_size;
+                uint8_t *op = dst;
+                uint8_t *const oend = dst + size;
+
+                while (true) {
+                    if (HEDLEY_UNLIKELY(ip >= iend)) {
+                        error("Truncated sequence.");
+                    }
+
+                    const uint8_t token = *ip++;
+
+                    size_t literals = token >> 4u;
+                    if (literals == 15u) {
+                        literals += get_length(ip, iend);
+                    }
+
+                    if (HEDLEY_UNLIKELY(literals > size_t(iend - ip) || literals > size_t(oend - op))) {
+                        error("Invalid literal length.");
+                    }
+
+                    std::memcpy(op, ip, literals);
+                    ip += literals;
+                    op += literals;
+
+                    if (op == oend) {
+                        if (HEDLEY_UNLIKELY(ip != iend || (token & 15u) != 0)) {
+                            error("Trailing sequence data.");
+                        }
+                        return;
+                    }
+
+                    if (HEDLEY_UNLIKELY(iend - ip < 2)) {
+                        error("Truncated sequence.");
+                    }
+
+                    const size_t offset = utils::bits::load_little_endian<uint16_t>(ip);
+                    ip += 2u;
+
+                    size_t length = token & 15u;
+                    if (length == 15u) {
+                        length += get_length(ip, iend);
+                    }
+                    length += MIN_MATCH;
+
+                    if (HEDLEY_UNLIKELY(offset == 0 || offset > size_t(op - dst) || length > size_t(oend - op))) {
+                        error("Invalid match.");
+                    }
+
+                    const uint8_t *match = op - offset;
+
+                    if (HEDLEY_LIKELY(offset >= 8u && length + 7u <= size_t(oend - op))) {
+                        // Whole words, the source stays 8 bytes behind
+                        for (size_t i = 0; i < length; i += 8u) {
+                            std::memcpy(op + i, match + i, 8u);
+                        }
+                    } else {
+                        for (size_t i = 0; i < length; i++) {
+                            op[i] = match[i];
+                        }
+                    }
+
+                    op += length;
+                }
+            }
+
+            template<class Writer>
+            void write_header(Writer& writer) const {
+                writer.put(32, FRAME_MAGIC);
+                writer.put(8, FRAME_VERSION);
+                writer.put_leb128(this->block_size);
+            }
+
+            /**
+             *  @brief  Append one block with the \p size (> 0) input bytes at \p data to \p writer.
+             */
+            template<class Writer>
+            void write_block(Writer& writer, const uint8_t *data, size_t size) {
+                const uint32_t crc = checksum(data, size);
+                const size_t packed_size = this->compress_block(data, size);
+
+                uint8_t type = BLOCK_LZ;
+                const uint8_t *payload = this->packed.data();
+                size_t payload_size = packed_size;
+
+                if (this->entropy) {
+                    this->coded.reset();
+                    this->coded.put(8, 0);              // Huffman block type, set below
+                    this->coded.put(32, packed_size);
+                    this->coded.get_buffer()[0] = this->huffman.encode_payload(this->packed.data(), packed_size, this->coded);
+
+                    if (this->coded.get_last_byte_position() < payload_size) {
+                        type         = BLOCK_LZ_HUFFMAN;
+                        payload      = this->coded.get_buffer();
+                        payload_size = this->coded.get_last_byte_position();
+                    }
+                }
+
+                if (payload_size >= size) {
+                    // No gain, store the input instead
+                    type         = BLOCK_STORED;
+                    payload      = data;
+                    payload_size = size;
+                }
+
+                writer.put(32, size);
+                writer.put(8, type);
+                writer.put(32, payload_size);
+                writer.put(32, crc);
+                writer.write_bytes(payload, payload_size);
+            }
+
+            template<class Writer>
+            static void write_end(Writer& writer, uint64_t total) {
+                writer.put(32, 0);
+                writer.put_leb128(total);
+            }
+
+            /**
+             *  @brief  Read the frame header of \p reader.
+             *  @return Returns the block size of the frame.
+             *  @exception Exception
+             *      Throws Exception if the header is invalid.
+             */
+            template<class Reader>
+            static size_t read_header(Reader& reader) {
+                if (reader.get(32) != FRAME_MAGIC || reader.get(8) != FRAME_VERSION) {
+                    error("Not an LZ frame.");
+                }
+
+                const uint64_t frame_block = reader.get_leb128();
+                if (HEDLEY_UNLIKELY(frame_block == 0 || frame_block > MAX_BLOCK_SIZE)) {
+                    error("Invalid block size.");
+                }
+
+                return size_t(frame_block);
+            }
+
+            /**
+             *  @brief  Read and decode the next block of \p reader into output.
+             *  @return Returns the decoded size, 0 at the end of the blocks.
+             *  @exception Exception
+             *      Throws Exception if the block is corrupt.
+             */
+            template<class Reader>
+            size_t read_block(Reader& reader, size_t frame_block) {
+                const size_t size = reader.get(32);
+                if (size == 0) {
+                    return 0;
+                }
+
+                const uint8_t  type    = uint8_t(reader.get(8));
+                const size_t   payload = reader.get(32);
+                const uint32_t crc     = reader.get(32);
+
+                if (HEDLEY_UNLIKELY(size > frame_block)) {
+                    error("Invalid block size.");
+                }
+
+                if (HEDLEY_UNLIKELY(type == BLOCK_STORED ? payload != size : payload == 0 || payload > bound(size))) {
+                    error("Invalid payload size.");
+                }
+
+                this->packed.resize(payload);
+                reader.read_bytes(this->packed.data(), payload);
+                this->output.resize(size);
+
+                if (type == BLOCK_STORED) {
+                    std::memcpy(this->output.data(), this->packed.data(), size);
+                } else if (type == BLOCK_LZ) {
+                    decompress_block(this->packed.data(), payload, this->output.data(), size);
+                } else if (type == BLOCK_LZ_HUFFMAN) {
+                    if (HEDLEY_UNLIKELY(payload < 5u)) {
+                        error("Truncated block.");
+                    }
+
+                    const uint8_t huffman_type   = this->packed[0];
+                    const size_t  sequences_size = utils::bits::load_big_endian<uint32_t>(this->packed.data() + 1u);
+
+                    if (HEDLEY_UNLIKELY(sequences_size == 0 || sequences_size > bound(size))) {
+                        error("Invalid payload size.");
+                    }
+
+                    this->sequences.resize(sequences_size);
+                    utils::io::BitStreamReader block(this->packed.data() + 5u, payload - 5u);
+                    this->huffman.decode_payload(huffman_type, block, this->sequences.data(), sequences_size);
+
+                    decompress_block(this->sequences.data(), sequences_size, this->output.data(), size);
+                } else {
+                    error("Unknown block type.");
+                }
+
+                if (HEDLEY_UNLIKELY(checksum(this->output.data(), size) != crc)) {
+                    error("Checksum mismatch.");
+                }
+
+                return size;
+            }
+
+            /**
+             *  @brief  Decode the frame of \p reader into \p writer.
+             */
+            template<class Reader, class Writer>
+            void decompress_frame(Reader& reader, Writer& writer) {
+                const size_t frame_block = read_header(reader);
+                uint64_t total = 0;
+
+                for (size_t size; (size = this->read_block(reader, frame_block)) > 0; total += size) {
+                    writer.write_bytes(this->output.data(), size);
+                }
+
+                if (HEDLEY_UNLIKELY(reader.get_leb128() != total)) {
+                    error("Truncated frame.");
+                }
+            }
+
+        public:
+            /**
+             *  @brief  Default ctor
+             *
+             *  @param  level
+             *      Compression level from MIN_LEVEL (fastest) to MAX_LEVEL (smallest), clamped.
+             *  @param  entropy
+             *      Also Huffman code the sequences.
+             *  @param  block_size
+             *      Input bytes per independently coded block.
+             *      Only used for compressing, decompressing takes it from the frame.
+             */
+            explicit LZ(int level = DEFAULT_LEVEL, bool entropy = false, size_t block_size = DEFAULT_BLOCK_SIZE)
+                : level(LEVELS[std::clamp(level, MIN_LEVEL, MAX_LEVEL) - 1])
+                , entropy(entropy)
+                , block_size(std::clamp(block_size, size_t(1), MAX_BLOCK_SIZE))
+                , head(size_t(1) << HASH_BITS)
+                , chain(WINDOW_MASK + 1u)
+                , coded(1024u)
+            {
+                // Empty
+            }
+
+            inline size_t get_block_size(void) const {
+                return this->block_size;
+            }
+
+            /**
+             *  @brief  Compress the whole stream into a new frame.
+             *
+             *  @param  reader
+             *      The bytestream to read from.
+             *  @return Returns a new bitstream with the frame.
+             */
+            utils::memory::unique_t<utils::io::BitStreamWriter> compress(utils::io::BitStreamReader& reader) {
+                const size_t original_length = reader.get_size();
+                const uint8_t *data = reader.get_buffer();
+
+                utils::memory::unique_t<utils::io::BitStreamWriter> writer(
+                    utils::memory::new_var<utils::io::BitStreamWriter>(original_length / 2u + 64u));
+
+                this->write_header(*writer);
+
+                for (size_t offset = 0; offset < original_length; offset += this->block_size) {
+                    this->write_block(*writer, data + offset, std::min(this->block_size, original_length - offset));
+                }
+
+                write_end(*writer, original_length);
+
+                return writer;
+            }
+
+            /**
+             *  @brief  Compress everything \p reader yields into a frame written to \p writer,
+             *          one block at a time. Call finish() on \p writer to complete the output.
+             */
+            void compress(utils::io::StreamBitReader& reader, utils::io::StreamBitWriter& writer) {
+                this->write_header(writer);
+                this->input.resize(this->block_size);
+
+                uint64_t total = 0;
+                for (size_t size; (size = reader.read_some(this->input.data(), this->block_size)) > 0; total += size) {
+                    this->write_block(writer, this->input.data(), size);
+                }
+
+                write_end(writer, total);
+            }
+
+            /**
+             *  @brief  Decompress the frame at the start of \p reader.
+             *
+             *  @param  reader
+             *      The bytestream to read from.
+             *  @return Returns a new bitstream with the decompressed data.
+             *  @exception Exception
+             *      Throws Exception if the frame is corrupt.
+             */
+            utils::memory::unique_t<utils::io::BitStreamReader> decompress(utils::io::BitStreamReader& reader) {
+                reader.reset();
+
+                auto writer = utils::memory::new_unique_var<utils::io::BitStreamWriter>(reader.get_size() * 2u + 64u);
+                this->decompress_frame(reader, *writer);
+
+                if (HEDLEY_UNLIKELY(reader.get_position() > reader.get_size_bits())) {
+                    error("Truncated frame.");
+                }
+
+                const size_t size = writer->get_last_byte_position();
+
+                utils::memory::unique_t<utils::io::BitStreamReader> result(
+                    utils::memory::new_var<utils::io::BitStreamReader>(writer->get_buffer(), size));
+
+                // Transfer ownership of buffer from writer to result stream
+                writer->set_managed(false);
+                result->set_managed(true);
+
+                return result;
+            }
+
+            /**
+             *  @brief  Decompress the frame read from \p reader into \p writer, one block
+             *          at a time. Call finish() on \p writer to complete the output.
+             *  @exception Exception
+             *      Throws Exception if the frame is corrupt.
+             */
+            void decompress(utils::io::StreamBitReader& reader, utils::io::StreamBitWriter& writer) {
+                this->decompress_frame(reader, writer);
+            }
+    };
+}
+
+#endif // ALGO_LZ_HPP
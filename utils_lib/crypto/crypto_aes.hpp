@@ -18,29 +18,34 @@ namespace utils::crypto {
 
             uint32_t blockBytesLen;
 
-            void SubBytes(uint8_t **state) const {
+            /**
+             *  4 x Nb state matrix, Nb is 4 for every AES variant.
+             */
+            using state_t = utils::memory::fixed_ndarray<uint8_t, 4, 4>;
+
+            void SubBytes(state_t &state) const {
                 for (int i = 0; i < 4; i++) {
                     for (int j = 0; j < this->Nb; j++) {
-                        const uint8_t t = state[i][j];
-                        state[i][j] = this->sbox[t];
+                        const uint8_t t = state(i, j);
+                        state(i, j) = this->sbox[t];
                     }
                 }
             }
 
             // shift row i on n positions
-            void ShiftRow(uint8_t **state, const int i, const int n) const {
+            void ShiftRow(state_t &state, const int i, const int n) const {
                 for (int k = 0; k < n; k++) {
-                    const uint8_t t = state[i][0];
+                    const uint8_t t = state(i, 0);
 
                     for (int j = 0; j < this->Nb - 1; j++) {
-                        state[i][j] = state[i][j + 1];
+                        state(i, j) = state(i, j + 1);
                     }
 
-                    state[i][this->Nb - 1] = t;
+                    state(i, this->Nb - 1) = t;
                 }
             }
 
-            inline void ShiftRows(uint8_t **state) const {
+            inline void ShiftRows(state_t &state) const {
                 this->ShiftRow(state, 1, 1);
                 this->ShiftRow(state, 2, 2);
                 this->ShiftRow(state, 3, 3);
@@ -80,12 +85,12 @@ namespace utils::crypto {
                 return c;
             }
 
-            void MixColumns(uint8_t **state) const {
+            void MixColumns(state_t &state) const {
                 uint8_t s[4], s1[4];
 
                 for (int j = 0; j < this->Nb; j++) {
                     for (int i = 0; i < 4; i++) {
-                        s[i] = state[i][j];
+                        s[i] = state(i, j);
                     }
 
                     s1[0] = mul_bytes(0x02, s[0]) ^ mul_bytes(0x03, s[1]) ^ s[2] ^ s[3];
@@ -94,15 +99,15 @@ namespace utils::crypto {
                     s1[3] = mul_bytes(0x03, s[0]) ^ s[1] ^ s[2] ^ mul_bytes(0x02, s[3]);
 
                     for (int i = 0; i < 4; i++) {
-                        state[i][j] = s1[i];
+                        state(i, j) = s1[i];
                     }
                 }
             }
 
-            void AddRoundKey(uint8_t **state, const uint8_t *key) const {
+            void AddRoundKey(state_t &state, const uint8_t *key) const {
                 for (int i = 0; i < 4; i++) {
                     for (int j = 0; j < Nb; j++) {
-                        state[i][j] = state[i][j] ^ key[i + 4 * j];
+                        state(i, j) = state(i, j) ^ key[i + 4 * j];
                     }
                 }
             }
@@ -138,21 +143,21 @@ namespace utils::crypto {
                 a[1] = a[2] = a[3] = 0;
             }
 
-            void InvSubBytes(uint8_t **state) const {
+            void InvSubBytes(state_t &state) const {
                 for (int i = 0; i < 4; i++) {
                     for (int j = 0; j < this->Nb; j++) {
-                        const uint8_t t = state[i][j];
-                        state[i][j] = this->inv_sbox[t];
+                        const uint8_t t = state(i, j);
+                        state(i, j) = this->inv_sbox[t];
                     }
                 }
             }
 
-            void InvMixColumns(uint8_t **state) const {
+            void InvMixColumns(state_t &state) const {
                 uint8_t s[4], s1[4];
 
                 for (int j = 0; j < Nb; j++) {
                     for (int i = 0; i < 4; i++) {
-                        s[i] = state[i][j];
+                        s[i] = state(i, j);
                     }
 
                     s1[0] = mul_bytes(0x0e, s[0]) ^ mul_bytes(0x0b, s[1]) ^ mul_bytes(0x0d, s[2]) ^ mul_bytes(0x09, s[3]);
@@ -161,12 +166,12 @@ namespace utils::crypto {
                     s1[3] = mul_bytes(0x0b, s[0]) ^ mul_bytes(0x0d, s[1]) ^ mul_bytes(0x09, s[2]) ^ mul_bytes(0x0e, s[3]);
 
                     for (int i = 0; i < 4; i++) {
-                        state[i][j] = s1[i];
+                        state(i, j) = s1[i];
                     }
                 }
             }
 
-            inline void InvShiftRows(uint8_t **state) const {
+            inline void InvShiftRows(state_t &state) const {
                 this->ShiftRow(state, 1, this->Nb - 1);
                 this->ShiftRow(state, 2, this->Nb - 2);
                 this->ShiftRow(state, 3, this->Nb - 3);
@@ -227,11 +232,11 @@ namespace utils::crypto {
                 auto w = utils::memory::new_unique_array<uint8_t>(size_t(4 * this->Nb * (this->Nr + 1)));
                 this->KeyExpansion(key, w.get());
 
-                auto state = utils::memory::new_array<uint8_t>(4, size_t(this->Nb));
+                state_t state;
 
                 for (int i = 0; i < 4; i++) {
                     for (int j = 0; j < this->Nb; j++) {
-                        state[i][j] = in[i + 4 * j];
+                        state(i, j) = in[i + 4 * j];
                     }
                 }
 
@@ -250,22 +255,20 @@ namespace utils::crypto {
 
                 for (int i = 0; i < 4; i++) {
                     for (int j = 0; j < this->Nb; j++) {
-                        out[i + 4 * j] = state[i][j];
+                        out[i + 4 * j] = state(i, j);
                     }
                 }
-
-                utils::memory::delete_array(state, 4);
             }
 
             void DecryptBlock(const uint8_t in[], uint8_t out[], const uint8_t key[]) const {
                 auto w = utils::memory::new_unique_array<uint8_t>(size_t(4 * this->Nb * (this->Nr + 1)));
                 this->KeyExpansion(key, w.get());
 
-                auto state = utils::memory::new_array<uint8_t>(4, size_t(this->Nb));
+                state_t state;
 
                 for (int i = 0; i < 4; i++) {
                     for (int j = 0; j < this->Nb; j++) {
-                        state[i][j] = in[i + 4 * j];
+                        state(i, j) = in[i + 4 * j];
                     }
                 }
 
@@ -284,11 +287,9 @@ namespace utils::crypto {
 
                 for (int i = 0; i < 4; i++) {
                     for (int j = 0; j < this->Nb; j++) {
-                        out[i + 4 * j] = state[i][j];
+                        out[i + 4 * j] = state(i, j);
                     }
                 }
-
-                utils::memory::delete_array(state, 4);
             }
 
             inline void XorBlocks(const uint8_t *a, const uint8_t *b, uint8_t *c, const uint32_t len) const {
@@ -441,7 +442,7 @@ namespace utils::crypto {
                 for (uint32_t i = 0; i < inLen; i += this->blockBytesLen) {
                     this->DecryptBlock(in + i, out.get() + i, key);
                     this->XorBlocks(block.get(), out.get() + i, out.get() + i, this->blockBytesLen);
-                    std::copy_n(out.get() + i, this->blockBytesLen, block.get());
+                    std::copy_n(in + i, this->blockBytesLen, block.get());
                 }
 
                 return out;
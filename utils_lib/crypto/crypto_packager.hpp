@@ -6,12 +6,14 @@
 #include "../utils_memory.hpp"
 #include "../utils_json.hpp"
 #include "../utils_string.hpp"
+#include "../algo/algo_dictionary.hpp"
 #include "../algo/algo_huffman.hpp"
+#include "../algo/algo_lz.hpp"
 #include "../crypto/crypto_aes.hpp"
 
 namespace utils::crypto {
     struct IPackageStrategy {
-        virtual ~IPackageStrategy();
+        virtual ~IPackageStrategy() = default;
     };
 
     struct PackageJSON : public IPackageStrategy {
@@ -58,6 +60,57 @@ namespace utils::crypto {
         }
     };
 
+    /**
+     *  Huffman with a trained dictionary, for many small packages.
+     */
+    struct HMDictCompress : public IPackageStrategy {
+        utils::io::BitStreamWriter Pack(utils::io::BitStreamReader& reader, const utils::algo::HuffmanDictionary<>& dict) {
+            auto writer = dict.encode(reader);
+
+            // One named result, a copy would share and double free the buffer
+            utils::io::BitStreamWriter out(writer ? writer->get_last_byte_position() : 0u);
+            if (writer) {
+                std::copy_n(writer->get_buffer(), out.get_size(), out.get_buffer());
+            }
+
+            return out;
+        }
+
+        utils::io::BitStreamReader Unpack(utils::io::BitStreamReader& reader, const utils::algo::DictionaryStore<>& store) {
+            auto result = store.decode(reader);
+
+            if (result) {
+                return { result->get_buffer(),
+                         result->get_buffer() + result->get_size()};
+            } else {
+                return {nullptr, 0};
+            }
+        }
+    };
+
+    struct LZCompress : public IPackageStrategy {
+        utils::io::BitStreamWriter Pack(utils::io::BitStreamReader& reader, int level = utils::algo::LZ::DEFAULT_LEVEL) {
+            utils::algo::LZ lz(level, true);
+            auto writer = lz.compress(reader);
+
+            utils::io::BitStreamWriter out(writer->get_last_byte_position());
+            std::copy_n(writer->get_buffer(), out.get_size(), out.get_buffer());
+            return out;
+        }
+
+        utils::io::BitStreamReader Unpack(utils::io::BitStreamReader& reader) {
+            if (reader.get_size() == 0) {
+                return {nullptr, 0};
+            }
+
+            algo::LZ lz;
+            auto result = lz.decompress(reader);
+
+            return { result->get_buffer(),
+                     result->get_buffer() + result->get_size()};
+        }
+    };
+
     template<size_t KeySize = 256, size_t KeyBytes = KeySize / utils::bits::size_of<uint8_t>()>
     struct EncipherAES : public IPackageStrategy {
         static inline constexpr size_t len_bits = utils::bits::size_of<uint32_t>();
@@ -0,0 +1,968 @@
+#ifndef UTILS_AIO_HPP
+#define UTILS_AIO_HPP
+
+#include "utils_compiler.hpp"
+#include "utils_exceptions.hpp"
+#include "utils_memory.hpp"
+#include "utils_threading.hpp"
+
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#if defined(UTILS_OS_LINUX) || defined(UTILS_OS_MAC)
+    #include <fcntl.h>
+    #include <sys/uio.h>
+    #include <unistd.h>
+#endif
+
+#if defined(UTILS_OS_LINUX) && __has_include(<linux/io_uring.h>)
+    #include <linux/io_uring.h>
+    #include <sys/mman.h>
+    #include <sys/syscall.h>
+
+    #if defined(__NR_io_uring_setup)
+        #define UTILS_AIO_IO_URING 1
+    #endif
+#endif
+
+
+#if defined(UTILS_OS_LINUX) || defined(UTILS_OS_MAC)
+namespace utils::io::aio {
+    /**
+     *  Bytes transferred, or -errno on failure (as returned by the kernel).
+     */
+    using result_t = ssize_t;
+
+    /**
+     *  Completion callback, called from a completion thread.
+     *  An exception it throws is rethrown by AsyncIO::wait_all().
+     */
+    using callback_t = std::function<void(result_t)>;
+
+    /**
+     *  Alignment of buffers, offsets and sizes for files opened with direct I/O.
+     *  Page aligned buffers can be allocated with utils::memory::new_unique_buffer().
+     */
+    static constexpr size_t DIRECT_ALIGNMENT = 4096;
+
+    enum class Mode : uint8_t {
+        Read,       ///< Read only
+        Write,      ///< Write only, created or truncated
+        ReadWrite,  ///< Read and write, created if missing
+    };
+
+    enum class Backend : uint8_t {
+        Auto,       ///< io_uring if the kernel supports it, the thread pool otherwise
+        IoUring,    ///< io_uring, throws if unavailable
+        ThreadPool, ///< Blocking preadv/pwritev calls on a thread pool
+    };
+
+    /**
+     *  \brief  Owning file descriptor for asynchronous I/O.
+     */
+    class File {
+        private:
+            int  fd     = -1;
+            bool direct = false;
+
+        public:
+            File() = default;
+
+            explicit File(int file_descriptor, bool is_direct = false)
+                : fd(file_descriptor), direct(is_direct) {}
+
+            File(File&& other) noexcept
+                : fd(std::exchange(other.fd, -1)), direct(other.direct) {}
+
+            File& operator=(File&& other) noexcept {
+                if (this != &other) {
+                    this->close();
+                    this->fd     = std::exchange(other.fd, -1);
+                    this->direct = other.direct;
+                }
+                return *this;
+            }
+
+            File(const File&)            = delete;
+            File& operator=(const File&) = delete;
+
+            ~File() {
+                this->close();
+            }
+
+            /**
+             *  \brief  Open a file for asynchronous I/O.
+             *
+             *  \param  filename
+             *      The file to open.
+             *  \param  mode
+             *      Read, write (create or truncate) or read/write (create).
+             *  \param  use_direct
+             *      Bypass the page cache (O_DIRECT, F_NOCACHE on Mac). Silently falls back
+             *      to buffered I/O on file systems without support, check is_direct().
+             *      Direct I/O requires DIRECT_ALIGNMENT aligned buffers, offsets and sizes.
+             *  \exception FileReadException, FileWriteException
+             *      Throws if the file could not be opened.
+             */
+            static File open(const std::string& filename, Mode mode, bool use_direct = false) {
+                int flags = O_CLOEXEC;
+
+                switch (mode) {
+                    case Mode::Read:      flags |= O_RDONLY;                    break;
+                    case Mode::Write:     flags |= O_WRONLY | O_CREAT | O_TRUNC; break;
+                    case Mode::ReadWrite: flags |= O_RDWR | O_CREAT;            break;
+                }
+
+                int fd = -1;
+
+                #if defined(O_DIRECT)
+                    if (use_direct) {
+                        fd = ::open(filename.c_str(), flags | O_DIRECT, 0644);
+
+                        if (fd >= 0) {
+                            return File(fd, true);
+                        }
+                    }
+                #endif
+
+                fd = ::open(filename.c_str(), flags, 0644);
+
+                if (HEDLEY_UNLIKELY(fd < 0)) {
+                    if (mode == Mode::Read) {
+                        throw utils::exceptions::FileReadException(filename);
+                    }
+                    throw utils::exceptions::FileWriteException(filename);
+                }
+
+                #if defined(F_NOCACHE)
+                    if (use_direct && ::fcntl(fd, F_NOCACHE, 1) == 0) {
+                        return File(fd, true);
+                    }
+                #endif
+
+                return File(fd, false);
+            }
+
+            inline int get(void) const {
+                return this->fd;
+            }
+
+            inline bool is_open(void) const {
+                return this->fd >= 0;
+            }
+
+            inline bool is_direct(void) const {
+                return this->direct;
+            }
+
+            void close(void) {
+                if (this->fd >= 0) {
+                    ::close(this->fd);
+                    this->fd = -1;
+                }
+            }
+    };
+
+    /**
+     *  One read or write of a batch, see AsyncIO::submit().
+     *  Buffers must stay valid until the operation completes.
+     */
+    struct Operation {
+        int                 fd;
+        std::vector<iovec>  buffers;
+        uint64_t            offset;
+        bool                write;
+    };
+
+    namespace internal {
+        /**
+         *  Count of operations not completed yet, shared with the requests.
+         */
+        struct Pending {
+            std::mutex              mutex;
+            std::condition_variable done;
+            size_t                  count = 0;
+            std::exception_ptr      error;              ///< First exception thrown by a completion callback
+        };
+
+        /**
+         *  Pending request, owned by the backend until completion.
+         */
+        struct Request {
+            std::vector<iovec>      iov;
+            int                     fd;
+            uint64_t                offset;
+            bool                    write;
+            int                     buffer_index = -1;  ///< Registered buffer for fixed operations
+            size_t                  first        = 0;   ///< First buffer of iov not transferred completely
+            size_t                  transferred  = 0;   ///< Bytes transferred by earlier (short) transfers
+
+            std::promise<size_t>    promise;
+            callback_t              callback;           ///< Called instead of fulfilling the promise
+            std::shared_ptr<void>   keep_alive;         ///< Data or file owned by the request
+            std::shared_ptr<Pending> pending;
+
+            /**
+             *  \brief  Account for \p n more bytes transferred, skipping the completed buffers.
+             *  \return Returns whether buffers are left to transfer.
+             */
+            bool advance(size_t n) {
+                this->transferred += n;
+
+                while (this->first < this->iov.size() && n >= this->iov[this->first].iov_len) {
+                    n -= this->iov[this->first].iov_len;
+                    ++this->first;
+                }
+
+                if (this->first < this->iov.size()) {
+                    this->iov[this->first].iov_base = static_cast<uint8_t*>(this->iov[this->first].iov_base) + n;
+                    this->iov[this->first].iov_len -= n;
+                    return true;
+                }
+
+                return false;
+            }
+
+            void complete(result_t result) {
+                // Release owned data (closing owned files) before signalling completion
+                this->keep_alive.reset();
+
+                if (this->callback) {
+                    // Keep the completion thread alive, the exception is rethrown by AsyncIO::wait_all()
+                    try {
+                        this->callback(result);
+                    } catch (...) {
+                        LOCK_BLOCK(this->pending->mutex);
+                        if (!this->pending->error) {
+                            this->pending->error = std::current_exception();
+                        }
+                    }
+                } else if (HEDLEY_UNLIKELY(result < 0)) {
+                    this->promise.set_exception(std::make_exception_ptr(
+                        utils::exceptions::Exception("utils::io::aio", std::strerror(int(-result)))));
+                } else {
+                    this->promise.set_value(size_t(result));
+                }
+
+                {
+                    LOCK_BLOCK(this->pending->mutex);
+                    this->pending->count--;
+                }
+                this->pending->done.notify_all();
+            }
+        };
+
+        using request_t = std::unique_ptr<Request>;
+
+        /**
+         *  \brief  Blocking preadv/pwritev of the whole request, retried on EINTR and short transfers.
+         *          Reads stop early at the end of the file.
+         */
+        ATTR_MAYBE_UNUSED
+        static result_t transfer(Request& r) {
+            while (r.first < r.iov.size()) {
+                iovec    *current = r.iov.data() + r.first;
+                const int count   = int(r.iov.size() - r.first);
+
+                const ssize_t n = r.write
+                                ? ::pwritev(r.fd, current, count, off_t(r.offset + r.transferred))
+                                : ::preadv(r.fd, current, count, off_t(r.offset + r.transferred));
+
+                if (n < 0) {
+                    if (errno == EINTR) {
+                        continue;
+                    }
+                    return r.transferred > 0 ? result_t(r.transferred) : -errno;
+                } else if (n == 0) {
+                    break;
+                }
+
+                r.advance(size_t(n));
+            }
+
+            return result_t(r.transferred);
+        }
+
+        class BackendBase {
+            public:
+                virtual ~BackendBase() = default;
+
+                /// Start all requests, released requests are owned by the backend until completion
+                virtual void submit(std::vector<request_t>& requests) = 0;
+
+                virtual void register_buffers(const std::vector<iovec>& buffers) = 0;
+
+                virtual bool is_io_uring(void) const = 0;
+        };
+
+        /**
+         *  Portable backend running blocking calls on a ThreadPool.
+         */
+        class ThreadPoolBackend : public BackendBase {
+            private:
+                utils::threading::ThreadPool pool;
+
+            public:
+                explicit ThreadPoolBackend(size_t threads)
+                    : pool(std::max(threads, size_t(1))) {}
+
+                void submit(std::vector<request_t>& requests) override {
+                    for (request_t& request : requests) {
+                        if (!request) {
+                            continue;   // Already submitted elsewhere
+                        }
+
+                        this->pool.enqueue([r = request.get()]() {
+                            std::unique_ptr<Request> owned(r);
+                            owned->complete(transfer(*owned));
+                        });
+                        request.release();
+                    }
+                }
+
+                void register_buffers(const std::vector<iovec>&) override {
+                    // Nothing to pin, fixed operations are plain reads and writes
+                }
+
+                bool is_io_uring(void) const override {
+                    return false;
+                }
+        };
+
+    #if defined(UTILS_AIO_IO_URING)
+        /**
+         *  io_uring backend using the raw system calls (no liburing dependency).
+         *  Submissions are batched into one io_uring_enter call, a completion
+         *  thread reaps the completion queue and resubmits short transfers.
+         *  If the ring fails, requests in flight fail and new ones go to a ThreadPoolBackend.
+         */
+        class IoUringBackend : public BackendBase {
+            private:
+                int ring_fd = -1;
+
+                void   *sq_ptr  = nullptr;
+                size_t  sq_size = 0;
+                void   *cq_ptr  = nullptr;
+                size_t  cq_size = 0;
+                io_uring_sqe *sqes      = nullptr;
+                size_t        sqes_size = 0;
+
+                unsigned *sq_head, *sq_tail, *sq_mask, *sq_array;
+                unsigned *cq_head, *cq_tail, *cq_mask;
+                io_uring_cqe *cqes;
+                unsigned sq_entries, cq_entries;
+
+                // Requests in flight are limited to the completion queue size, so it never overflows
+                std::mutex                   submit_mutex;
+                std::condition_variable      slots_free;
+                size_t                       in_flight = 0;
+                std::unordered_set<Request*> requests;      ///< Requests in flight, failed if the ring breaks
+                bool                         broken    = false; ///< New requests go to the fallback
+                bool                         reaping   = true;  ///< Cleared when the reaper stopped on a failure
+
+                // Takes over when the ring failed
+                size_t                             fallback_threads;
+                std::unique_ptr<ThreadPoolBackend> fallback;
+
+                std::thread reaper;
+
+                static inline int enter(int fd, unsigned to_submit, unsigned min_complete, unsigned flags) {
+                    return int(::syscall(__NR_io_uring_enter, fd, to_submit, min_complete, flags, nullptr, 0));
+                }
+
+                static inline void* map(int fd, size_t bytes, off_t offset) {
+                    void *p = ::mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, offset);
+                    return p == MAP_FAILED ? nullptr : p;
+                }
+
+                void release(void) {
+                    if (this->sqes)                                     ::munmap(this->sqes, this->sqes_size);
+                    if (this->cq_ptr && this->cq_ptr != this->sq_ptr)   ::munmap(this->cq_ptr, this->cq_size);
+                    if (this->sq_ptr)                                   ::munmap(this->sq_ptr, this->sq_size);
+                    if (this->ring_fd >= 0)                             ::close(this->ring_fd);
+                }
+
+                /// Queue one entry, submit_mutex must be held and a slot available
+                void push(const io_uring_sqe& sqe) {
+                    const unsigned tail  = *this->sq_tail;
+                    const unsigned index = tail & *this->sq_mask;
+
+                    this->sqes[index]     = sqe;
+                    this->sq_array[index] = index;
+                    __atomic_store_n(this->sq_tail, tail + 1u, __ATOMIC_RELEASE);
+                }
+
+                /// Queue the (remaining) transfer of \p r, submit_mutex must be held and a slot available
+                void push(Request *r) {
+                    io_uring_sqe sqe;
+                    std::memset(&sqe, 0, sizeof(sqe));
+                    sqe.fd        = r->fd;
+                    sqe.off       = r->offset + r->transferred;
+                    sqe.user_data = uint64_t(uintptr_t(r));
+
+                    if (r->buffer_index >= 0) {
+                        sqe.opcode    = r->write ? IORING_OP_WRITE_FIXED : IORING_OP_READ_FIXED;
+                        sqe.addr      = uint64_t(uintptr_t(r->iov[0].iov_base));
+                        sqe.len       = unsigned(r->iov[0].iov_len);
+                        sqe.buf_index = uint16_t(r->buffer_index);
+                    } else {
+                        sqe.opcode = r->write ? IORING_OP_WRITEV : IORING_OP_READV;
+                        sqe.addr   = uint64_t(uintptr_t(r->iov.data() + r->first));
+                        sqe.len    = unsigned(r->iov.size() - r->first);
+                    }
+
+                    this->push(sqe);
+                }
+
+                /// Hand \p count queued entries to the kernel, submit_mutex must be held
+                /// \return Returns 0 or the errno of the failure.
+                int enter_all(unsigned count) {
+                    while (count > 0) {
+                        const int submitted = enter(this->ring_fd, count, 0, 0);
+
+                        if (submitted < 0) {
+                            if (errno == EINTR || errno == EAGAIN || errno == EBUSY) {
+                                std::this_thread::yield();
+                                continue;
+                            }
+                            return errno;
+                        }
+
+                        count -= unsigned(submitted);
+                    }
+
+                    return 0;
+                }
+
+                /// Fail all requests in flight with \p error and send new ones to the thread pool,
+                /// called by the reaper before it stops (no completion reads a failed request after)
+                void fail(int error) {
+                    std::unordered_set<Request*> failed;
+                    {
+                        LOCK_BLOCK(this->submit_mutex);
+                        this->broken    = true;
+                        this->reaping   = false;
+                        this->in_flight = 0;
+                        failed.swap(this->requests);
+                    }
+                    this->slots_free.notify_all();
+
+                    for (Request *r : failed) {
+                        std::unique_ptr<Request> request(r);
+                        request->complete(request->transferred > 0 ? result_t(request->transferred) : result_t(-error));
+                    }
+                }
+
+                void reap(void) {
+                    std::vector<std::pair<Request*, result_t>> completed;
+                    std::vector<Request*> resubmit;
+
+                    for (;;) {
+                        if (enter(this->ring_fd, 0, 1, IORING_ENTER_GETEVENTS) < 0
+                            && errno != EINTR && errno != EAGAIN && errno != EBUSY)
+                        {
+                            this->fail(errno);
+                            return;
+                        }
+
+                        unsigned head       = *this->cq_head;
+                        const unsigned tail = __atomic_load_n(this->cq_tail, __ATOMIC_ACQUIRE);
+                        bool     stop       = false;
+
+                        completed.clear();
+                        resubmit.clear();
+
+                        for (; head != tail; ++head) {
+                            const io_uring_cqe& cqe = this->cqes[head & *this->cq_mask];
+
+                            if (cqe.user_data == 0) {
+                                stop = true;
+                                completed.emplace_back(nullptr, 0);
+                                continue;
+                            }
+
+                            Request *r = reinterpret_cast<Request*>(uintptr_t(cqe.user_data));
+
+                            // Retry interrupted and short transfers like the thread pool does, reads stop at the end of the file
+                            if (cqe.res == -EINTR || (cqe.res > 0 && r->advance(size_t(cqe.res)))) {
+                                resubmit.push_back(r);
+                            } else {
+                                completed.emplace_back(r, cqe.res < 0 && r->transferred == 0 ? result_t(cqe.res) : result_t(r->transferred));
+                            }
+                        }
+
+                        __atomic_store_n(this->cq_head, head, __ATOMIC_RELEASE);
+
+                        int error = 0;
+                        {
+                            LOCK_BLOCK(this->submit_mutex);
+                            this->in_flight -= completed.size();
+
+                            for (const auto& [r, result] : completed) {
+                                this->requests.erase(r);
+                            }
+
+                            // Reaped entries made room for the resubmissions, the submission queue is empty while unlocked
+                            for (size_t i = 0; i < resubmit.size() && error == 0; i += this->sq_entries) {
+                                const size_t count = std::min<size_t>(this->sq_entries, resubmit.size() - i);
+
+                                for (size_t j = i; j < i + count; j++) {
+                                    this->push(resubmit[j]);
+                                }
+                                error = this->enter_all(unsigned(count));
+                            }
+                        }
+                        this->slots_free.notify_all();
+
+                        for (const auto& [r, result] : completed) {
+                            if (r) {
+                                std::unique_ptr<Request> request(r);
+                                request->complete(result);
+                            }
+                        }
+
+                        if (error != 0) {
+                            this->fail(error);
+                            return;
+                        }
+
+                        if (stop) {
+                            return;
+                        }
+                    }
+                }
+
+            public:
+                /**
+                 *  \exception Exception
+                 *      Throws Exception if io_uring is not available.
+                 */
+                explicit IoUringBackend(unsigned queue_depth, size_t fallback_threads)
+                    : fallback_threads(fallback_threads)
+                {
+                    io_uring_params params;
+                    std::memset(&params, 0, sizeof(params));
+
+                    this->ring_fd = int(::syscall(__NR_io_uring_setup, std::max(queue_depth, 2u), &params));
+
+                    if (this->ring_fd < 0) {
+                        throw utils::exceptions::Exception("utils::io::aio::IoUringBackend", std::strerror(errno));
+                    }
+
+                    this->sq_size = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+                    this->cq_size = params.cq_off.cqes  + params.cq_entries * sizeof(io_uring_cqe);
+
+                    if (params.features & IORING_FEAT_SINGLE_MMAP) {
+                        this->sq_size = this->cq_size = std::max(this->sq_size, this->cq_size);
+                    }
+
+                    this->sq_ptr = map(this->ring_fd, this->sq_size, IORING_OFF_SQ_RING);
+                    this->cq_ptr = (params.features & IORING_FEAT_SINGLE_MMAP)
+                                 ? this->sq_ptr
+                                 : map(this->ring_fd, this->cq_size, IORING_OFF_CQ_RING);
+                    this->sqes_size = params.sq_entries * sizeof(io_uring_sqe);
+                    this->sqes = static_cast<io_uring_sqe*>(map(this->ring_fd, this->sqes_size, IORING_OFF_SQES));
+
+                    if (!this->sq_ptr || !this->cq_ptr || !this->sqes) {
+                        const int error = errno;
+                        this->release();
+                        throw utils::exceptions::Exception("utils::io::aio::IoUringBackend", std::strerror(error));
+                    }
+
+                    uint8_t *sq = static_cast<uint8_t*>(this->sq_ptr);
+                    uint8_t *cq = static_cast<uint8_t*>(this->cq_ptr);
+
+                    this->sq_head   = reinterpret_cast<unsigned*>(sq + params.sq_off.head);
+                    this->sq_tail   = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+                    this->sq_mask   = reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+                    this->sq_array  = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+                    this->cq_head   = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+                    this->cq_tail   = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+                    this->cq_mask   = reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+                    this->cqes      = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+                    this->sq_entries = params.sq_entries;
+                    this->cq_entries = params.cq_entries;
+
+                    this->reaper = std::thread([this]() { this->reap(); });
+                }
+
+                ~IoUringBackend() override {
+                    // Wait for all requests, then wake the reaper with a NOP (unless it stopped on a failure)
+                    {
+                        LOCK_UNIQUE_BLOCK(this->submit_mutex);
+                        this->slots_free.wait(__lock, [this]() { return this->in_flight == 0; });
+
+                        if (this->reaping) {
+                            io_uring_sqe sqe;
+                            std::memset(&sqe, 0, sizeof(sqe));
+                            sqe.opcode = IORING_OP_NOP;
+
+                            this->in_flight++;
+                            this->push(sqe);
+
+                            if (this->enter_all(1) != 0) {
+                                // Reaper is stuck waiting, closing the ring below does not wake it
+                                this->reaper.detach();
+                            }
+                        }
+                    }
+
+                    if (this->reaper.joinable()) {
+                        this->reaper.join();
+                    }
+
+                    this->release();
+                }
+
+                void submit(std::vector<request_t>& requests) override {
+                    LOCK_UNIQUE_BLOCK(this->submit_mutex);
+
+                    std::vector<Request*> batch;
+                    size_t i = 0;
+                    while (i < requests.size()) {
+                        this->slots_free.wait(__lock, [this]() {
+                            return this->in_flight < this->cq_entries || this->broken;
+                        });
+
+                        if (this->broken) {
+                            if (!this->fallback) {
+                                this->fallback = std::make_unique<ThreadPoolBackend>(this->fallback_threads);
+                            }
+                            this->fallback->submit(requests);
+                            return;
+                        }
+
+                        const size_t room  = std::min<size_t>(this->cq_entries - this->in_flight, this->sq_entries);
+                        const size_t count = std::min(room, requests.size() - i);
+
+                        batch.clear();
+                        for (size_t j = 0; j < count; j++, i++) {
+                            this->push(requests[i].get());
+                            batch.push_back(requests[i].release());
+                            this->requests.insert(batch.back());
+                            this->in_flight++;
+                        }
+
+                        if (const int error = this->enter_all(unsigned(count)); HEDLEY_UNLIKELY(error != 0)) {
+                            // Take the entries the kernel did not consume back out of the ring and fail them,
+                            // consumed ones complete through the reaper. Later requests go to the fallback.
+                            const unsigned tail     = *this->sq_tail;
+                            const unsigned consumed = __atomic_load_n(this->sq_head, __ATOMIC_ACQUIRE);
+                            const size_t   left     = tail - consumed;
+
+                            __atomic_store_n(this->sq_tail, consumed, __ATOMIC_RELEASE);
+
+                            const std::vector<Request*> failed(batch.end() - std::ptrdiff_t(left), batch.end());
+
+                            this->broken     = true;
+                            this->in_flight -= failed.size();
+                            for (Request *r : failed) {
+                                this->requests.erase(r);
+                            }
+
+                            __lock.unlock();
+                            this->slots_free.notify_all();
+
+                            for (Request *r : failed) {
+                                std::unique_ptr<Request> request(r);
+                                request->complete(result_t(-error));
+                            }
+
+                            __lock.lock();
+                        }
+                    }
+                }
+
+                void register_buffers(const std::vector<iovec>& buffers) override {
+                    ::syscall(__NR_io_uring_register, this->ring_fd, IORING_UNREGISTER_BUFFERS, nullptr, 0);
+
+                    if (buffers.empty()) {
+                        return;
+                    }
+
+                    if (::syscall(__NR_io_uring_register, this->ring_fd, IORING_REGISTER_BUFFERS,
+                                  buffers.data(), unsigned(buffers.size())) < 0) {
+                        throw utils::exceptions::Exception("utils::io::aio::IoUringBackend", std::strerror(errno));
+                    }
+                }
+
+                bool is_io_uring(void) const override {
+                    return true;
+                }
+        };
+    #endif
+    }
+
+    /**
+     *  \brief  Asynchronous file I/O with futures or completion callbacks.
+     *
+     *          Uses io_uring where available: batches of readv/writev are handed
+     *          to the kernel in one system call and registered (pinned) buffers
+     *          avoid per-request page mapping. Falls back to blocking preadv/pwritev
+     *          on a ThreadPool elsewhere.
+     *          Buffers must stay valid until the operation completes.
+     *          The destructor waits for all pending operations.
+     */
+    class AsyncIO {
+        private:
+            std::unique_ptr<internal::BackendBase> backend;
+            std::vector<iovec>                     registered;
+            std::shared_ptr<internal::Pending>     pending = std::make_shared<internal::Pending>();
+
+            internal::request_t make_request(int fd, std::vector<iovec> iov, uint64_t offset, bool write) {
+                auto r = std::make_unique<internal::Request>();
+                r->iov     = std::move(iov);
+                r->fd      = fd;
+                r->offset  = offset;
+                r->write   = write;
+                r->pending = this->pending;
+                return r;
+            }
+
+            internal::request_t make_fixed(int fd, size_t index, size_t length, uint64_t offset,
+                                           size_t buffer_offset, bool write) {
+                if (HEDLEY_UNLIKELY(index >= this->registered.size()
+                                 || buffer_offset + length > this->registered[index].iov_len)) {
+                    throw utils::exceptions::Exception("utils::io::aio::AsyncIO", "Invalid registered buffer range.");
+                }
+
+                auto r = this->make_request(fd, { { static_cast<uint8_t*>(this->registered[index].iov_base) + buffer_offset, length } },
+                                            offset, write);
+
+                if (this->backend->is_io_uring()) {
+                    r->buffer_index = int(index);
+                }
+                return r;
+            }
+
+            void dispatch(std::vector<internal::request_t> requests) {
+                {
+                    LOCK_BLOCK(this->pending->mutex);
+                    this->pending->count += requests.size();
+                }
+
+                try {
+                    this->backend->submit(requests);
+                } catch (...) {
+                    // Requests still owned here were not submitted
+                    {
+                        LOCK_BLOCK(this->pending->mutex);
+                        for (const internal::request_t& r : requests) {
+                            this->pending->count -= (r != nullptr);
+                        }
+                    }
+                    throw;
+                }
+            }
+
+            std::future<size_t> start(internal::request_t request) {
+                std::future<size_t> result = request->promise.get_future();
+                std::vector<internal::request_t> batch;
+                batch.push_back(std::move(request));
+                this->dispatch(std::move(batch));
+                return result;
+            }
+
+            void start(internal::request_t request, callback_t callback) {
+                request->callback = std::move(callback);
+                std::vector<internal::request_t> batch;
+                batch.push_back(std::move(request));
+                this->dispatch(std::move(batch));
+            }
+
+        public:
+            /**
+             *  \param  queue_depth
+             *      Size of the io_uring submission queue.
+             *  \param  backend_type
+             *      The backend to use, Auto picks io_uring if supported.
+             *  \param  threads
+             *      Threads of the fallback backend.
+             *  \exception Exception
+             *      Throws if Backend::IoUring was requested but is unavailable.
+             */
+            explicit AsyncIO(unsigned queue_depth = 256, Backend backend_type = Backend::Auto, size_t threads = 4) {
+                #if defined(UTILS_AIO_IO_URING)
+                    if (backend_type != Backend::ThreadPool) {
+                        try {
+                            this->backend = std::make_unique<internal::IoUringBackend>(queue_depth, threads);
+                        } catch (const utils::exceptions::Exception&) {
+                            if (backend_type == Backend::IoUring) {
+                                throw;
+                            }
+                        }
+                    }
+                #else
+                    UNUSED(queue_depth);
+
+                    if (backend_type == Backend::IoUring) {
+                        throw utils::exceptions::Exception("utils::io::aio::AsyncIO", "io_uring is not supported.");
+                    }
+                #endif
+
+                if (!this->backend) {
+                    this->backend = std::make_unique<internal::ThreadPoolBackend>(threads);
+                }
+            }
+
+            AsyncIO(const AsyncIO&)            = delete;
+            AsyncIO& operator=(const AsyncIO&) = delete;
+
+            ~AsyncIO() {
+                LOCK_UNIQUE_BLOCK(this->pending->mutex);
+                this->pending->done.wait(__lock, [this]() { return this->pending->count == 0; });
+            }
+
+            /**
+             *  \brief  Whether the io_uring backend is used.
+             */
+            inline bool uses_io_uring(void) const {
+                return this->backend->is_io_uring();
+            }
+
+            /**
+             *  \brief  Block until all submitted operations completed.
+             *  \exception
+             *      Rethrows the first exception thrown by a completion callback since the last call.
+             */
+            void wait_all(void) {
+                LOCK_UNIQUE_BLOCK(this->pending->mutex);
+                this->pending->done.wait(__lock, [this]() { return this->pending->count == 0; });
+
+                if (HEDLEY_UNLIKELY(this->pending->error)) {
+                    std::rethrow_exception(std::exchange(this->pending->error, nullptr));
+                }
+            }
+
+            /**
+             *  \brief  Write \p length bytes at \p offset of \p fd.
+             *  \return A future with the amount of bytes written,
+             *          throws Exception with the system error on failure.
+             */
+            std::future<size_t> write(int fd, const void *data, size_t length, uint64_t offset) {
+                return this->start(this->make_request(fd, { { const_cast<void*>(data), length } }, offset, true));
+            }
+
+            /**
+             *  \brief  Read up to \p length bytes at \p offset of \p fd.
+             *  \return A future with the amount of bytes read (less at the end of the file).
+             */
+            std::future<size_t> read(int fd, void *data, size_t length, uint64_t offset) {
+                return this->start(this->make_request(fd, { { data, length } }, offset, false));
+            }
+
+            /**
+             *  \brief  Gather write of \p buffers at \p offset of \p fd, in one request.
+             */
+            std::future<size_t> writev(int fd, std::vector<iovec> buffers, uint64_t offset) {
+                return this->start(this->make_request(fd, std::move(buffers), offset, true));
+            }
+
+            /**
+             *  \brief  Scatter read into \p buffers at \p offset of \p fd, in one request.
+             */
+            std::future<size_t> readv(int fd, std::vector<iovec> buffers, uint64_t offset) {
+                return this->start(this->make_request(fd, std::move(buffers), offset, false));
+            }
+
+            /**
+             *  \brief  Write, calling \p callback with the bytes written or -errno on completion.
+             */
+            void write(int fd, const void *data, size_t length, uint64_t offset, callback_t callback) {
+                this->start(this->make_request(fd, { { const_cast<void*>(data), length } }, offset, true), std::move(callback));
+            }
+
+            /**
+             *  \brief  Read, calling \p callback with the bytes read or -errno on completion.
+             */
+            void read(int fd, void *data, size_t length, uint64_t offset, callback_t callback) {
+                this->start(this->make_request(fd, { { data, length } }, offset, false), std::move(callback));
+            }
+
+            void writev(int fd, std::vector<iovec> buffers, uint64_t offset, callback_t callback) {
+                this->start(this->make_request(fd, std::move(buffers), offset, true), std::move(callback));
+            }
+
+            void readv(int fd, std::vector<iovec> buffers, uint64_t offset, callback_t callback) {
+                this->start(this->make_request(fd, std::move(buffers), offset, false), std::move(callback));
+            }
+
+            /**
+             *  \brief  Submit a batch of operations at once (one system call with io_uring).
+             *  \return One future per operation, in order.
+             */
+            std::vector<std::future<size_t>> submit(std::vector<Operation> operations) {
+                std::vector<std::future<size_t>> results;
+                std::vector<internal::request_t> batch;
+                results.reserve(operations.size());
+                batch.reserve(operations.size());
+
+                for (Operation& op : operations) {
+                    batch.push_back(this->make_request(op.fd, std::move(op.buffers), op.offset, op.write));
+                    results.push_back(batch.back()->promise.get_future());
+                }
+
+                this->dispatch(std::move(batch));
+                return results;
+            }
+
+            /**
+             *  \brief  Register (pin) buffers for write_fixed() and read_fixed(),
+             *          replacing earlier registrations. Wait for pending fixed operations first.
+             *  \exception Exception
+             *      Throws if the kernel refused, e.g. over RLIMIT_MEMLOCK.
+             */
+            void register_buffers(std::vector<iovec> buffers) {
+                this->backend->register_buffers(buffers);
+                this->registered = std::move(buffers);
+            }
+
+            /**
+             *  \brief  Write \p length bytes from registered buffer \p index (from \p buffer_offset on).
+             */
+            std::future<size_t> write_fixed(int fd, size_t index, size_t length, uint64_t offset, size_t buffer_offset = 0) {
+                return this->start(this->make_fixed(fd, index, length, offset, buffer_offset, true));
+            }
+
+            /**
+             *  \brief  Read \p length bytes into registered buffer \p index (from \p buffer_offset on).
+             */
+            std::future<size_t> read_fixed(int fd, size_t index, size_t length, uint64_t offset, size_t buffer_offset = 0) {
+                return this->start(this->make_fixed(fd, index, length, offset, buffer_offset, false));
+            }
+
+            /**
+             *  \brief  Write \p data to a new (or truncated) file. The data and the file
+             *          are owned by the request, the file is closed on completion.
+             *  \exception FileWriteException
+             *      Throws FileWriteException if the file could not be created;
+             *      the future throws Exception on write errors.
+             */
+            std::future<size_t> write_file(const std::string& filename, std::vector<uint8_t> data) {
+                auto file  = std::make_shared<File>(File::open(filename, Mode::Write));
+                auto bytes = std::make_shared<std::vector<uint8_t>>(std::move(data));
+
+                auto r = this->make_request(file->get(), { { bytes->data(), bytes->size() } }, 0, true);
+                r->keep_alive = std::make_shared<std::pair<std::shared_ptr<File>, std::shared_ptr<std::vector<uint8_t>>>>(file, bytes);
+                return this->start(std::move(r));
+            }
+
+            std::future<size_t> write_file(const std::string& filename, const std::string_view str) {
+                return this->write_file(filename, std::vector<uint8_t>(str.begin(), str.end()));
+            }
+    };
+}
+#endif
+
+#endif // UTILS_AIO_HPP
@@ -0,0 +1,397 @@
+#ifndef UTILS_BENCHMARK_HPP
+#define UTILS_BENCHMARK_HPP
+
+#include "utils_compiler.hpp"
+#include "utils_json.hpp"
+#include "utils_logger.hpp"
+#include "utils_string.hpp"
+#include "utils_time.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <fstream>
+#include <functional>
+#include <limits>
+#include <string>
+#include <string_view>
+#include <vector>
+
+
+namespace utils::benchmark {
+    /**
+     *  \brief  Kinds of generated input data.
+     */
+    enum class Corpus {
+        RANDOM,       ///< Uniform random bytes, incompressible
+        TEXT,         ///< Words, spaces and punctuation with a skewed word choice
+        SKEWED,       ///< One byte 85% of the time, 7 others share the rest
+        REPETITIVE,   ///< A 1 KB pattern repeated with sparse changes
+    };
+
+    static constexpr inline std::array<Corpus, 4> CORPORA = {
+        Corpus::RANDOM, Corpus::TEXT, Corpus::SKEWED, Corpus::REPETITIVE
+    };
+
+    ATTR_MAYBE_UNUSED ATTR_NODISCARD
+    static inline std::string_view corpus_name(Corpus corpus) {
+        switch (corpus) {
+            case Corpus::RANDOM:     return "random";
+            case Corpus::TEXT:       return "text";
+            case Corpus::SKEWED:     return "skewed";
+            case Corpus::REPETITIVE: return "repetitive";
+        }
+
+        return "unknown";
+    }
+
+    /**
+     *  \brief  Generate \p size bytes of \p corpus.
+     *
+     *          The output only depends on the arguments, so results are comparable
+     *          between runs and releases.
+     *
+     *  \param  corpus
+     *      The kind of data.
+     *  \param  size
+     *      The amount of bytes.
+     *  \param  seed
+     *      Seed of the generator.
+     *  \return Returns the generated bytes.
+     */
+    ATTR_MAYBE_UNUSED ATTR_NODISCARD
+    static std::vector<uint8_t> generate(Corpus corpus, size_t size, uint64_t seed = 1) {
+        // splitmix64
+        const auto next = [&seed]() {
+            uint64_t z = (seed += 0x9E3779B97F4A7C15ull);
+            z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+            z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+            return z ^ (z >> 31);
+        };
+
+        std::vector<uint8_t> data;
+        data.reserve(size + 16u);
+
+        switch (corpus) {
+            case Corpus::RANDOM:
+                while (data.size() < size) {
+                    const uint64_t value = next();
+                    for (size_t i = 0; i < 8; i++) {
+                        data.push_back(uint8_t(value >> (8u * i)));
+                    }
+                }
+                break;
+
+            case Corpus::TEXT: {
+                static constexpr std::array<std::string_view, 32> words = {
+                    "the", "of", "and", "to", "a", "in", "is", "it", "that", "for", "was", "on",
+                    "with", "as", "be", "by", "at", "this", "from", "block", "stream", "symbol",
+                    "table", "frame", "decode", "encode", "buffer", "length", "value", "code",
+                    "library", "benchmark"
+                };
+
+                while (data.size() < size) {
+                    // Product of two uniform picks favours the first words
+                    const uint64_t value = next();
+                    const size_t word = (size_t(value % 32u) * size_t((value >> 8) % 32u)) / 32u;
+
+                    data.insert(data.end(), words[word].begin(), words[word].end());
+                    data.push_back((value >> 16) % 12u == 0 ? uint8_t((value >> 24) % 2u ? '.' : ',') : uint8_t(' '));
+                    if ((value >> 32) % 16u == 0) {
+                        data.push_back('\n');
+                    }
+                }
+                break;
+            }
+
+            case Corpus::SKEWED:
+                while (data.size() < size) {
+                    const uint64_t value = next();
+                    for (size_t i = 0; i < 4; i++) {
+                        const uint32_t part = uint32_t(value >> (16u * i)) & 0xFFFFu;
+                        data.push_back(part % 100u < 85u ? uint8_t(0) : uint8_t(1u + (part >> 8) % 7u));
+                    }
+                }
+                break;
+
+            case Corpus::REPETITIVE: {
+                std::array<uint8_t, 1024> pattern;
+                for (auto& byte : pattern) {
+                    byte = uint8_t('a' + next() % 26u);
+                }
+
+                while (data.size() < size) {
+                    pattern[next() % pattern.size()] = uint8_t('a' + next() % 26u);
+                    data.insert(data.end(), pattern.begin(), pattern.end());
+                }
+                break;
+            }
+        }
+
+        data.resize(size);
+        return data;
+    }
+
+    /**
+     *  \brief  A codec to benchmark, \p decode must invert \p encode.
+     */
+    struct Codec {
+        using Function = std::function<std::vector<uint8_t>(const std::vector<uint8_t>&)>;
+
+        std::string name;
+        Function    encode;
+        Function    decode;
+        size_t      alignment = 1;   ///< Input sizes are rounded down to a multiple
+    };
+
+    /**
+     *  \brief  Measurements of one codec on one input.
+     *
+     *          Times and cycles are the fastest of all runs.
+     */
+    struct Result {
+        std::string codec;
+        std::string corpus;
+        size_t      size          = 0;
+        size_t      encoded_size  = 0;
+        size_t      runs          = 0;
+        double      encode_ns     = 0.0;
+        double      decode_ns     = 0.0;
+        uint64_t    encode_cycles = 0;
+        uint64_t    decode_cycles = 0;
+        bool        round_trip    = false;
+
+        inline double ratio(void) const {
+            return this->size == 0 ? 0.0 : double(this->encoded_size) / double(this->size);
+        }
+
+        inline double encode_mbs(void) const {
+            return this->encode_ns <= 0.0 ? 0.0 : double(this->size) / this->encode_ns * 1.0e3;
+        }
+
+        inline double decode_mbs(void) const {
+            return this->decode_ns <= 0.0 ? 0.0 : double(this->size) / this->decode_ns * 1.0e3;
+        }
+
+        inline double encode_cpb(void) const {
+            return this->size == 0 ? 0.0 : double(this->encode_cycles) / double(this->size);
+        }
+
+        inline double decode_cpb(void) const {
+            return this->size == 0 ? 0.0 : double(this->decode_cycles) / double(this->size);
+        }
+    };
+
+    /**
+     *  \brief  The registered codecs.
+     *
+     *          Not static: every translation unit registering codecs shares this list.
+     */
+    inline std::vector<Codec>& codecs(void) {
+        static std::vector<Codec> list;
+        return list;
+    }
+
+    /**
+     *  \brief  Register a codec at static initialization:
+     *          static const utils::benchmark::Register name{ Codec{ ... } };
+     */
+    struct Register {
+        explicit Register(Codec codec) {
+            utils::benchmark::codecs().push_back(std::move(codec));
+        }
+    };
+
+    /**
+     *  \brief  Benchmark \p codec on \p data.
+     *
+     *          Every direction runs at least \p min_runs times and until \p min_ms
+     *          milliseconds are spent, the output of the first runs is checked to
+     *          round trip.
+     *
+     *  \param  codec
+     *      The codec to measure.
+     *  \param  corpus
+     *      Name of the input, for the result.
+     *  \param  data
+     *      The input.
+     *  \param  min_ms
+     *      Minimum time to spend per direction.
+     *  \param  min_runs
+     *      Minimum runs per direction.
+     *  \return Returns the measurements.
+     */
+    ATTR_MAYBE_UNUSED ATTR_NODISCARD
+    static Result measure(const Codec& codec, std::string_view corpus, const std::vector<uint8_t>& data,
+                          double min_ms = 100.0, size_t min_runs = 3)
+    {
+        Result result;
+        result.codec  = codec.name;
+        result.corpus = std::string(corpus);
+        result.size   = data.size();
+
+        std::vector<uint8_t> encoded = codec.encode(data);
+        std::vector<uint8_t> decoded = codec.decode(encoded);
+        result.encoded_size = encoded.size();
+        result.round_trip   = decoded == data;
+
+        const auto best_of = [min_ms, min_runs](auto&& f, double& best_ns, uint64_t& best_cycles) {
+            best_ns     = std::numeric_limits<double>::max();
+            best_cycles = std::numeric_limits<uint64_t>::max();
+
+            double total_ms = 0.0;
+            size_t runs     = 0;
+
+            for (; runs < min_runs || total_ms < min_ms; runs++) {
+                uint64_t cycles = 0;
+                const double ns = utils::time::Timer::time([&]() {
+                    cycles = utils::time::Timer::time_cycles(f);
+                });
+
+                best_ns     = std::min(best_ns, ns);
+                best_cycles = std::min(best_cycles, cycles);
+                total_ms   += ns / 1.0e6;
+            }
+
+            return runs;
+        };
+
+        result.runs = best_of([&]() { encoded = codec.encode(data); }, result.encode_ns, result.encode_cycles);
+        result.runs = std::min(result.runs,
+                               best_of([&]() { decoded = codec.decode(encoded); }, result.decode_ns, result.decode_cycles));
+
+        return result;
+    }
+
+    /**
+     *  \brief  Machine readable form of \p results.
+     *
+     *  \param  results
+     *      The measurements.
+     *  \param  version
+     *      Version of the library, to track results between releases.
+     *  \return Returns a JSON object with the version, a timestamp and per result its fields.
+     */
+    ATTR_MAYBE_UNUSED ATTR_NODISCARD
+    static utils::json to_json(const std::vector<Result>& results, std::string_view version) {
+        utils::json report;
+        report["version"]   = std::string(version);
+        report["timestamp"] = utils::time::Timestamp();
+        report["results"]   = utils::json::array();
+
+        for (const auto& result : results) {
+            report["results"].push_back({
+                { "codec",         result.codec },
+                { "corpus",        result.corpus },
+                { "size",          result.size },
+                { "encoded_size",  result.encoded_size },
+                { "ratio",         result.ratio() },
+                { "encode_mb_s",   result.encode_mbs() },
+                { "decode_mb_s",   result.decode_mbs() },
+                { "encode_cpb",    result.encode_cpb() },
+                { "decode_cpb",    result.decode_cpb() },
+                { "runs",          result.runs },
+                { "round_trip",    result.round_trip },
+            });
+        }
+
+        return report;
+    }
+
+    /**
+     *  \brief  Benchmark every registered codec on every corpus and size, print a
+     *          table and write the JSON report.
+     *
+     *          Options:
+     *              --filter=<text>     Only codecs whose name contains <text>
+     *              --sizes=<n,n,...>   Input sizes in bytes (default 4096,65536,1048576), skipped when
+     *                                  below a codec's alignment
+     *              --min-ms=<ms>       Minimum time per measurement (default 100)
+     *              --json=<path>       Report file (default utils_bench_results.json), empty to skip
+     *
+     *  \param  argc
+     *      Argument count of main().
+     *  \param  argv
+     *      Arguments of main().
+     *  \param  version
+     *      Version of the library for the report.
+     *  \return Returns 0 if every codec round tripped, 1 otherwise.
+     */
+    ATTR_MAYBE_UNUSED
+    static int run(int argc, char *argv[], std::string_view version) {
+        std::string filter;
+        std::string json_path = "utils_bench_results.json";
+        std::vector<size_t> sizes = { 4096u, 65536u, 1048576u };
+        double min_ms = 100.0;
+
+        for (int i = 1; i < argc; i++) {
+            const std::string_view arg(argv[i]);
+            const auto value = [&arg](std::string_view option) {
+                return arg.substr(option.size());
+            };
+
+            if (utils::string::starts_with(arg, "--filter=")) {
+                filter = std::string(value("--filter="));
+            } else if (utils::string::starts_with(arg, "--json=")) {
+                json_path = std::string(value("--json="));
+            } else if (utils::string::starts_with(arg, "--min-ms=")) {
+                min_ms = std::stod(std::string(value("--min-ms=")));
+            } else if (utils::string::starts_with(arg, "--sizes=")) {
+                sizes.clear();
+                for (const auto& size : utils::string::split(value("--sizes="), ",")) {
+                    sizes.push_back(std::stoull(std::string(size)));
+                }
+            }
+        }
+
+        // Keep codec logging out of the table
+        const auto level = utils::Logger::GetScreenLogLevel();
+        utils::Logger::SetScreenLogLevel(utils::Logger::Level::LOG_WARNING);
+
+        utils::Logger::Writef("%-16s %-11s %9s %9s %7s %10s %10s %8s %8s\n",
+                              "codec", "corpus", "size", "encoded", "ratio",
+                              "enc MB/s", "dec MB/s", "enc c/B", "dec c/B");
+
+        std::vector<Result> results;
+        bool ok = true;
+
+        for (const auto& codec : utils::benchmark::codecs()) {
+            if (!filter.empty() && codec.name.find(filter) == std::string::npos) {
+                continue;
+            }
+
+            for (const Corpus corpus : CORPORA) {
+                for (const size_t size : sizes) {
+                    // Codecs return no stream for empty input, and there is no throughput to measure
+                    if (size < codec.alignment) {
+                        continue;
+                    }
+
+                    const auto data = utils::benchmark::generate(corpus, size - size % codec.alignment);
+                    const Result result = utils::benchmark::measure(codec, corpus_name(corpus), data, min_ms);
+
+                    utils::Logger::Writef("%-16s %-11s %9zu %9zu %7.3f %10.1f %10.1f %8.2f %8.2f%s\n",
+                                          result.codec.c_str(), result.corpus.c_str(), result.size, result.encoded_size,
+                                          result.ratio(), result.encode_mbs(), result.decode_mbs(),
+                                          result.encode_cpb(), result.decode_cpb(),
+                                          result.round_trip ? "" : "  ROUND TRIP FAILED");
+
+                    ok = ok && result.round_trip;
+                    results.push_back(result);
+                }
+            }
+        }
+
+        utils::Logger::SetScreenLogLevel(level);
+
+        if (!json_path.empty()) {
+            std::ofstream file(json_path);
+            file << utils::benchmark::to_json(results, version).dump(2) << '\n';
+            utils::Logger::Writef("Results written to %s\n", json_path.c_str());
+        }
+
+        return ok ? 0 : 1;
+    }
+}
+
+#endif // UTILS_BENCHMARK_HPP
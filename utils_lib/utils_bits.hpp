@@ -7,6 +7,7 @@
 #include "utils_algorithm.hpp"
 
 #include <cstdint>
+#include <cstring>
 #include <limits>
 #include <numeric>
 
@@ -26,6 +27,12 @@
 
 #define UTILS_BITS_ASSERT_SHIFT_SIGNED_SIZE 0
 
+#if defined(__BYTE_ORDER__) && defined(__ORDER_BIG_ENDIAN__) && (__BYTE_ORDER__ == __ORDER_BIG_ENDIAN__)
+    #define UTILS_BITS_BIG_ENDIAN 1
+#else
+    #define UTILS_BITS_BIG_ENDIAN 0
+#endif
+
 
 namespace utils::bits {
     namespace internal {
@@ -585,9 +592,129 @@ namespace utils::bits {
         utils::algorithm::reverse(out);
         return out;
     }
+    /**
+     *  True when the host stores multi-byte values big endian.
+     */
+    static inline constexpr bool is_big_endian = UTILS_BITS_BIG_ENDIAN;
+
+    /**
+     *  Unsigned integer type of the given size in bytes.
+     */
+    template <size_t Bytes> struct uint_of_size;
+    template <> struct uint_of_size<1> { using type = uint8_t;  };
+    template <> struct uint_of_size<2> { using type = uint16_t; };
+    template <> struct uint_of_size<4> { using type = uint32_t; };
+    template <> struct uint_of_size<8> { using type = uint64_t; };
+
+    template <size_t Bytes>
+    using uint_of_size_t = typename uint_of_size<Bytes>::type;
+
+    /**
+     *  \brief  Map a signed value to an unsigned one, small magnitudes to small values
+     *          (0, -1, 1, -2, ... => 0, 1, 2, 3, ...).
+     */
+    ATTR_MAYBE_UNUSED ATTR_NODISCARD
+    static inline constexpr uint64_t zigzag_encode(const int64_t value) {
+        return (uint64_t(value) << 1u) ^ uint64_t(value >> 63);
+    }
+
+    /**
+     *  \brief  Inverse of zigzag_encode.
+     */
+    ATTR_MAYBE_UNUSED ATTR_NODISCARD
+    static inline constexpr int64_t zigzag_decode(const uint64_t value) {
+        return int64_t(value >> 1u) ^ -int64_t(value & 1u);
+    }
+
+    /**
+     *  \brief  Reverse the byte order of the given \p value.
+     *
+     *  \param  value
+     *      The value to swap.
+     *  \return Returns \p value with its bytes in reverse order.
+     */
+    template<class T> ATTR_MAYBE_UNUSED ATTR_NODISCARD
+    static inline T byteswap(const T value) {
+        static_assert(std::is_integral_v<T>, "utils::bits::byteswap: Integral required.");
+        using uT = typename std::make_unsigned<T>::type;
+
+        if constexpr (sizeof(T) == 1) {
+            return value;
+        } else if constexpr (sizeof(T) == 2) {
+            #ifdef UTILS_COMPILER_MSVC
+                return T(_byteswap_ushort(uT(value)));
+            #else
+                return T(__builtin_bswap16(uT(value)));
+            #endif
+        } else if constexpr (sizeof(T) == 4) {
+            #ifdef UTILS_COMPILER_MSVC
+                return T(_byteswap_ulong(uT(value)));
+            #else
+                return T(__builtin_bswap32(uT(value)));
+            #endif
+        } else {
+            static_assert(sizeof(T) == 8, "utils::bits::byteswap: Unsupported size.");
+            #ifdef UTILS_COMPILER_MSVC
+                return T(_byteswap_uint64(uT(value)));
+            #else
+                return T(__builtin_bswap64(uT(value)));
+            #endif
+        }
+    }
+
+    /**
+     *  \brief  Load a big endian (MSB first) value from possibly unaligned memory.
+     */
+    template<class T> ATTR_MAYBE_UNUSED ATTR_NODISCARD
+    static inline T load_big_endian(const uint8_t *src) {
+        T value;
+        std::memcpy(&value, src, sizeof(T));
+        #if UTILS_BITS_BIG_ENDIAN
+            return value;
+        #else
+            return utils::bits::byteswap(value);
+        #endif
+    }
+
+    /**
+     *  \brief  Load a little endian (LSB first) value from possibly unaligned memory.
+     */
+    template<class T> ATTR_MAYBE_UNUSED ATTR_NODISCARD
+    static inline T load_little_endian(const uint8_t *src) {
+        T value;
+        std::memcpy(&value, src, sizeof(T));
+        #if UTILS_BITS_BIG_ENDIAN
+            return utils::bits::byteswap(value);
+        #else
+            return value;
+        #endif
+    }
+
+    /**
+     *  \brief  Store \p value big endian (MSB first) into possibly unaligned memory.
+     */
+    template<class T> ATTR_MAYBE_UNUSED
+    static inline void store_big_endian(uint8_t *dst, T value) {
+        #if !UTILS_BITS_BIG_ENDIAN
+            value = utils::bits::byteswap(value);
+        #endif
+        std::memcpy(dst, &value, sizeof(T));
+    }
+
+    /**
+     *  \brief  Store \p value little endian (LSB first) into possibly unaligned memory.
+     */
+    template<class T> ATTR_MAYBE_UNUSED
+    static inline void store_little_endian(uint8_t *dst, T value) {
+        #if UTILS_BITS_BIG_ENDIAN
+            value = utils::bits::byteswap(value);
+        #endif
+        std::memcpy(dst, &value, sizeof(T));
+    }
 }
 
 #undef UTILS_BITS_CLZ_ULL
 #undef UTILS_BITS_FFS_LL
 #undef UTILS_BITS_CNT_LL
+#undef UTILS_BITS_BIG_ENDIAN
 #endif // UTILS_BITS_HPP
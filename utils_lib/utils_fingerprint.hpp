@@ -0,0 +1,354 @@
+#ifndef UTILS_FINGERPRINT_HPP
+#define UTILS_FINGERPRINT_HPP
+
+#include "utils_compiler.hpp"
+#include "utils_exceptions.hpp"
+#include "utils_hash.hpp"
+#include "utils_io.hpp"
+
+#include <algorithm>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#if defined(UTILS_OS_LINUX) || defined(UTILS_OS_MAC)
+    #include <sys/stat.h>
+#endif
+
+
+#ifdef UTILS_IO_FS_SUPPORTED
+namespace utils::io {
+    /**
+     *  \brief  Identity of a file's contents: size, modification time and XXH64 hash.
+     */
+    struct Fingerprint {
+        uint64_t size     = 0;
+        int64_t  mtime_ns = 0;  ///< Modification time in ns, only compared for equality
+        uint64_t hash     = 0;
+
+        inline bool operator==(const Fingerprint& other) const {
+            return this->size == other.size && this->mtime_ns == other.mtime_ns && this->hash == other.hash;
+        }
+
+        inline bool operator!=(const Fingerprint& other) const {
+            return !(*this == other);
+        }
+    };
+
+    namespace internal {
+        /**
+         *  \brief  Size and modification time of a file, without reading it.
+         *  \return false if the file could not be inspected.
+         */
+        ATTR_MAYBE_UNUSED ATTR_NODISCARD
+        static bool file_stat(const std::string& filename, uint64_t& size, int64_t& mtime_ns) {
+            #if defined(UTILS_OS_LINUX)
+                struct stat st;
+                if (::stat(filename.c_str(), &st) != 0) {
+                    return false;
+                }
+                size     = uint64_t(st.st_size);
+                mtime_ns = int64_t(st.st_mtim.tv_sec) * 1000000000 + st.st_mtim.tv_nsec;
+                return true;
+            #elif defined(UTILS_OS_MAC)
+                struct stat st;
+                if (::stat(filename.c_str(), &st) != 0) {
+                    return false;
+                }
+                size     = uint64_t(st.st_size);
+                mtime_ns = int64_t(st.st_mtimespec.tv_sec) * 1000000000 + st.st_mtimespec.tv_nsec;
+                return true;
+            #else
+                std::error_code ec;
+                const auto modified = fs::last_write_time(filename, ec);
+                size = fs::file_size(filename, ec);
+                if (ec) {
+                    return false;
+                }
+                mtime_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(modified.time_since_epoch()).count();
+                return true;
+            #endif
+        }
+    }
+
+    /**
+     *  \brief  XXH64 hash of a file's contents, read through a memory mapping.
+     *  \exception FileReadException
+     *      Throws FileReadException if the file could not be read.
+     */
+    ATTR_MAYBE_UNUSED ATTR_NODISCARD
+    static inline uint64_t file_hash(const std::string& filename) {
+        const MappedFile file = utils::io::map_file(filename, AccessAdvice::Sequential);
+        return utils::hash::xxhash64(file.data(), file.size());
+    }
+
+    /**
+     *  \brief  Fingerprint of a file.
+     *  \exception FileReadException
+     *      Throws FileReadException if the file could not be read.
+     */
+    ATTR_MAYBE_UNUSED ATTR_NODISCARD
+    static Fingerprint file_fingerprint(const std::string& filename) {
+        Fingerprint fp;
+
+        if (!internal::file_stat(filename, fp.size, fp.mtime_ns)) {
+            throw utils::exceptions::FileReadException(filename);
+        }
+
+        fp.hash = utils::io::file_hash(filename);
+        return fp;
+    }
+
+    /**
+     *  \brief  Persistent index of file fingerprints for incremental processing.
+     *
+     *          update() rescans a folder in parallel and only hashes files whose
+     *          size or modification time changed, reporting added, modified and
+     *          removed files. Files that were only touched (same hash) are not
+     *          reported as modified.
+     *
+     *          On disk (little endian): "UFPI", version, entry count, then per entry
+     *          (sorted by path) the length of the prefix shared with the previous path
+     *          and the remaining suffix as LEB128 length and bytes, LEB128 size,
+     *          zigzag LEB128 mtime and the 64 bit hash, followed by the XXH64 of all
+     *          preceding bytes.
+     */
+    class FingerprintIndex {
+        public:
+            static constexpr uint32_t MAGIC   = 0x49504655;    ///< "UFPI"
+            static constexpr uint32_t VERSION = 1;
+
+            /**
+             *  Result of update(), paths are sorted.
+             */
+            struct Changes {
+                std::vector<std::string> added;
+                std::vector<std::string> modified;
+                std::vector<std::string> removed;
+                size_t hashed = 0;  ///< Files whose contents were read
+
+                inline bool empty(void) const {
+                    return this->added.empty() && this->modified.empty() && this->removed.empty();
+                }
+            };
+
+        private:
+            std::unordered_map<std::string, Fingerprint> entries;
+
+        public:
+            FingerprintIndex() = default;
+
+            inline size_t size(void) const {
+                return this->entries.size();
+            }
+
+            inline void clear(void) {
+                this->entries.clear();
+            }
+
+            /**
+             *  \brief  The fingerprint of \p path, nullptr if not indexed.
+             */
+            const Fingerprint* find(const std::string& path) const {
+                const auto it = this->entries.find(path);
+                return it == this->entries.end() ? nullptr : &it->second;
+            }
+
+            inline const std::unordered_map<std::string, Fingerprint>& get_entries(void) const {
+                return this->entries;
+            }
+
+            /**
+             *  \brief  Rescan all regular files under \p folder. Only files with a changed
+             *          size or modification time are hashed, on \p threads threads.
+             *          Entries under \p folder that no longer exist are removed.
+             *
+             *  \exception Exception
+             *      Throws Exception if \p folder could not be scanned.
+             */
+            Changes update(const std::string_view folder, size_t threads = std::max(std::thread::hardware_concurrency(), 1u)) {
+                Changes changes;
+                std::unordered_map<std::string, Fingerprint> seen;
+                std::mutex mutex;
+
+                utils::io::scan_directory(folder, [&](const ScanEntry& entry) {
+                    if (entry.type != EntryType::File) {
+                        return;
+                    }
+
+                    std::string path(entry.path);
+                    Fingerprint fp;
+
+                    if (!internal::file_stat(path, fp.size, fp.mtime_ns)) {
+                        return;
+                    }
+
+                    // Unchanged stat: trust the stored hash
+                    const Fingerprint *old = this->find(path);
+                    bool hashed = false;
+
+                    if (old && old->size == fp.size && old->mtime_ns == fp.mtime_ns) {
+                        fp.hash = old->hash;
+                    } else {
+                        try {
+                            fp.hash = utils::io::file_hash(path);
+                            hashed  = true;
+                        } catch (const utils::exceptions::Exception&) {
+                            return;     // Removed or unreadable meanwhile
+                        }
+                    }
+
+                    LOCK_BLOCK(mutex);
+                    changes.hashed += hashed;
+
+                    if (!old) {
+                        changes.added.push_back(path);
+                    } else if (old->hash != fp.hash || old->size != fp.size) {
+                        changes.modified.push_back(path);
+                    }
+
+                    seen.emplace(std::move(path), fp);
+                }, threads);
+
+                // Entries below the folder that were not seen are gone
+                std::string prefix(folder);
+                if (!prefix.empty() && prefix.back() != '/') {
+                    prefix += '/';
+                }
+
+                for (auto it = this->entries.begin(); it != this->entries.end(); ) {
+                    if (it->first.compare(0, prefix.size(), prefix) == 0 && !seen.count(it->first)) {
+                        changes.removed.push_back(it->first);
+                        it = this->entries.erase(it);
+                    } else {
+                        ++it;
+                    }
+                }
+
+                for (auto& [path, fp] : seen) {
+                    this->entries[path] = fp;
+                }
+
+                std::sort(changes.added.begin(),    changes.added.end());
+                std::sort(changes.modified.begin(), changes.modified.end());
+                std::sort(changes.removed.begin(),  changes.removed.end());
+                return changes;
+            }
+
+            /**
+             *  \brief  Store the index in \p filename, replaced atomically.
+             *  \exception FileWriteException
+             *      Throws FileWriteException if the file could not be written.
+             */
+            void save(const std::string& filename) const {
+                std::vector<const std::pair<const std::string, Fingerprint>*> sorted;
+                sorted.reserve(this->entries.size());
+                for (const auto& entry : this->entries) {
+                    sorted.push_back(&entry);
+                }
+                std::sort(sorted.begin(), sorted.end(), [](const auto *a, const auto *b) {
+                    return a->first < b->first;
+                });
+
+                LsbBitStreamWriter writer(size_t(64) + this->entries.size() * 48);
+                writer.write<uint32_t>(MAGIC);
+                writer.write<uint32_t>(VERSION);
+                writer.write<uint64_t>(sorted.size());
+
+                std::string_view previous;
+                for (const auto *entry : sorted) {
+                    const std::string& path = entry->first;
+                    const size_t limit = std::min(previous.size(), path.size());
+
+                    size_t shared = 0;
+                    while (shared < limit && previous[shared] == path[shared]) {
+                        shared++;
+                    }
+
+                    writer.put_leb128(shared);
+                    writer.put_leb128(path.size() - shared);
+                    writer.write_bytes(reinterpret_cast<const uint8_t*>(path.data()) + shared, path.size() - shared);
+                    writer.put_leb128(entry->second.size);
+                    writer.put_zigzag_varint(entry->second.mtime_ns);
+                    writer.write<uint64_t>(entry->second.hash);
+                    previous = path;
+                }
+
+                writer.write<uint64_t>(utils::hash::xxhash64(writer.get_buffer(), writer.get_last_byte_position()));
+
+                const std::string temporary = filename + ".tmp";
+                writer.write_to_file(temporary);
+
+                std::error_code ec;
+                fs::rename(temporary, filename, ec);
+                if (ec) {
+                    fs::remove(temporary, ec);
+                    throw utils::exceptions::FileWriteException(filename);
+                }
+            }
+
+            /**
+             *  \brief  Load an index stored with save(). A missing file gives an empty index.
+             *  \exception Exception
+             *      Throws Exception if the file is corrupt or of another version.
+             */
+            static FingerprintIndex load(const std::string& filename) {
+                FingerprintIndex index;
+
+                if (!fs::exists(filename)) {
+                    return index;
+                }
+
+                const MappedFile file = utils::io::map_file(filename);
+                const auto corrupt = [&filename]() {
+                    return utils::exceptions::Exception("utils::io::FingerprintIndex", filename + ": corrupt index.");
+                };
+
+                if (file.size() < 24
+                 || utils::bits::load_little_endian<uint64_t>(file.data() + file.size() - 8)
+                    != utils::hash::xxhash64(file.data(), file.size() - 8))
+                {
+                    throw corrupt();
+                }
+
+                LsbBitStreamReader reader(const_cast<uint8_t*>(file.data()), file.size() - 8);
+
+                if (reader.read<uint32_t>() != MAGIC || reader.read<uint32_t>() != VERSION) {
+                    throw utils::exceptions::Exception("utils::io::FingerprintIndex", filename + ": unsupported index.");
+                }
+
+                const uint64_t count = reader.read<uint64_t>();
+                std::string path;
+                index.entries.reserve(size_t(std::min<uint64_t>(count, file.size())));
+
+                for (uint64_t i = 0; i < count; i++) {
+                    const uint64_t shared = reader.get_leb128();
+                    const uint64_t suffix = reader.get_leb128();
+
+                    if (shared > path.size() || suffix > file.size()) {
+                        throw corrupt();
+                    }
+
+                    path.resize(size_t(shared + suffix));
+                    reader.read_bytes(reinterpret_cast<uint8_t*>(path.data()) + shared, size_t(suffix));
+
+                    Fingerprint fp;
+                    fp.size     = reader.get_leb128();
+                    fp.mtime_ns = reader.get_zigzag_varint();
+                    fp.hash     = reader.read<uint64_t>();
+
+                    if (reader.get_position() > reader.get_size() * 8u) {
+                        throw corrupt();
+                    }
+
+                    index.entries.emplace(path, fp);
+                }
+
+                return index;
+            }
+    };
+}
+#endif
+
+#endif // UTILS_FINGERPRINT_HPP
@@ -0,0 +1,197 @@
+#ifndef UTILS_HASH_HPP
+#define UTILS_HASH_HPP
+
+#include "utils_compiler.hpp"
+#include "utils_bits.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+
+namespace utils::hash {
+    /*
+     *  XXH64, compatible with the reference implementation.
+     *  Reference: https://github.com/Cyan4973/xxHash/blob/dev/doc/xxhash_spec.md
+     */
+    namespace internal {
+        static constexpr uint64_t XXH_PRIME64_1 = 0x9E3779B185EBCA87ull;
+        static constexpr uint64_t XXH_PRIME64_2 = 0xC2B2AE3D27D4EB4Full;
+        static constexpr uint64_t XXH_PRIME64_3 = 0x165667B19E3779F9ull;
+        static constexpr uint64_t XXH_PRIME64_4 = 0x85EBCA77C2B2AE63ull;
+        static constexpr uint64_t XXH_PRIME64_5 = 0x27D4EB2F165667C5ull;
+
+        ATTR_MAYBE_UNUSED ATTR_NODISCARD
+        static inline uint64_t xxh64_round(uint64_t acc, uint64_t input) {
+            acc += input * XXH_PRIME64_2;
+            acc  = utils::bits::rotl(acc, 31);
+            return acc * XXH_PRIME64_1;
+        }
+
+        ATTR_MAYBE_UNUSED ATTR_NODISCARD
+        static inline uint64_t xxh64_merge_round(uint64_t acc, uint64_t value) {
+            acc ^= xxh64_round(0, value);
+            return acc * XXH_PRIME64_1 + XXH_PRIME64_4;
+        }
+
+        /**
+         *  \brief  Hash the last (less than 32) bytes into \p h and mix.
+         */
+        ATTR_MAYBE_UNUSED ATTR_NODISCARD
+        static inline uint64_t xxh64_finalize(uint64_t h, const uint8_t *p, size_t length) {
+            for (; length >= 8; length -= 8, p += 8) {
+                h ^= xxh64_round(0, utils::bits::load_little_endian<uint64_t>(p));
+                h  = utils::bits::rotl(h, 27) * XXH_PRIME64_1 + XXH_PRIME64_4;
+            }
+
+            if (length >= 4) {
+                h ^= uint64_t(utils::bits::load_little_endian<uint32_t>(p)) * XXH_PRIME64_1;
+                h  = utils::bits::rotl(h, 23) * XXH_PRIME64_2 + XXH_PRIME64_3;
+                length -= 4;
+                p      += 4;
+            }
+
+            for (; length > 0; length--, p++) {
+                h ^= *p * XXH_PRIME64_5;
+                h  = utils::bits::rotl(h, 11) * XXH_PRIME64_1;
+            }
+
+            h ^= h >> 33;
+            h *= XXH_PRIME64_2;
+            h ^= h >> 29;
+            h *= XXH_PRIME64_3;
+            h ^= h >> 32;
+            return h;
+        }
+    }
+
+    /**
+     *  \brief  Incremental XXH64 hash, for data arriving in pieces.
+     */
+    class XXHash64 {
+        private:
+            uint64_t v[4];
+            uint64_t total  = 0;
+            uint64_t seed;
+            uint8_t  buffer[32];
+            size_t   buffered = 0;
+
+            inline void stripe(const uint8_t *p) {
+                for (size_t i = 0; i < 4; i++) {
+                    this->v[i] = internal::xxh64_round(this->v[i], utils::bits::load_little_endian<uint64_t>(p + 8 * i));
+                }
+            }
+
+        public:
+            explicit XXHash64(uint64_t hash_seed = 0) {
+                this->reset(hash_seed);
+            }
+
+            void reset(uint64_t hash_seed = 0) {
+                this->seed = hash_seed;
+                this->v[0] = hash_seed + internal::XXH_PRIME64_1 + internal::XXH_PRIME64_2;
+                this->v[1] = hash_seed + internal::XXH_PRIME64_2;
+                this->v[2] = hash_seed;
+                this->v[3] = hash_seed - internal::XXH_PRIME64_1;
+                this->total    = 0;
+                this->buffered = 0;
+            }
+
+            void update(const void *data, size_t length) {
+                const uint8_t *p = static_cast<const uint8_t*>(data);
+                this->total += length;
+
+                if (this->buffered > 0) {
+                    const size_t fill = std::min(length, sizeof(this->buffer) - this->buffered);
+                    std::memcpy(this->buffer + this->buffered, p, fill);
+                    this->buffered += fill;
+                    p      += fill;
+                    length -= fill;
+
+                    if (this->buffered < sizeof(this->buffer)) {
+                        return;
+                    }
+
+                    this->stripe(this->buffer);
+                    this->buffered = 0;
+                }
+
+                for (; length >= 32; length -= 32, p += 32) {
+                    this->stripe(p);
+                }
+
+                std::memcpy(this->buffer, p, length);
+                this->buffered = length;
+            }
+
+            inline void update(const std::string_view str) {
+                this->update(str.data(), str.size());
+            }
+
+            ATTR_NODISCARD
+            uint64_t digest(void) const {
+                uint64_t h;
+
+                if (this->total >= 32) {
+                    h = utils::bits::rotl(this->v[0], 1)  + utils::bits::rotl(this->v[1], 7)
+                      + utils::bits::rotl(this->v[2], 12) + utils::bits::rotl(this->v[3], 18);
+
+                    for (size_t i = 0; i < 4; i++) {
+                        h = internal::xxh64_merge_round(h, this->v[i]);
+                    }
+                } else {
+                    h = this->seed + internal::XXH_PRIME64_5;
+                }
+
+                return internal::xxh64_finalize(h + this->total, this->buffer, this->buffered);
+            }
+    };
+
+    /**
+     *  \brief  XXH64 hash of \p length bytes: fast, non-cryptographic, 64 bit.
+     *
+     *  \param  data
+     *      The data to hash.
+     *  \param  length
+     *      Length of the data in bytes.
+     *  \param  seed
+     *      Seed, different seeds give independent hashes.
+     */
+    ATTR_MAYBE_UNUSED ATTR_NODISCARD
+    static inline uint64_t xxhash64(const void *data, size_t length, uint64_t seed = 0) {
+        const uint8_t *p = static_cast<const uint8_t*>(data);
+        uint64_t h;
+
+        if (length >= 32) {
+            uint64_t v1 = seed + internal::XXH_PRIME64_1 + internal::XXH_PRIME64_2;
+            uint64_t v2 = seed + internal::XXH_PRIME64_2;
+            uint64_t v3 = seed;
+            uint64_t v4 = seed - internal::XXH_PRIME64_1;
+
+            const uint8_t *const end = p + (length & ~size_t(31));
+            for (; p < end; p += 32) {
+                v1 = internal::xxh64_round(v1, utils::bits::load_little_endian<uint64_t>(p));
+                v2 = internal::xxh64_round(v2, utils::bits::load_little_endian<uint64_t>(p + 8));
+                v3 = internal::xxh64_round(v3, utils::bits::load_little_endian<uint64_t>(p + 16));
+                v4 = internal::xxh64_round(v4, utils::bits::load_little_endian<uint64_t>(p + 24));
+            }
+
+            h = utils::bits::rotl(v1, 1) + utils::bits::rotl(v2, 7) + utils::bits::rotl(v3, 12) + utils::bits::rotl(v4, 18);
+            h = internal::xxh64_merge_round(h, v1);
+            h = internal::xxh64_merge_round(h, v2);
+            h = internal::xxh64_merge_round(h, v3);
+            h = internal::xxh64_merge_round(h, v4);
+        } else {
+            h = seed + internal::XXH_PRIME64_5;
+        }
+
+        return internal::xxh64_finalize(h + length, p, length & 31);
+    }
+
+    ATTR_MAYBE_UNUSED ATTR_NODISCARD
+    static inline uint64_t xxhash64(const std::string_view str, uint64_t seed = 0) {
+        return utils::hash::xxhash64(str.data(), str.size(), seed);
+    }
+}
+
+#endif // UTILS_HASH_HPP
@@ -28,16 +28,18 @@ namespace utils::ini {
         private:
             bool read_from_file;
             const std::string filename;
-            std::stringstream inifile;
 
             std::map<std::string, Contents> settings_map;
 
-            void parse() {
+            void parse(const std::string_view text) {
+                constexpr std::string_view whitespace = " \t\n\v\f\r";
                 const size_t val_delim_size = std::strlen(TDelimiters::values.delimiter);
                 std::string current_section = "";
 
-                for (std::string line; std::getline(this->inifile, line); ) {
-                    utils::string::ltrim(line);
+                utils::io::LineReader lines(text);
+
+                for (std::string_view line; lines.next(line); ) {
+                    line.remove_prefix(std::min(line.find_first_not_of(whitespace), line.size()));
 
                     // Continue if too small or comment
                     if (line.size() < 2 || line[0] == '#' || line[0] == ';') continue;
@@ -58,10 +60,10 @@ namespace utils::ini {
                         if (const auto val_delim = utils::string::contains(line, TDelimiters::values.delimiter);
                             val_delim)
                         {
-                            std::string val = line.substr(*val_delim + val_delim_size);
-                            utils::string::rtrim(val);
+                            std::string_view val = line.substr(*val_delim + val_delim_size);
+                            val.remove_suffix(val.size() - (val.find_last_not_of(whitespace) + 1));
                             this->settings_map[current_section]
-                                    .emplace(line.substr(0, *val_delim), val);
+                                    .emplace(std::string(line.substr(0, *val_delim)), std::string(val));
                         }
                     }
                 }
@@ -80,9 +82,9 @@ namespace utils::ini {
                 , filename(filename)
             {
                 try {
-                    auto contents = utils::io::file_to_string(this->filename);
-                    this->inifile << *contents;
-                    this->parse();
+                    // Parse the mapped file in place, lines are not copied
+                    const auto contents = utils::io::map_file(this->filename);
+                    this->parse(contents.str());
                 } CATCH_AND_LOG_ERROR_TRACE(read_from_file = false)
             }
 
@@ -90,8 +92,9 @@ namespace utils::ini {
                 : read_from_file(false)
                 , filename("")
             {
-                this->inifile << input.rdbuf();
-                this->parse();
+                std::stringstream inifile;
+                inifile << input.rdbuf();
+                this->parse(inifile.str());
             }
 
             ConfigReader(ConfigReader&&) = delete;
@@ -106,11 +109,11 @@ namespace utils::ini {
                 }
 
                 // MAP TO STRING
-                std::stringstream().swap(this->inifile);
-                this->inifile << *this;
+                std::stringstream inifile;
+                inifile << *this;
 
                 try {
-                    utils::io::string_to_file(name, this->inifile.str());
+                    utils::io::string_to_file(name, inifile.str());
                 } CATCH_AND_LOG_ERROR_TRACE()
             }
 
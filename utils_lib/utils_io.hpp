@@ -8,12 +8,32 @@
 #include "utils_memory.hpp"
 #include "utils_traits.hpp"
 #include "utils_random.hpp"
+#include "utils_threading.hpp"
 
+#include <algorithm>
+#include <atomic>
 #include <fstream>
+#include <functional>
 #include <vector>
 #include <chrono>
+#include <cerrno>
 #include <cstdio>
 
+#if defined(UTILS_OS_LINUX) || defined(UTILS_OS_MAC)
+    #include <fcntl.h>
+    #include <unistd.h>
+#endif
+
+#if defined(UTILS_OS_LINUX) || defined(UTILS_OS_MAC)
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+#endif
+
+#if defined(UTILS_OS_LINUX)
+    #include <dirent.h>
+    #include <sys/syscall.h>
+#endif
+
 // Ignore warnings
 HEDLEY_DIAGNOSTIC_PUSH
 #if HEDLEY_MSVC_VERSION_CHECK(15,0,0)
@@ -177,6 +197,291 @@ namespace utils::io {
 
             return most_recent;
         }
+
+        /**
+         *  Type of a directory entry found by scan_directory().
+         */
+        enum class EntryType : uint8_t {
+            Unknown,
+            File,
+            Directory,
+            Symlink,    ///< Symbolic links are reported, never followed
+            Other,      ///< Devices, sockets, pipes
+        };
+
+        /**
+         *  Directory entry passed to the scan_directory() callback,
+         *  the views are only valid during the call.
+         */
+        struct ScanEntry {
+            std::string_view path;  ///< Full path: the scanned folder joined with the relative path
+            std::string_view name;  ///< File name
+            EntryType        type;
+            uint64_t         inode;
+        };
+
+        namespace internal {
+            #if defined(UTILS_OS_LINUX)
+                /**
+                 *  Record layout returned by the getdents64 system call.
+                 */
+                struct linux_dirent64 {
+                    uint64_t        d_ino;
+                    int64_t         d_off;
+                    unsigned short  d_reclen;
+                    unsigned char   d_type;
+                    char            d_name[1];
+                };
+
+                ATTR_MAYBE_UNUSED ATTR_NODISCARD
+                static inline EntryType entry_type(int dir_fd, const char *name, unsigned char d_type) {
+                    switch (d_type) {
+                        case DT_REG:    return EntryType::File;
+                        case DT_DIR:    return EntryType::Directory;
+                        case DT_LNK:    return EntryType::Symlink;
+                        case DT_UNKNOWN: break;
+                        default:        return EntryType::Other;
+                    }
+
+                    // File systems without d_type support
+                    struct stat st;
+                    if (::fstatat(dir_fd, name, &st, AT_SYMLINK_NOFOLLOW) != 0) {
+                        return EntryType::Unknown;
+                    }
+
+                    return S_ISREG(st.st_mode) ? EntryType::File
+                         : S_ISDIR(st.st_mode) ? EntryType::Directory
+                         : S_ISLNK(st.st_mode) ? EntryType::Symlink
+                         :                       EntryType::Other;
+                }
+
+                /**
+                 *  Shared state of one parallel scan. Directories are read with getdents64
+                 *  and fanned out over the pool while it has few queued tasks, otherwise
+                 *  they are scanned depth first on the current thread through openat.
+                 */
+                template <class Callback>
+                class DirectoryScan {
+                    private:
+                        static constexpr size_t BUFFER_BYTES = 32 * 1024;
+
+                        Callback&                      callback;
+                        utils::threading::ThreadPool&  pool;
+
+                        std::mutex              mutex;
+                        std::condition_variable done;
+                        size_t                  outstanding = 0;
+                        std::exception_ptr      error;
+                        std::atomic<bool>       stop{false};
+
+                        /// Scan \p path on the pool, from \p fd if already opened (closed after the scan)
+                        void spawn(std::string path, int fd = -1) {
+                            {
+                                LOCK_BLOCK(this->mutex);
+                                this->outstanding++;
+                            }
+
+                            this->pool.enqueue([this, path = std::move(path), fd]() mutable {
+                                if (fd < 0) {
+                                    fd = ::open(path.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC | O_NOFOLLOW);
+                                }
+
+                                if (fd >= 0) {
+                                    this->scan(fd, path);
+                                    ::close(fd);
+                                }
+
+                                // Notify under the lock, the scan may be destroyed right after
+                                LOCK_BLOCK(this->mutex);
+                                if (--this->outstanding == 0) {
+                                    this->done.notify_all();
+                                }
+                            });
+                        }
+
+                        void scan(int fd, std::string& path) {
+                            auto buffer = std::make_unique<uint8_t[]>(BUFFER_BYTES);
+                            const size_t base = path.size();
+
+                            while (!this->stop.load(std::memory_order_relaxed)) {
+                                const long count = ::syscall(SYS_getdents64, fd, buffer.get(), BUFFER_BYTES);
+
+                                if (count <= 0) {
+                                    if (count < 0 && errno == EINTR) {
+                                        continue;
+                                    }
+                                    break;
+                                }
+
+                                // Stop on an exception of any callback, not only of this directory's
+                                for (long offset = 0; offset < count && !this->stop.load(std::memory_order_relaxed); ) {
+                                    const auto *entry = reinterpret_cast<const linux_dirent64*>(buffer.get() + offset);
+                                    offset += entry->d_reclen;
+
+                                    const char *name = entry->d_name;
+                                    if (name[0] == '.' && (name[1] == '\0' || (name[1] == '.' && name[2] == '\0'))) {
+                                        continue;
+                                    }
+
+                                    const EntryType type = entry_type(fd, name, entry->d_type);
+
+                                    path.resize(base);
+                                    if (base > 0 && path.back() != '/') {
+                                        path += '/';
+                                    }
+                                    path += name;
+
+                                    try {
+                                        this->callback(ScanEntry{ path, std::string_view(path).substr(path.size() - std::strlen(name)),
+                                                                  type, entry->d_ino });
+                                    } catch (...) {
+                                        LOCK_BLOCK(this->mutex);
+                                        if (!this->error) {
+                                            this->error = std::current_exception();
+                                        }
+                                        this->stop = true;
+                                        continue;
+                                    }
+
+                                    if (type != EntryType::Directory) {
+                                        continue;
+                                    }
+
+                                    if (this->pool.tasks_in_queue() < this->pool.size()) {
+                                        this->spawn(path);
+                                    } else {
+                                        const int child = ::openat(fd, name, O_RDONLY | O_DIRECTORY | O_CLOEXEC | O_NOFOLLOW);
+
+                                        if (child >= 0) {
+                                            this->scan(child, path);
+                                            ::close(child);
+                                        }
+                                    }
+                                }
+                            }
+
+                            path.resize(base);
+                        }
+
+                    public:
+                        DirectoryScan(Callback& cb, utils::threading::ThreadPool& p)
+                            : callback(cb), pool(p) {}
+
+                        void run(const std::string& root) {
+                            const int fd = ::open(root.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+
+                            if (HEDLEY_UNLIKELY(fd < 0)) {
+                                throw utils::exceptions::Exception("utils::io::scan_directory",
+                                                                   root + ": " + std::strerror(errno));
+                            }
+                            // The root itself may be a symbolic link
+                            this->spawn(root, fd);
+
+                            {
+                                LOCK_UNIQUE_BLOCK(this->mutex);
+                                this->done.wait(__lock, [this]() { return this->outstanding == 0; });
+                            }
+
+                            if (this->error) {
+                                std::rethrow_exception(this->error);
+                            }
+                        }
+                };
+            #endif
+        }
+
+        /**
+         *  \brief  Recursively scan \p folder, calling \p callback for every entry.
+         *          On Linux directories are read with getdents64 and the entry type
+         *          comes from d_type (no stat per entry); subdirectories are spread
+         *          over \p pool. Elsewhere this falls back to a sequential
+         *          fs::recursive_directory_iterator.
+         *          Unreadable subdirectories are skipped, symbolic links are not followed.
+         *
+         *  \param  folder
+         *      The folder to scan.
+         *  \param  callback
+         *      Called with a ScanEntry, concurrently from the pool threads (must be thread safe).
+         *      An exception stops the scan and is rethrown.
+         *  \param  pool
+         *      The pool to run on, must not be the pool of the calling thread.
+         *  \exception Exception
+         *      Throws Exception if \p folder could not be opened.
+         */
+        template <typename Callback>
+        ATTR_MAYBE_UNUSED
+        static void scan_directory(const std::string_view folder, Callback&& callback, utils::threading::ThreadPool& pool) {
+            static_assert(utils::traits::is_invocable_v<Callback, const ScanEntry&>,
+                          "utils::io::scan_directory: Callable function required.");
+
+            #if defined(UTILS_OS_LINUX)
+                internal::DirectoryScan<std::remove_reference_t<Callback>> scan(callback, pool);
+                scan.run(std::string(folder));
+            #else
+                UNUSED(pool);
+
+                const fs::path path{ folder.begin(), folder.end() };
+                std::error_code ec;
+
+                if (!fs::is_directory(path, ec)) {
+                    throw utils::exceptions::Exception("utils::io::scan_directory", std::string(folder) + ": not a directory");
+                }
+
+                for (auto it = fs::recursive_directory_iterator(path, fs::directory_options::skip_permission_denied, ec);
+                     it != fs::recursive_directory_iterator(); it.increment(ec))
+                {
+                    if (ec) {
+                        break;
+                    }
+
+                    const std::string full = it->path().string();
+                    const std::string name = it->path().filename().string();
+                    const fs::file_type ft = it->symlink_status().type();
+
+                    const EntryType type = ft == fs::file_type::regular   ? EntryType::File
+                                         : ft == fs::file_type::directory ? EntryType::Directory
+                                         : ft == fs::file_type::symlink   ? EntryType::Symlink
+                                         : ft == fs::file_type::unknown   ? EntryType::Unknown
+                                         :                                  EntryType::Other;
+
+                    callback(ScanEntry{ full, name, type, 0 });
+                }
+            #endif
+        }
+
+        /**
+         *  \brief  Recursively scan \p folder on a temporary pool of \p threads threads.
+         */
+        template <typename Callback>
+        ATTR_MAYBE_UNUSED
+        static void scan_directory(const std::string_view folder, Callback&& callback,
+                                   size_t threads = std::max(std::thread::hardware_concurrency(), 1u)) {
+            utils::threading::ThreadPool pool(threads);
+            utils::io::scan_directory(folder, std::forward<Callback>(callback), pool);
+        }
+
+        /**
+         *  \brief  Parallel variant of list_contents_recur() listing the paths of all
+         *          entries of the given \p types (any if empty), in no particular order.
+         */
+        ATTR_MAYBE_UNUSED ATTR_NODISCARD
+        static auto list_contents_parallel(const std::string_view folder,
+                                           std::initializer_list<EntryType> types = {},
+                                           size_t threads = std::max(std::thread::hardware_concurrency(), 1u))
+        {
+            auto contents = utils::memory::new_unique_var<std::vector<std::string>>();
+            const std::vector<EntryType> wanted(types);
+            std::mutex mutex;
+
+            utils::io::scan_directory(folder, [&](const ScanEntry& entry) {
+                if (wanted.empty() || std::find(wanted.begin(), wanted.end(), entry.type) != wanted.end()) {
+                    LOCK_BLOCK(mutex);
+                    contents->emplace_back(entry.path);
+                }
+            }, threads);
+
+            return contents;
+        }
     #endif  // UTILS_IO_FS_SUPPORTED
 
     ATTR_MAYBE_UNUSED
@@ -196,6 +501,245 @@ namespace utils::io {
     }
 
 #ifdef UTILS_IO_FS_SUPPORTED
+#if defined(UTILS_OS_LINUX) || defined(UTILS_OS_MAC)
+    /**
+     *  \brief  Growable scratch buffer in a shared file mapping.
+     *
+     *          Backed either by an anonymous memory file (memfd_create, living in RAM
+     *          and swap) or by a file on disk (see TemporaryFile::map), so large
+     *          buffers can overflow to disk while being used like memory.
+     *          The file descriptor can be passed to other processes (inherited over
+     *          fork or sent over a unix socket); ScratchBuffer(fd) maps it there and
+     *          both sides see the same bytes.
+     *          Pointers are invalidated by resize().
+     */
+    class ScratchBuffer {
+        private:
+            int      fd     = -1;
+            uint8_t *base   = nullptr;
+            size_t   length = 0;    ///< Size of the file
+            size_t   mapped = 0;    ///< Size of the mapping, may exceed the file
+
+            static inline size_t page_size(void) {
+                static const size_t size = size_t(::sysconf(_SC_PAGESIZE));
+                return size;
+            }
+
+            [[noreturn]] static void fail(const char *what) {
+                throw utils::exceptions::Exception("utils::io::ScratchBuffer",
+                                                   std::string(what) + ": " + std::strerror(errno));
+            }
+
+            /// Map at least \p bytes, moving the mapping if needed
+            void remap(size_t bytes) {
+                bytes = utils::memory::internal::round_up(std::max(bytes, size_t(1)), page_size());
+
+                if (bytes <= this->mapped) {
+                    return;
+                }
+
+                void *p;
+                #if defined(UTILS_OS_LINUX)
+                    p = this->base
+                      ? ::mremap(this->base, this->mapped, bytes, MREMAP_MAYMOVE)
+                      : ::mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, this->fd, 0);
+                #else
+                    p = ::mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, this->fd, 0);
+
+                    if (p != MAP_FAILED && this->base) {
+                        ::munmap(this->base, this->mapped);
+                    }
+                #endif
+
+                if (HEDLEY_UNLIKELY(p == MAP_FAILED)) {
+                    fail("mmap");
+                }
+
+                this->base   = static_cast<uint8_t*>(p);
+                this->mapped = bytes;
+            }
+
+            void release(void) {
+                if (this->base) {
+                    ::munmap(this->base, this->mapped);
+                }
+                if (this->fd >= 0) {
+                    ::close(this->fd);
+                }
+
+                this->fd     = -1;
+                this->base   = nullptr;
+                this->length = this->mapped = 0;
+            }
+
+        public:
+            ScratchBuffer() = default;
+
+            /**
+             *  \brief  Map the file behind \p file_descriptor (taking ownership), e.g. one
+             *          received from another process. Its current size becomes the size.
+             *
+             *  \exception Exception
+             *      Throws Exception if the descriptor can not be mapped.
+             */
+            explicit ScratchBuffer(int file_descriptor)
+                : fd(file_descriptor)
+            {
+                struct stat st;
+                if (HEDLEY_UNLIKELY(::fstat(this->fd, &st) != 0)) {
+                    const int error = errno;
+                    ::close(this->fd);
+                    errno = error;
+                    fail("fstat");
+                }
+
+                this->length = size_t(st.st_size);
+
+                if (this->length > 0) {
+                    this->remap(this->length);
+                }
+            }
+
+            ScratchBuffer(ScratchBuffer&& other) noexcept
+                : fd(std::exchange(other.fd, -1))
+                , base(std::exchange(other.base, nullptr))
+                , length(std::exchange(other.length, 0))
+                , mapped(std::exchange(other.mapped, 0))
+            {
+                // Empty
+            }
+
+            ScratchBuffer& operator=(ScratchBuffer&& other) noexcept {
+                if (this != &other) {
+                    this->release();
+                    this->fd     = std::exchange(other.fd, -1);
+                    this->base   = std::exchange(other.base, nullptr);
+                    this->length = std::exchange(other.length, 0);
+                    this->mapped = std::exchange(other.mapped, 0);
+                }
+                return *this;
+            }
+
+            ScratchBuffer(const ScratchBuffer&)            = delete;
+            ScratchBuffer& operator=(const ScratchBuffer&) = delete;
+
+            ~ScratchBuffer() {
+                this->release();
+            }
+
+            /**
+             *  \brief  Create a zeroed buffer of \p size bytes in an anonymous memory file.
+             *          Where memfd_create is unavailable an unlinked temporary file is used.
+             *
+             *  \param  size
+             *      Initial size in bytes.
+             *  \param  name
+             *      Name of the memory file, shown in /proc/<pid>/fd for debugging.
+             */
+            static ScratchBuffer anonymous(size_t size = 0, const std::string& name = "utils_scratch") {
+                int fd = -1;
+
+                #if defined(UTILS_OS_LINUX) && defined(MFD_CLOEXEC)
+                    fd = ::memfd_create(name.c_str(), MFD_CLOEXEC);
+                #else
+                    UNUSED(name);
+                #endif
+
+                if (fd < 0) {
+                    std::string path = (utils::io::fs::temp_directory_path() / "utils_scratch_XXXXXX").string();
+                    fd = ::mkstemp(path.data());
+
+                    if (fd >= 0) {
+                        ::unlink(path.c_str());
+                        ::fcntl(fd, F_SETFD, FD_CLOEXEC);
+                    }
+                }
+
+                if (HEDLEY_UNLIKELY(fd < 0)) {
+                    fail("memfd_create");
+                }
+
+                ScratchBuffer buffer(fd);
+                buffer.resize(size);
+                return buffer;
+            }
+
+            /**
+             *  \brief  Set the size to \p size bytes, new bytes are zero.
+             *          The mapping grows geometrically, so appending is amortized O(1).
+             */
+            void resize(size_t size) {
+                if (HEDLEY_UNLIKELY(::ftruncate(this->fd, off_t(size)) != 0)) {
+                    fail("ftruncate");
+                }
+
+                if (size > this->mapped) {
+                    this->remap(std::max(size, this->mapped + this->mapped / 2u));
+                }
+
+                this->length = size;
+            }
+
+            /**
+             *  \brief  Append \p n bytes at the end, growing the buffer.
+             */
+            void append(const void *src, size_t n) {
+                const size_t offset = this->length;
+                this->resize(offset + n);
+                std::memcpy(this->base + offset, src, n);
+            }
+
+            /**
+             *  \brief  Write dirty pages to the backing file (only useful for files on disk).
+             */
+            void sync(void) {
+                if (this->base && ::msync(this->base, this->mapped, MS_SYNC) != 0) {
+                    fail("msync");
+                }
+            }
+
+            /**
+             *  \brief  The file descriptor, owned by the buffer.
+             *          Use dup() to hand it to another process or ScratchBuffer.
+             */
+            inline int get_fd(void) const {
+                return this->fd;
+            }
+
+            inline uint8_t* data(void) {
+                return this->base;
+            }
+
+            inline const uint8_t* data(void) const {
+                return this->base;
+            }
+
+            inline size_t size(void) const {
+                return this->length;
+            }
+
+            inline bool empty(void) const {
+                return this->length == 0;
+            }
+
+            inline uint8_t* begin(void) {
+                return this->base;
+            }
+
+            inline uint8_t* end(void) {
+                return this->base + this->length;
+            }
+
+            inline uint8_t& operator[](size_t i) {
+                return this->base[i];
+            }
+
+            inline const uint8_t& operator[](size_t i) const {
+                return this->base[i];
+            }
+    };
+#endif
+
     class TemporaryFile {
         private:
             utils::io::fs::path name;
@@ -313,6 +857,34 @@ namespace utils::io {
                 return std::fread(buffer, sizeof(char), len, this->file);
             }
 
+        #if defined(UTILS_OS_LINUX) || defined(UTILS_OS_MAC)
+            /**
+             *  \brief  Map the file as a growable ScratchBuffer of at least \p size bytes.
+             *          The buffer stays valid after the TemporaryFile is removed.
+             *
+             *  \exception Exception
+             *      Throws Exception if the file is not opened or can not be mapped.
+             */
+            ScratchBuffer map(size_t size = 0) {
+                if (HEDLEY_UNLIKELY(this->file == nullptr)) {
+                    throw utils::exceptions::Exception("utils::io::TemporaryFile", "File not opened.");
+                }
+
+                std::fflush(this->file);
+                const int fd = ::dup(::fileno(this->file));
+
+                if (HEDLEY_UNLIKELY(fd < 0)) {
+                    throw utils::exceptions::Exception("utils::io::TemporaryFile", std::strerror(errno));
+                }
+
+                ScratchBuffer buffer(fd);
+                if (size > buffer.size()) {
+                    buffer.resize(size);
+                }
+                return buffer;
+            }
+        #endif
+
             template<typename ...Type>
             inline int printf(const std::string_view format, const Type& ...args) {
                 // WARNING Possible lack of null terminator in format
@@ -339,6 +911,7 @@ namespace utils::io {
      *		The (path and) name of the file to read.
      *
      *	\return	Returns a string pointer.
+     *          See map_file() to view large files without copying.
      *
      *	\exception	FileReadException
      *		Throws FileReadException if the file could not be read properly.
@@ -351,11 +924,12 @@ namespace utils::io {
         try {
             file.open(filename, std::fstream::in | std::fstream::ate);
 
-            str->reserve(size_t(file.tellg()));
+            str->resize(size_t(file.tellg()));
             file.seekg(0, std::ios::beg);
 
-            str->assign(std::istreambuf_iterator<char>(file),
-                        std::istreambuf_iterator<char>());
+            // Single bulk read, text mode may yield less characters than tellg()
+            file.read(str->data(), std::streamsize(str->size()));
+            str->resize(size_t(file.gcount()));
             file.close();
         } catch (...) {
             file.close();
@@ -393,6 +967,7 @@ namespace utils::io {
      *	\return	std::vector<char>*
      *			A vector with buffer->size() bytes containing a program in raw binary.
      *			Print with cast to (unsigned char) for proper viewing.
+     *          See map_file() to view large files without copying.
      *
      *	\exception	FileReadException
      *		Throws FileReadException if the file could not be read properly.
@@ -410,10 +985,9 @@ namespace utils::io {
 
         try {
             // Filepointer is already at end due to ::ate option, so tellg() gives filesize
-            v_buff->reserve(size_t(file.tellg()));
+            v_buff->resize(size_t(file.tellg()));
             file.seekg(0, std::ios::beg);
-            v_buff->assign(std::istreambuf_iterator<char>(file),
-                           std::istreambuf_iterator<char>());
+            file.read(reinterpret_cast<char*>(v_buff->data()), std::streamsize(v_buff->size()));
         } catch (...) {
             file.close();
             throw utils::exceptions::FileReadException(filename);
@@ -435,6 +1009,8 @@ namespace utils::io {
      *
      *	\exception	FileWriteException
      *		Throws FileWriteException if the file could not be written properly.
+     *
+     *	For many files, utils::io::aio::AsyncIO::write_file() (utils_aio.hpp) writes asynchronously.
      */
     ATTR_MAYBE_UNUSED
     static void bytes_to_file(const std::string& filename, const uint8_t* buffer, size_t length) {
@@ -450,8 +1026,253 @@ namespace utils::io {
         file.close();
     }
 
+    /**
+     *  Access pattern hint for memory mapped files (see madvise).
+     */
+    enum class AccessAdvice {
+        Normal,
+        Sequential,     ///< Read ahead aggressively
+        Random,         ///< No read ahead
+        WillNeed        ///< Start paging the whole file in now
+    };
+
+    /**
+     *  \brief  Read-only memory mapped view of a file.
+     *          Copies share the mapping, which is unmapped when the last copy is destroyed.
+     */
+    class MappedFile {
+        private:
+            std::shared_ptr<const mio::ummap_source> mapping;
+
+        public:
+            using value_type     = uint8_t;
+            using const_iterator = const uint8_t*;
+
+            MappedFile() = default;
+
+            /**
+             *  \brief  Map the given file.
+             *
+             *  \param  filename
+             *      The (path and) name of the file to map.
+             *  \param  advice
+             *      How the mapping will be accessed.
+             *
+             *  \exception  FileReadException
+             *      Throws FileReadException if the file could not be mapped.
+             */
+            explicit MappedFile(const std::string& filename, AccessAdvice advice = AccessAdvice::Sequential) {
+                #ifdef UTILS_IO_FS_SUPPORTED
+                    // Zero length mappings are invalid, an existing empty file is just empty
+                    if (utils::io::file_size(filename) == 0) {
+                        return;
+                    }
+                #endif
+
+                std::error_code error;
+                auto source = std::make_shared<mio::ummap_source>();
+                source->map(filename, error);
+
+                if (HEDLEY_UNLIKELY(error)) {
+                    throw utils::exceptions::FileReadException(filename);
+                }
+
+                #if defined(UTILS_OS_LINUX)
+                    if (advice != AccessAdvice::Normal) {
+                        static constexpr int advices[] = { MADV_NORMAL, MADV_SEQUENTIAL, MADV_RANDOM, MADV_WILLNEED };
+                        const uintptr_t start = uintptr_t(source->data()) & ~uintptr_t(utils::memory::PAGE_BYTES - 1);
+                        ::madvise(reinterpret_cast<void*>(start),
+                                  source->size() + (uintptr_t(source->data()) - start),
+                                  advices[size_t(advice)]);
+                    }
+                #else
+                    UNUSED(advice);
+                #endif
+
+                this->mapping = std::move(source);
+            }
+
+            inline const uint8_t* data() const {
+                return this->mapping ? this->mapping->data() : nullptr;
+            }
+
+            inline size_t size() const {
+                return this->mapping ? this->mapping->size() : 0;
+            }
+
+            inline bool empty() const {
+                return this->size() == 0;
+            }
+
+            inline const uint8_t* begin() const {
+                return this->data();
+            }
+
+            inline const uint8_t* end() const {
+                return this->data() + this->size();
+            }
+
+            inline uint8_t operator[](size_t idx) const {
+                return this->data()[idx];
+            }
+
+            /**
+             *  \brief  View the contents as characters.
+             */
+            inline std::string_view str() const {
+                return std::string_view(reinterpret_cast<const char*>(this->data()), this->size());
+            }
+    };
+
+    /**
+     *	\brief	Memory map the given file, without copying its contents.
+     *
+     *	\param	filename
+     *		The (path and) name of the file to map.
+     *	\param	advice
+     *		How the mapping will be accessed, sequential by default.
+     *
+     *	\return	A MappedFile viewing the file, valid as long as it (or a copy) lives.
+     *
+     *	\exception	FileReadException
+     *		Throws FileReadException if the file could not be mapped.
+     */
+    ATTR_MAYBE_UNUSED ATTR_NODISCARD
+    static inline MappedFile map_file(const std::string& filename, AccessAdvice advice = AccessAdvice::Sequential) {
+        return MappedFile(filename, advice);
+    }
+
     ////////////////////////////////////////////////////////////////////////////
 
+    /**
+     *  Bit order policies for BitStream readers and writers.
+     *  Multi-byte values (get64, read_array, ...) follow the same order:
+     *  big endian for msb_first, little endian for lsb_first.
+     */
+    namespace bit_order {
+        /**
+         *  Most significant bit of each byte first (the default).
+         */
+        struct msb_first {
+            static constexpr bool is_msb_first = true;
+
+            static inline uint64_t load(const uint8_t *p) {
+                return utils::bits::load_big_endian<uint64_t>(p);
+            }
+
+            static inline void store(uint8_t *p, uint64_t word) {
+                utils::bits::store_big_endian<uint64_t>(p, word);
+            }
+
+            /// Load n < 8 bytes, the rest reads as 0
+            static inline uint64_t load_partial(const uint8_t *p, size_t n) {
+                uint64_t word = 0;
+                for (size_t i = 0; i < 8u; i++) {
+                    word = (word << 8u) | (i < n ? p[i] : 0u);
+                }
+                return word;
+            }
+
+            /// Store the first n < 8 bytes of a word
+            static inline void store_partial(uint8_t *p, size_t n, uint64_t word) {
+                for (size_t i = 0; i < n; i++) {
+                    p[i] = uint8_t(word >> (56u - 8u * i));
+                }
+            }
+
+            /// The l bits starting \p offset bits into the word
+            static inline uint64_t extract(uint64_t word, uint_fast32_t offset, uint_fast32_t l) {
+                // Shift in two steps, so l == 0 does not shift by 64
+                return ((word << offset) >> 1u) >> (63u - l);
+            }
+
+            /// Replace the 0 < l bits starting \p offset bits into the word
+            static inline uint64_t merge(uint64_t word, uint_fast32_t offset, uint_fast32_t l, uint64_t value) {
+                const uint_fast32_t shift = 64u - offset - l;
+                const uint64_t mask = utils::bits::mask_lsb<uint64_t>(l) << shift;
+                return (word & ~mask) | ((value << shift) & mask);
+            }
+
+            /// Mask for the first \p bits bits of a byte
+            static inline uint8_t byte_mask(uint_fast32_t bits) {
+                return uint8_t(0xFF00u >> bits);
+            }
+
+            /// Number of 0 bits read before the first 1 in the l bit \p value (non-zero)
+            static inline uint_fast32_t leading_zeros(uint64_t value, uint_fast32_t l) {
+                return l - utils::bits::msb(value);
+            }
+
+            /// Byte i of a \p count byte value, in stream order
+            static inline uint8_t get_byte(uint64_t value, size_t i, size_t count) {
+                return uint8_t(value >> (8u * (count - 1u - i)));
+            }
+
+            /// Value of \p count bytes, in stream order
+            static inline uint64_t from_bytes(const uint8_t *p, size_t count) {
+                uint64_t value = 0;
+                for (size_t i = 0; i < count; i++) {
+                    value = (value << 8u) | p[i];
+                }
+                return value;
+            }
+        };
+
+        /**
+         *  Least significant bit of each byte first, as in DEFLATE and LZ4 frames.
+         */
+        struct lsb_first {
+            static constexpr bool is_msb_first = false;
+
+            static inline uint64_t load(const uint8_t *p) {
+                return utils::bits::load_little_endian<uint64_t>(p);
+            }
+
+            static inline void store(uint8_t *p, uint64_t word) {
+                utils::bits::store_little_endian<uint64_t>(p, word);
+            }
+
+            static inline uint64_t load_partial(const uint8_t *p, size_t n) {
+                uint64_t word = 0;
+                for (size_t i = 0; i < n; i++) {
+                    word |= uint64_t(p[i]) << (8u * i);
+                }
+                return word;
+            }
+
+            static inline void store_partial(uint8_t *p, size_t n, uint64_t word) {
+                for (size_t i = 0; i < n; i++) {
+                    p[i] = uint8_t(word >> (8u * i));
+                }
+            }
+
+            static inline uint64_t extract(uint64_t word, uint_fast32_t offset, uint_fast32_t l) {
+                return (word >> offset) & utils::bits::mask_lsb<uint64_t>(l);
+            }
+
+            static inline uint64_t merge(uint64_t word, uint_fast32_t offset, uint_fast32_t l, uint64_t value) {
+                const uint64_t mask = utils::bits::mask_lsb<uint64_t>(l) << offset;
+                return (word & ~mask) | ((value << offset) & mask);
+            }
+
+            static inline uint8_t byte_mask(uint_fast32_t bits) {
+                return uint8_t((1u << bits) - 1u);
+            }
+
+            static inline uint_fast32_t leading_zeros(uint64_t value, uint_fast32_t) {
+                return utils::bits::ffs(value) - 1u;
+            }
+
+            static inline uint8_t get_byte(uint64_t value, size_t i, size_t) {
+                return uint8_t(value >> (8u * i));
+            }
+
+            static inline uint64_t from_bytes(const uint8_t *p, size_t count) {
+                return load_partial(p, count);
+            }
+        };
+    }
+
     class BitStream {
         protected:
             uint8_t *buffer;
@@ -459,17 +1280,33 @@ namespace utils::io {
             size_t  position;    ///< Position in bits
             bool    managed;
 
-            static constexpr inline uint8_t bitmasks[] = { 255, 128, 192, 224, 240, 248, 252, 254 };
-
             UTILS_ADD_PADDING(uint8_t, 8)
 
+            /**
+             *  @brief  Load the 8 bytes starting at \p byte as a word in the given bit order.
+             *          Bytes beyond the end of the buffer read as 0.
+             */
+            template <class Order>
+            inline uint64_t load_word(size_t byte) const {
+                if (HEDLEY_LIKELY(byte + 8u <= this->size)) {
+                    return Order::load(this->buffer + byte);
+                }
+
+                return byte < this->size ? Order::load_partial(this->buffer + byte, this->size - byte) : 0u;
+            }
+
         public:
+            /**
+             * Maximum amount of bits peek/get_bits/put can handle in one call.
+             */
+            static constexpr uint_fast32_t MAX_WORD_BITS = 57u;
+
             BitStream(uint8_t *b = nullptr, size_t s = 0, size_t p = 0, bool m = false)
                 : buffer(b), size(s), position(p), managed(m) {}
 
             virtual ~BitStream(void) {
                 if (this->managed) {
-                    utils::memory::delete_array(this->buffer);
+                    utils::memory::delete_growable_array(this->buffer);
                 }
             }
 
@@ -493,6 +1330,10 @@ namespace utils::io {
                 return this->size * 8u;
             }
 
+            /**
+             *  @brief  Set whether the buffer is owned (and freed) by the stream.
+             *          Managed buffers must come from utils::memory::new_growable_array.
+             */
             inline void set_managed(bool m) {
                 this->managed = m;
             }
@@ -523,6 +1364,7 @@ namespace utils::io {
             /**
              *  @brief  Resize the internal buffer if needed.
              *          Default resize is by 50% increase.
+             *          Growth happens in place where possible, new bytes are zeroed.
              *  @param  new_size
              *      The new size for the buffer.
              *  @return Returns the size after resizing.
@@ -536,7 +1378,7 @@ namespace utils::io {
                         return this->get_size();
                     }
 
-                    utils::memory::realloc_array(this->buffer, this->size, new_size);
+                    utils::memory::realloc_growable_array(this->buffer, this->size, new_size);
                 }
 
                 return this->get_size();
@@ -545,16 +1387,24 @@ namespace utils::io {
 
     /**
      * Class which eases reading bitwise from a buffer.
+     *
+     * @tparam Order The bit order, bit_order::msb_first or bit_order::lsb_first.
      */
-    class BitStreamReader : public BitStream {
+    template <class Order = bit_order::msb_first>
+    class BasicBitStreamReader : public BitStream {
+        private:
+            MappedFile source;  ///< Keeps the mapping alive when reading from a file
+
         public:
+            using order_type = Order;
+
             /**
              * Create a bitstreamreader which reads from the provided buffer.
              *
              * @param [in] buffer The buffer from which bits will be read.
              * @param [in] size The size (expressed in bytes) of the buffer from which bits will be read.
              */
-            BitStreamReader(uint8_t *buffer, size_t size)
+            BasicBitStreamReader(uint8_t *buffer, size_t size)
                 : BitStream(buffer, size, 0, false)
             {
                 // Empty
@@ -566,7 +1416,7 @@ namespace utils::io {
                         utils::traits::is_iterator_v<Iterator>
                      && std::is_same_v<uint8_t, typename std::iterator_traits<Iterator>::value_type>>
             >
-            BitStreamReader(Iterator start, Iterator end)
+            BasicBitStreamReader(Iterator start, Iterator end)
                 : BitStream(nullptr, 0, 0, true)
             {
                 this->resize(size_t(std::distance(start, end)));
@@ -577,66 +1427,280 @@ namespace utils::io {
                 typename Container,
                 typename = typename std::enable_if_t<utils::traits::is_iterable_v<Container>>
             >
-            BitStreamReader(const Container& cont)
-                : BitStreamReader(std::begin(cont), std::end(cont))
+            BasicBitStreamReader(const Container& cont)
+                : BasicBitStreamReader(std::begin(cont), std::end(cont))
+            {
+                // Empty
+            }
+
+            /**
+             * Create a bitstreamreader which reads directly from a memory mapped file.
+             *
+             * @param [in] file The mapping to read from, kept alive by the reader.
+             */
+            explicit BasicBitStreamReader(MappedFile file)
+                : BitStream(const_cast<uint8_t*>(file.data()), file.size(), 0, false)
+                , source(std::move(file))
             {
                 // Empty
             }
 
-            ~BitStreamReader() {}
+            ~BasicBitStreamReader() {}
 
             /**
              * Read one bit from the bitstream.
              *
-             * @return The value of the bit.
+             * @return The value of the bit, 0 beyond the end of the buffer.
              */
-            uint8_t get_bit(void) {
-                const size_t current_start_byte = this->position / 8u;
+            inline uint8_t get_bit(void) {
+                return uint8_t(this->get_bits(1u));
+            }
 
-                if (HEDLEY_UNLIKELY(current_start_byte >= this->get_size())) {
-                    // Prevent reading byte outside of array (-> Valgrind flagged)
-                    return 0u;
-                }
+            /**
+             * Look at the next l bits without moving the position.
+             * Bits beyond the end of the buffer read as 0.
+             *
+             * @param [in] l number of bits to read, at most MAX_WORD_BITS
+             * @return The value of the bits read
+             */
+            inline uint64_t peek(uint_fast32_t l) const {
+                return Order::extract(this->template load_word<Order>(this->position / 8u), this->position % 8u, l);
+            }
+
+            /**
+             * Same as peek, without bounds checking.
+             * The buffer must hold 8 bytes from the current byte position on.
+             */
+            inline uint64_t peek_unchecked(uint_fast32_t l) const {
+                return Order::extract(Order::load(this->buffer + this->position / 8u), this->position % 8u, l);
+            }
 
-                const uint_fast32_t bits_taken = this->position % 8;
-                const uint8_t value = this->buffer[current_start_byte];
+            /**
+             * Move the position l bits forward.
+             */
+            inline void skip(size_t l) {
+                this->position += l;
+            }
 
-                this->position++;
+            /**
+             * Get l bits from the bitstream, up to MAX_WORD_BITS.
+             */
+            inline uint64_t get_bits(uint_fast32_t l) {
+                const uint64_t value = this->peek(l);
+                this->position += l;
+                return value;
+            }
 
-                return utils::bits::select_one<uint8_t>(value, 8 - bits_taken);
+            /**
+             * Same as get_bits, without bounds checking (see peek_unchecked).
+             */
+            inline uint64_t get_bits_unchecked(uint_fast32_t l) {
+                const uint64_t value = this->peek_unchecked(l);
+                this->position += l;
+                return value;
             }
 
             /**
              * Get l bits from the bitstream
              *
-             * @param [in] l number of bits to read
+             * @param [in] l number of bits to read, at most 32
              * @return The value of the bits read
              *
              * buffer: 0101 1100, position==0
              * get(4) returns value 5, position==4
              */
-            uint32_t get(uint_fast32_t l) {
-                uint32_t value = 0;
+            inline uint32_t get(uint_fast32_t l) {
+                return uint32_t(this->get_bits(l));
+            }
+
+            /**
+             * Get l bits from the bitstream, up to 64.
+             */
+            inline uint64_t get64(uint_fast32_t l = 64u) {
+                if (HEDLEY_LIKELY(l <= BitStream::MAX_WORD_BITS)) {
+                    return this->get_bits(l);
+                }
+
+                if constexpr (Order::is_msb_first) {
+                    const uint64_t high = this->get_bits(l - 32u);
+                    return (high << 32u) | this->get_bits(32u);
+                } else {
+                    const uint64_t low = this->get_bits(32u);
+                    return low | (this->get_bits(l - 32u) << 32u);
+                }
+            }
+
+            /**
+             * Read n bytes into dst. Uses memcpy when the position is byte aligned.
+             * Bytes beyond the end of the buffer read as 0.
+             */
+            void read_bytes(uint8_t *dst, size_t n) {
+                if (this->position % 8u == 0) {
+                    const size_t byte      = this->position / 8u;
+                    const size_t available = byte < this->size ? std::min(n, this->size - byte) : 0;
+
+                    std::memcpy(dst, this->buffer + byte, available);
+                    std::memset(dst + available, 0, n - available);
+                    this->position += n * 8u;
+                    return;
+                }
+
+                // Unaligned: 7 bytes per word
+                for (; n >= 7u; n -= 7u, dst += 7u) {
+                    const uint64_t word = this->get_bits(56u);
+                    for (size_t i = 0; i < 7u; i++) {
+                        dst[i] = Order::get_byte(word, i, 7u);
+                    }
+                }
 
-                while (l--) {
-                    value <<= 1;
-                    value |= this->get_bit() & 1;
+                while (n--) {
+                    *dst++ = uint8_t(this->get_bits(8u));
                 }
+            }
+
+            /**
+             * Read n arithmetic values (big endian for msb_first, little endian for lsb_first).
+             * Copies straight from the buffer when byte aligned.
+             */
+            template <class T>
+            void read_array(T *dst, size_t n) {
+                static_assert(std::is_arithmetic_v<T>, "utils::io::BitStreamReader::read_array: Arithmetic type required.");
+                using uT = utils::bits::uint_of_size_t<sizeof(T)>;
+
+                if (this->position % 8u == 0) {
+                    this->read_bytes(reinterpret_cast<uint8_t*>(dst), n * sizeof(T));
+
+                    if constexpr (sizeof(T) > 1 && Order::is_msb_first != utils::bits::is_big_endian) {
+                        for (size_t i = 0; i < n; i++) {
+                            dst[i] = utils::memory::bit_cast<T>(utils::bits::byteswap(utils::memory::bit_cast<uT>(dst[i])));
+                        }
+                    }
+                    return;
+                }
+
+                for (size_t i = 0; i < n; i++) {
+                    dst[i] = utils::memory::bit_cast<T>(uT(this->get64(8u * sizeof(T))));
+                }
+            }
 
+            /**
+             * Read one arithmetic value, see read_array.
+             */
+            template <class T>
+            inline T read(void) {
+                T value;
+                this->read_array(&value, 1);
                 return value;
             }
 
             /**
-             * @brief from_file
-             * @param filename
-             * @return
+             * Read an unsigned Exp-Golomb code of order k: a prefix of z zero bits and a 1,
+             * followed by z + k bits (ue(v) in H.264 for k == 0 and msb_first).
+             *
+             * @exception Exception
+             *      Throws Exception if the prefix is longer than 64 bits.
+             */
+            uint64_t get_exp_golomb(uint_fast32_t k = 0) {
+                uint_fast32_t zeros = 0;
+
+                for (;;) {
+                    const uint64_t bits = this->peek(32u);
+
+                    if (HEDLEY_LIKELY(bits != 0)) {
+                        const uint_fast32_t run = Order::leading_zeros(bits, 32u);
+                        zeros += run;
+                        this->skip(run + 1u);
+                        break;
+                    }
+
+                    zeros += 32u;
+                    this->skip(32u);
+
+                    if (HEDLEY_UNLIKELY(zeros >= 64u)) {
+                        throw utils::exceptions::Exception("utils::io::BitStreamReader", "Invalid Exp-Golomb code.");
+                    }
+                }
+
+                const uint_fast32_t bits = zeros + k;
+
+                if (HEDLEY_UNLIKELY(bits >= 64u)) {
+                    throw utils::exceptions::Exception("utils::io::BitStreamReader", "Invalid Exp-Golomb code.");
+                }
+
+                return ((uint64_t(1) << bits) | this->get64(bits)) - (uint64_t(1) << k);
+            }
+
+            /**
+             * Read a signed Exp-Golomb code (se(v) in H.264: 0, 1, -1, 2, -2, ...).
+             */
+            inline int64_t get_signed_exp_golomb(void) {
+                const uint64_t value = this->get_exp_golomb();
+                return (value & 1u) ? int64_t((value + 1u) / 2u) : -int64_t(value / 2u);
+            }
+
+            /**
+             * Read an unsigned LEB128 varint (7 bits per byte, low groups first).
+             *
+             * @exception Exception
+             *      Throws Exception if the value does not fit in 64 bits.
+             */
+            uint64_t get_leb128(void) {
+                uint64_t value = 0;
+
+                for (uint_fast32_t shift = 0; shift < 64u; shift += 7u) {
+                    const uint64_t byte = this->get_bits(8u);
+                    value |= (byte & 0x7Fu) << shift;
+
+                    if (!(byte & 0x80u)) {
+                        return value;
+                    }
+                }
+
+                throw utils::exceptions::Exception("utils::io::BitStreamReader", "LEB128 value too long.");
+            }
+
+            /**
+             * Read a signed (two's complement) LEB128 varint.
+             *
+             * @exception Exception
+             *      Throws Exception if the value does not fit in 64 bits.
+             */
+            int64_t get_sleb128(void) {
+                uint64_t value = 0;
+
+                for (uint_fast32_t shift = 0; shift < 64u; ) {
+                    const uint64_t byte = this->get_bits(8u);
+                    value |= (byte & 0x7Fu) << shift;
+                    shift += 7u;
+
+                    if (!(byte & 0x80u)) {
+                        if (shift < 64u && (byte & 0x40u)) {
+                            value |= ~uint64_t(0) << shift;
+                        }
+                        return int64_t(value);
+                    }
+                }
+
+                throw utils::exceptions::Exception("utils::io::BitStreamReader", "LEB128 value too long.");
+            }
+
+            /**
+             * Read a zigzag encoded signed LEB128 varint (as in protobuf sint64).
+             */
+            inline int64_t get_zigzag_varint(void) {
+                return utils::bits::zigzag_decode(this->get_leb128());
+            }
+
+            /**
+             * @brief  Create a reader over the memory mapped contents of a file (no copy).
+             * @param  filename
+             * @return A unique_t to the reader.
              */
             static auto from_file(const std::string& filename) {
-                utils::memory::unique_t<BitStreamReader> reader;
+                utils::memory::unique_t<BasicBitStreamReader> reader;
 
                 try {
-                    auto invec = utils::io::file_to_bytes(filename);
-                    reader.reset(utils::memory::new_var<BitStreamReader>(*invec));
+                    reader.reset(utils::memory::new_var<BasicBitStreamReader>(utils::io::map_file(filename)));
                 } catch (utils::exceptions::FileReadException const& e) {
                     reader.reset(nullptr);
                     throw e;
@@ -648,16 +1712,21 @@ namespace utils::io {
 
     /**
      * Class which eases writing bitwise into a buffer.
+     *
+     * @tparam Order The bit order, bit_order::msb_first or bit_order::lsb_first.
      */
-    class BitStreamWriter : public BitStream {
+    template <class Order = bit_order::msb_first>
+    class BasicBitStreamWriter : public BitStream {
         public:
+            using order_type = Order;
+
             /**
              * Create a bitstreamwriter which writes into the provided buffer.
              *
              * @param [in] buffer The buffer into which bits will be written.
              * @param [in] size The size (expressed in bytes) of the buffer into which bits will be written.
              */
-            BitStreamWriter(uint8_t *buffer, size_t size)
+            BasicBitStreamWriter(uint8_t *buffer, size_t size)
                 : BitStream(buffer, size, 0, false)
             {
                 // Empty
@@ -668,50 +1737,232 @@ namespace utils::io {
              *
              * @param [in] size The size (expressed in bytes) of the buffer into which bits will be written.
              */
-            BitStreamWriter(size_t s)
-                : BitStream(utils::memory::new_array<uint8_t>(s), s, 0, true)
+            BasicBitStreamWriter(size_t s)
+                : BitStream(utils::memory::new_growable_array<uint8_t>(s), s, 0, true)
             {
                 // Empty
             }
 
-            ~BitStreamWriter() {}
+            ~BasicBitStreamWriter() {}
+
+            /**
+             * Make sure 'bits' more bits fit in the buffer, growing managed buffers.
+             *
+             * @exception Exception
+             *      Throws Exception if an unmanaged buffer is too small.
+             */
+            inline void reserve_bits(size_t bits) {
+                const size_t needed = utils::bits::round_to_byte(this->position + bits);
+
+                if (HEDLEY_UNLIKELY(needed > this->size)) {
+                    if (!this->managed) {
+                        throw utils::exceptions::Exception("utils::io::BitStreamWriter",
+                                                           "Write past the end of the buffer.");
+                    }
+
+                    this->resize(std::max(needed, this->size + this->size / 2u));
+                }
+            }
 
             /**
              * Write one bit into the bitstream.
              * @param [in] value The value to put into the bitstream.
              */
-            void put_bit(uint8_t value) {
-                const size_t current_start_byte = this->position / 8u;
-                const uint_fast32_t bits_taken  = this->position % 8;
-
-                utils::bits::set_one(this->buffer[current_start_byte],
-                                     value,
-                                     8 - bits_taken);
-                this->position++;
+            inline void put_bit(uint8_t value) {
+                this->put(1u, value & 1u);
             }
 
             /**
              * Put 'length' bits with value 'value' into the bitstream
              *
-             * @param [in] length Number of bits to use for storing the value
+             * @param [in] length Number of bits to use for storing the value, at most MAX_WORD_BITS
              * @param [in] value The value to store
              *
              * buffer: xxxx xxxx, position==0
              * put(4, 5)
-             * buffer: 1010 xxxx, position==4
+             * buffer: 1010 xxxx, position==4 (msb_first)
+             */
+            inline void put(uint_fast32_t length, uint64_t value) {
+                if (HEDLEY_UNLIKELY(length == 0)) {
+                    return;
+                }
+
+                const size_t byte = this->position / 8u;
+
+                if (HEDLEY_LIKELY(byte + 8u <= this->size)) {
+                    this->put_unchecked(length, value);
+                    return;
+                }
+
+                // Near the end of the buffer: merge into a zero padded word, store the bytes in range
+                this->reserve_bits(length);
+
+                if (byte + 8u <= this->size) {
+                    this->put_unchecked(length, value);
+                    return;
+                }
+
+                const uint64_t word = Order::merge(this->template load_word<Order>(byte),
+                                                   this->position % 8u, length, value);
+                Order::store_partial(this->buffer + byte, this->size - byte, word);
+                this->position += length;
+            }
+
+            /**
+             * Same as put, without bounds checking or growing.
+             * The buffer must hold 8 bytes from the current byte position on,
+             * and 0 < length <= MAX_WORD_BITS.
+             */
+            inline void put_unchecked(uint_fast32_t length, uint64_t value) {
+                uint8_t *p = this->buffer + this->position / 8u;
+                Order::store(p, Order::merge(Order::load(p), this->position % 8u, length, value));
+                this->position += length;
+            }
+
+            /**
+             * Put up to 64 bits into the bitstream.
+             */
+            inline void put64(uint_fast32_t length, uint64_t value) {
+                if (HEDLEY_LIKELY(length <= BitStream::MAX_WORD_BITS)) {
+                    this->put(length, value);
+                } else if constexpr (Order::is_msb_first) {
+                    this->put(length - 32u, value >> 32u);
+                    this->put(32u, value);
+                } else {
+                    this->put(32u, value);
+                    this->put(length - 32u, value >> 32u);
+                }
+            }
+
+            /**
+             * Write n bytes from src. Uses memcpy when the position is byte aligned.
+             */
+            void write_bytes(const uint8_t *src, size_t n) {
+                this->reserve_bits(n * 8u);
+
+                if (this->position % 8u == 0) {
+                    std::memcpy(this->buffer + this->position / 8u, src, n);
+                    this->position += n * 8u;
+                    return;
+                }
+
+                // Unaligned: 7 bytes per word
+                for (; n >= 7u; n -= 7u, src += 7u) {
+                    this->put(56u, Order::from_bytes(src, 7u));
+                }
+
+                while (n--) {
+                    this->put(8u, *src++);
+                }
+            }
+
+            /**
+             * Write n arithmetic values (big endian for msb_first, little endian for lsb_first).
+             * Copies straight into the buffer when byte aligned.
+             */
+            template <class T>
+            void write_array(const T *src, size_t n) {
+                static_assert(std::is_arithmetic_v<T>, "utils::io::BitStreamWriter::write_array: Arithmetic type required.");
+                using uT = utils::bits::uint_of_size_t<sizeof(T)>;
+
+                if constexpr (sizeof(T) == 1 || Order::is_msb_first == utils::bits::is_big_endian) {
+                    if (this->position % 8u == 0) {
+                        this->write_bytes(reinterpret_cast<const uint8_t*>(src), n * sizeof(T));
+                        return;
+                    }
+                }
+
+                this->reserve_bits(n * 8u * sizeof(T));
+
+                for (size_t i = 0; i < n; i++) {
+                    this->put64(8u * sizeof(T), utils::memory::bit_cast<uT>(src[i]));
+                }
+            }
+
+            /**
+             * Write one arithmetic value, see write_array.
+             */
+            template <class T>
+            inline void write(const T value) {
+                this->write_array(&value, 1);
+            }
+
+            /**
+             * Write an unsigned Exp-Golomb code of order k, see BitStreamReader::get_exp_golomb.
+             */
+            void put_exp_golomb(uint64_t value, uint_fast32_t k = 0) {
+                const uint64_t offset = uint64_t(1) << k;
+
+                if (HEDLEY_UNLIKELY(value > ~uint64_t(0) - offset)) {
+                    throw utils::exceptions::Exception("utils::io::BitStreamWriter", "Value too large for Exp-Golomb.");
+                }
+
+                const uint64_t word = value + offset;
+                const uint_fast32_t bits  = utils::bits::msb(word) - 1u;     // Bits after the leading 1
+                const uint_fast32_t zeros = bits - k;
+
+                this->put64(zeros, 0u);
+                this->put_bit(1u);
+                this->put64(bits, word);
+            }
+
+            /**
+             * Write a signed Exp-Golomb code (se(v) in H.264).
+             *
+             * @exception Exception
+             *      Throws Exception for INT64_MIN, its code number does not fit in 64 bits.
+             */
+            inline void put_signed_exp_golomb(int64_t value) {
+                if (HEDLEY_UNLIKELY(value == INT64_MIN)) {
+                    throw utils::exceptions::Exception("utils::io::BitStreamWriter", "Value too large for Exp-Golomb.");
+                }
+
+                this->put_exp_golomb(value > 0 ? 2u * uint64_t(value) - 1u : 2u * (0u - uint64_t(value)));
+            }
+
+            /**
+             * Write an unsigned LEB128 varint.
+             */
+            void put_leb128(uint64_t value) {
+                while (value >= 0x80u) {
+                    this->put(8u, (value & 0x7Fu) | 0x80u);
+                    value >>= 7u;
+                }
+                this->put(8u, value);
+            }
+
+            /**
+             * Write a signed (two's complement) LEB128 varint.
              */
-            void put(uint_fast32_t length, uint_fast32_t value) {
-                while (length) {
-                    this->put_bit(uint8_t(utils::bits::select_one(value, length--)));
+            void put_sleb128(int64_t value) {
+                for (;;) {
+                    const uint64_t byte = uint64_t(value) & 0x7Fu;
+                    value >>= 7;
+
+                    if ((value == 0 && !(byte & 0x40u)) || (value == -1 && (byte & 0x40u))) {
+                        this->put(8u, byte);
+                        return;
+                    }
+
+                    this->put(8u, byte | 0x80u);
                 }
             }
 
+            /**
+             * Write a zigzag encoded signed LEB128 varint.
+             */
+            inline void put_zigzag_varint(int64_t value) {
+                this->put_leb128(utils::bits::zigzag_encode(value));
+            }
+
             /**
              * Byte-align: Move the bitwise position pointer to the next byte boundary
              */
             void flush(void) {
                 // Only keep written bits in current byte, make rest 0
-                this->buffer[this->position / 8] &= BitStream::bitmasks[this->position % 8];
+                if (this->position % 8u) {
+                    this->buffer[this->position / 8u] &= Order::byte_mask(this->position % 8u);
+                }
 
                 BitStream::flush();
             }
@@ -722,6 +1973,878 @@ namespace utils::io {
                                          this->get_last_byte_position());
             }
     };
+
+    using BitStreamReader    = BasicBitStreamReader<bit_order::msb_first>;
+    using BitStreamWriter    = BasicBitStreamWriter<bit_order::msb_first>;
+    using LsbBitStreamReader = BasicBitStreamReader<bit_order::lsb_first>;
+    using LsbBitStreamWriter = BasicBitStreamWriter<bit_order::lsb_first>;
+
+    ////////////////////////////////////////////////////////////////////////////
+    ///  Streaming bitstreams
+    ////////////////////////////////////////////////////////////////////////////
+
+    /**
+     * Pull based byte source for StreamBitReader.
+     */
+    class ByteSource {
+        public:
+            virtual ~ByteSource() = default;
+
+            /**
+             * Read up to n bytes into dst.
+             * @return The amount of bytes read, 0 at the end of the input.
+             */
+            virtual size_t read(uint8_t *dst, size_t n) = 0;
+    };
+
+    /**
+     * Push based byte sink for StreamBitWriter.
+     */
+    class ByteSink {
+        public:
+            virtual ~ByteSink() = default;
+
+            /**
+             * Write all n bytes from src.
+             */
+            virtual void write(const uint8_t *src, size_t n) = 0;
+
+            virtual void flush() {}
+    };
+
+    /**
+     * Reads from a std::istream (not owned).
+     */
+    class IStreamSource : public ByteSource {
+        private:
+            std::istream &stream;
+
+        public:
+            explicit IStreamSource(std::istream &s) : stream(s) {}
+
+            size_t read(uint8_t *dst, size_t n) override {
+                this->stream.read(reinterpret_cast<char*>(dst), std::streamsize(n));
+                return size_t(this->stream.gcount());
+            }
+    };
+
+    /**
+     * Writes to a std::ostream (not owned).
+     */
+    class OStreamSink : public ByteSink {
+        private:
+            std::ostream &stream;
+
+        public:
+            explicit OStreamSink(std::ostream &s) : stream(s) {}
+
+            void write(const uint8_t *src, size_t n) override {
+                if (HEDLEY_UNLIKELY(!this->stream.write(reinterpret_cast<const char*>(src), std::streamsize(n)))) {
+                    throw utils::exceptions::Exception("utils::io::OStreamSink", "Write failed.");
+                }
+            }
+
+            void flush() override {
+                this->stream.flush();
+            }
+    };
+
+    /**
+     * Reads a chain of chunks, each requested from a callback when the previous one is used up.
+     * The callback returns an empty chunk at the end of the input.
+     * Chunks must stay valid until the next call.
+     */
+    class ChunkSource : public ByteSource {
+        public:
+            using chunk_t    = std::pair<const uint8_t*, size_t>;
+            using callback_t = std::function<chunk_t(void)>;
+
+        private:
+            callback_t next_chunk;
+            chunk_t    current{ nullptr, 0 };
+            size_t     offset = 0;
+            bool       done   = false;
+
+        public:
+            explicit ChunkSource(callback_t callback) : next_chunk(std::move(callback)) {}
+
+            size_t read(uint8_t *dst, size_t n) override {
+                size_t total = 0;
+
+                while (total < n && !this->done) {
+                    if (this->offset == this->current.second) {
+                        this->current = this->next_chunk();
+                        this->offset  = 0;
+                        this->done    = this->current.second == 0;
+                        continue;
+                    }
+
+                    const size_t count = std::min(n - total, this->current.second - this->offset);
+                    std::memcpy(dst + total, this->current.first + this->offset, count);
+                    this->offset += count;
+                    total        += count;
+                }
+
+                return total;
+            }
+    };
+
+    /**
+     * Cuts the output into chunks of a fixed size, handed to a callback when full.
+     * The last chunk may be smaller and is handed over on flush.
+     */
+    class ChunkSink : public ByteSink {
+        public:
+            using callback_t = std::function<void(const uint8_t*, size_t)>;
+
+        private:
+            callback_t           on_chunk;
+            std::vector<uint8_t> chunk;
+            size_t               chunk_size;
+
+        public:
+            ChunkSink(size_t chunk_bytes, callback_t callback)
+                : on_chunk(std::move(callback)), chunk_size(std::max(chunk_bytes, size_t(1)))
+            {
+                this->chunk.reserve(this->chunk_size);
+            }
+
+            void write(const uint8_t *src, size_t n) override {
+                while (n > 0) {
+                    const size_t count = std::min(n, this->chunk_size - this->chunk.size());
+                    this->chunk.insert(this->chunk.end(), src, src + count);
+                    src += count;
+                    n   -= count;
+
+                    if (this->chunk.size() == this->chunk_size) {
+                        this->on_chunk(this->chunk.data(), this->chunk.size());
+                        this->chunk.clear();
+                    }
+                }
+            }
+
+            void flush() override {
+                if (!this->chunk.empty()) {
+                    this->on_chunk(this->chunk.data(), this->chunk.size());
+                    this->chunk.clear();
+                }
+            }
+    };
+
+#if defined(UTILS_OS_LINUX) || defined(UTILS_OS_MAC)
+    /**
+     * Reads from a POSIX file descriptor, optionally owning (closing) it.
+     */
+    class FileDescriptorSource : public ByteSource {
+        private:
+            int  fd;
+            bool owned;
+
+        public:
+            explicit FileDescriptorSource(int file_descriptor, bool owns = false)
+                : fd(file_descriptor), owned(owns) {}
+
+            FileDescriptorSource(const FileDescriptorSource&)            = delete;
+            FileDescriptorSource& operator=(const FileDescriptorSource&) = delete;
+
+            ~FileDescriptorSource() override {
+                if (this->owned) {
+                    ::close(this->fd);
+                }
+            }
+
+            /**
+             * @brief  Open the given file for reading.
+             * @exception FileReadException
+             *      Throws FileReadException if the file could not be opened.
+             */
+            static auto open(const std::string& filename) {
+                const int fd = ::open(filename.c_str(), O_RDONLY | O_CLOEXEC);
+
+                if (HEDLEY_UNLIKELY(fd < 0)) {
+                    throw utils::exceptions::FileReadException(filename);
+                }
+
+                #if defined(POSIX_FADV_SEQUENTIAL)
+                    ::posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+                #endif
+
+                return utils::memory::unique_t<FileDescriptorSource>(utils::memory::new_var<FileDescriptorSource>(fd, true));
+            }
+
+            size_t read(uint8_t *dst, size_t n) override {
+                for (;;) {
+                    const ssize_t count = ::read(this->fd, dst, n);
+
+                    if (HEDLEY_LIKELY(count >= 0)) {
+                        return size_t(count);
+                    } else if (errno != EINTR) {
+                        throw utils::exceptions::Exception("utils::io::FileDescriptorSource", std::strerror(errno));
+                    }
+                }
+            }
+    };
+
+    /**
+     * Writes to a POSIX file descriptor, optionally owning (closing) it.
+     */
+    class FileDescriptorSink : public ByteSink {
+        private:
+            int  fd;
+            bool owned;
+
+        public:
+            explicit FileDescriptorSink(int file_descriptor, bool owns = false)
+                : fd(file_descriptor), owned(owns) {}
+
+            FileDescriptorSink(const FileDescriptorSink&)            = delete;
+            FileDescriptorSink& operator=(const FileDescriptorSink&) = delete;
+
+            ~FileDescriptorSink() override {
+                if (this->owned) {
+                    ::close(this->fd);
+                }
+            }
+
+            /**
+             * @brief  Create (or truncate) the given file for writing.
+             * @exception FileWriteException
+             *      Throws FileWriteException if the file could not be opened.
+             */
+            static auto open(const std::string& filename) {
+                const int fd = ::open(filename.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+
+                if (HEDLEY_UNLIKELY(fd < 0)) {
+                    throw utils::exceptions::FileWriteException(filename);
+                }
+
+                return utils::memory::unique_t<FileDescriptorSink>(utils::memory::new_var<FileDescriptorSink>(fd, true));
+            }
+
+            void write(const uint8_t *src, size_t n) override {
+                while (n > 0) {
+                    const ssize_t count = ::write(this->fd, src, n);
+
+                    if (HEDLEY_LIKELY(count >= 0)) {
+                        src += size_t(count);
+                        n   -= size_t(count);
+                    } else if (errno != EINTR) {
+                        throw utils::exceptions::Exception("utils::io::FileDescriptorSink", std::strerror(errno));
+                    }
+                }
+            }
+    };
+#endif
+
+    /**
+     * Bitwise reader pulling from a ByteSource through a fixed size window,
+     * so inputs of any length are read in constant memory.
+     * Offers the BitStreamReader reading interface; positions are absolute.
+     */
+    template <class Order = bit_order::msb_first>
+    class BasicStreamBitReader : protected BasicBitStreamReader<Order> {
+        private:
+            using base_t = BasicBitStreamReader<Order>;
+
+        public:
+            static constexpr size_t DEFAULT_WINDOW = 64 * 1024;
+
+        private:
+            utils::memory::unique_t<ByteSource> source;
+            std::vector<uint8_t> window;
+            size_t  dropped   = 0;      ///< Bits dropped from the front of the window
+            bool    exhausted = false;
+
+            /**
+             * Make sure 'bits' bits are in the window, unless the source is exhausted.
+             */
+            void refill(size_t bits) {
+                if (HEDLEY_LIKELY(this->position + bits <= this->size * 8u) || this->exhausted) {
+                    return;
+                }
+
+                // Drop consumed bytes, keep the current partial byte
+                const size_t drop = std::min(this->position / 8u, this->size);
+                std::memmove(this->window.data(), this->window.data() + drop, this->size - drop);
+                this->size     -= drop;
+                this->position -= drop * 8u;
+                this->dropped  += drop * 8u;
+
+                while (this->size < this->window.size() && !this->exhausted) {
+                    const size_t count = this->source->read(this->window.data() + this->size,
+                                                            this->window.size() - this->size);
+                    this->size += count;
+                    this->exhausted = (count == 0);
+                }
+            }
+
+        public:
+            /**
+             * @param [in] src The source to read from, owned by the reader.
+             * @param [in] window_bytes Size of the read window (at least 32 bytes).
+             */
+            explicit BasicStreamBitReader(utils::memory::unique_t<ByteSource> src, size_t window_bytes = DEFAULT_WINDOW)
+                : base_t(nullptr, 0)
+                , source(std::move(src))
+                , window(std::max(window_bytes, size_t(32)))
+            {
+                this->buffer = this->window.data();
+            }
+
+            /**
+             * Read from a std::istream, which must outlive the reader.
+             */
+            explicit BasicStreamBitReader(std::istream& stream, size_t window_bytes = DEFAULT_WINDOW)
+                : BasicStreamBitReader(utils::memory::unique_t<IStreamSource>(utils::memory::new_var<IStreamSource>(stream)), window_bytes)
+            {
+                // Empty
+            }
+
+        #if defined(UTILS_OS_LINUX) || defined(UTILS_OS_MAC)
+            /**
+             * Stream the given file through the window.
+             */
+            static auto from_file(const std::string& filename, size_t window_bytes = DEFAULT_WINDOW) {
+                return utils::memory::unique_t<BasicStreamBitReader>(
+                    utils::memory::new_var<BasicStreamBitReader>(FileDescriptorSource::open(filename), window_bytes));
+            }
+        #endif
+
+            inline uint64_t peek(uint_fast32_t l) {
+                this->refill(l);
+                return base_t::peek(l);
+            }
+
+            inline uint64_t get_bits(uint_fast32_t l) {
+                this->refill(l);
+                return base_t::get_bits(l);
+            }
+
+            inline uint32_t get(uint_fast32_t l) {
+                return uint32_t(this->get_bits(l));
+            }
+
+            inline uint8_t get_bit(void) {
+                this->refill(1u);
+                return base_t::get_bit();
+            }
+
+            inline uint64_t get64(uint_fast32_t l = 64u) {
+                this->refill(l);
+                return base_t::get64(l);
+            }
+
+            /// At most 64 + 1 + 63 bits
+            inline uint64_t get_exp_golomb(uint_fast32_t k = 0) {
+                this->refill(128u);
+                return base_t::get_exp_golomb(k);
+            }
+
+            inline int64_t get_signed_exp_golomb(void) {
+                this->refill(128u);
+                return base_t::get_signed_exp_golomb();
+            }
+
+            /// At most 10 bytes
+            inline uint64_t get_leb128(void) {
+                this->refill(80u);
+                return base_t::get_leb128();
+            }
+
+            inline int64_t get_sleb128(void) {
+                this->refill(80u);
+                return base_t::get_sleb128();
+            }
+
+            inline int64_t get_zigzag_varint(void) {
+                return utils::bits::zigzag_decode(this->get_leb128());
+            }
+
+            void skip(size_t l) {
+                while (l > 0) {
+                    this->refill(1u);
+                    const size_t available = this->size * 8u > this->position ? this->size * 8u - this->position : 0;
+
+                    if (available == 0) {
+                        this->position += l;
+                        return;
+                    }
+
+                    const size_t count = std::min(l, available);
+                    this->position += count;
+                    l -= count;
+                }
+            }
+
+            void read_bytes(uint8_t *dst, size_t n) {
+                while (n > 0) {
+                    this->refill(n * 8u);
+                    const size_t available = this->size * 8u > this->position ? (this->size * 8u - this->position) / 8u : 0;
+                    const size_t count     = std::max(std::min(n, available), size_t(1));
+
+                    base_t::read_bytes(dst, count);
+                    dst += count;
+                    n   -= count;
+                }
+            }
+
+            /**
+             * Read up to n bytes into dst, fewer only at the end of the input.
+             * @return The amount of bytes read.
+             */
+            size_t read_some(uint8_t *dst, size_t n) {
+                size_t done = 0;
+
+                while (done < n) {
+                    this->refill((n - done) * 8u);
+                    const size_t available = this->size * 8u > this->position ? (this->size * 8u - this->position) / 8u : 0;
+
+                    if (available == 0) {
+                        break;
+                    }
+
+                    const size_t count = std::min(n - done, available);
+                    base_t::read_bytes(dst + done, count);
+                    done += count;
+                }
+
+                return done;
+            }
+
+            template <class T>
+            void read_array(T *dst, size_t n) {
+                static_assert(std::is_arithmetic_v<T>, "utils::io::StreamBitReader::read_array: Arithmetic type required.");
+                using uT = utils::bits::uint_of_size_t<sizeof(T)>;
+
+                if constexpr (sizeof(T) == 1 || Order::is_msb_first == utils::bits::is_big_endian) {
+                    if (this->position % 8u == 0) {
+                        this->read_bytes(reinterpret_cast<uint8_t*>(dst), n * sizeof(T));
+                        return;
+                    }
+                }
+
+                for (size_t i = 0; i < n; i++) {
+                    dst[i] = utils::memory::bit_cast<T>(uT(this->get64(8u * sizeof(T))));
+                }
+            }
+
+            template <class T>
+            inline T read(void) {
+                T value;
+                this->read_array(&value, 1);
+                return value;
+            }
+
+            /**
+             * Absolute position in bits since the start of the stream.
+             */
+            inline size_t get_position(void) const {
+                return this->dropped + this->position;
+            }
+
+            /**
+             * Whether all input was read.
+             */
+            inline bool eof(void) {
+                this->refill(1u);
+                return this->position >= this->size * 8u;
+            }
+
+            /**
+             * Move the position to the next byte boundary.
+             */
+            inline void align(void) {
+                this->BitStream::flush();
+            }
+    };
+
+    /**
+     * Bitwise writer pushing to a ByteSink through a fixed size window,
+     * so outputs of any length are written in constant memory.
+     * Offers the BitStreamWriter writing interface; positions are absolute.
+     * Remaining bits are written (zero padded) by finish() or the destructor.
+     */
+    template <class Order = bit_order::msb_first>
+    class BasicStreamBitWriter : protected BasicBitStreamWriter<Order> {
+        private:
+            using base_t = BasicBitStreamWriter<Order>;
+
+        public:
+            static constexpr size_t DEFAULT_WINDOW = 64 * 1024;
+
+        private:
+            utils::memory::unique_t<ByteSink> sink;
+            std::vector<uint8_t> window;
+            size_t  emitted  = 0;       ///< Bits handed to the sink
+            bool    finished = false;
+
+            /**
+             * Hand all complete bytes to the sink, keep the current partial byte.
+             */
+            void drain(void) {
+                const size_t full = this->position / 8u;
+
+                if (full > 0) {
+                    this->sink->write(this->window.data(), full);
+                    this->window[0] = this->window[full];
+
+                    this->position -= full * 8u;
+                    this->emitted  += full * 8u;
+                }
+            }
+
+            /**
+             * Make room for 'bits' bits in the window.
+             */
+            inline void reserve(size_t bits) {
+                if (HEDLEY_UNLIKELY(this->position + bits + 64u > this->size * 8u)) {
+                    this->drain();
+                }
+            }
+
+        public:
+            /**
+             * @param [in] dst The sink to write to, owned by the writer.
+             * @param [in] window_bytes Size of the write window (at least 64 bytes).
+             */
+            explicit BasicStreamBitWriter(utils::memory::unique_t<ByteSink> dst, size_t window_bytes = DEFAULT_WINDOW)
+                : base_t(nullptr, 0)
+                , sink(std::move(dst))
+                , window(std::max(window_bytes, size_t(64)))
+            {
+                this->buffer = this->window.data();
+                this->size   = this->window.size();
+            }
+
+            /**
+             * Write to a std::ostream, which must outlive the writer.
+             */
+            explicit BasicStreamBitWriter(std::ostream& stream, size_t window_bytes = DEFAULT_WINDOW)
+                : BasicStreamBitWriter(utils::memory::unique_t<OStreamSink>(utils::memory::new_var<OStreamSink>(stream)), window_bytes)
+            {
+                // Empty
+            }
+
+            BasicStreamBitWriter(const BasicStreamBitWriter&)            = delete;
+            BasicStreamBitWriter& operator=(const BasicStreamBitWriter&) = delete;
+
+            ~BasicStreamBitWriter() {
+                try {
+                    this->finish();
+                } catch (...) {
+                    // Destructors must not throw, call finish() to observe errors
+                }
+            }
+
+        #if defined(UTILS_OS_LINUX) || defined(UTILS_OS_MAC)
+            /**
+             * Stream into the given file, created or truncated.
+             */
+            static auto to_file(const std::string& filename, size_t window_bytes = DEFAULT_WINDOW) {
+                return utils::memory::unique_t<BasicStreamBitWriter>(
+                    utils::memory::new_var<BasicStreamBitWriter>(FileDescriptorSink::open(filename), window_bytes));
+            }
+        #endif
+
+            inline void put(uint_fast32_t length, uint64_t value) {
+                if (HEDLEY_UNLIKELY(length == 0)) {
+                    return;
+                }
+
+                this->reserve(length);
+                base_t::put_unchecked(length, value);
+            }
+
+            inline void put_bit(uint8_t value) {
+                this->put(1u, value & 1u);
+            }
+
+            inline void put64(uint_fast32_t length, uint64_t value) {
+                this->reserve(length);
+                base_t::put64(length, value);
+            }
+
+            inline void put_exp_golomb(uint64_t value, uint_fast32_t k = 0) {
+                this->reserve(128u);
+                base_t::put_exp_golomb(value, k);
+            }
+
+            inline void put_signed_exp_golomb(int64_t value) {
+                this->reserve(128u);
+                base_t::put_signed_exp_golomb(value);
+            }
+
+            inline void put_leb128(uint64_t value) {
+                this->reserve(80u);
+                base_t::put_leb128(value);
+            }
+
+            inline void put_sleb128(int64_t value) {
+                this->reserve(80u);
+                base_t::put_sleb128(value);
+            }
+
+            inline void put_zigzag_varint(int64_t value) {
+                this->put_leb128(utils::bits::zigzag_encode(value));
+            }
+
+            void write_bytes(const uint8_t *src, size_t n) {
+                if (this->position % 8u == 0 && n >= this->window.size() / 2u) {
+                    // Large aligned writes bypass the window
+                    this->drain();
+                    this->sink->write(src, n);
+                    this->emitted += n * 8u;
+                    return;
+                }
+
+                while (n > 0) {
+                    const size_t count = std::min(n, this->window.size() / 2u);
+                    this->reserve(count * 8u);
+                    base_t::write_bytes(src, count);
+                    src += count;
+                    n   -= count;
+                }
+            }
+
+            template <class T>
+            void write_array(const T *src, size_t n) {
+                static_assert(std::is_arithmetic_v<T>, "utils::io::StreamBitWriter::write_array: Arithmetic type required.");
+                using uT = utils::bits::uint_of_size_t<sizeof(T)>;
+
+                if constexpr (sizeof(T) == 1 || Order::is_msb_first == utils::bits::is_big_endian) {
+                    if (this->position % 8u == 0) {
+                        this->write_bytes(reinterpret_cast<const uint8_t*>(src), n * sizeof(T));
+                        return;
+                    }
+                }
+
+                for (size_t i = 0; i < n; i++) {
+                    this->put64(8u * sizeof(T), utils::memory::bit_cast<uT>(src[i]));
+                }
+            }
+
+            template <class T>
+            inline void write(const T value) {
+                this->write_array(&value, 1);
+            }
+
+            /**
+             * Byte-align: zero the rest of the current byte.
+             */
+            void flush(void) {
+                base_t::flush();
+            }
+
+            /**
+             * Absolute position in bits since the start of the stream.
+             */
+            inline size_t get_position(void) const {
+                return this->emitted + this->position;
+            }
+
+            /**
+             * Byte-align and hand everything to the sink. Further writes are not allowed.
+             */
+            void finish(void) {
+                if (this->finished) {
+                    return;
+                }
+
+                this->finished = true;
+                this->flush();
+                this->drain();
+                this->sink->flush();
+            }
+    };
+
+    using StreamBitReader    = BasicStreamBitReader<bit_order::msb_first>;
+    using StreamBitWriter    = BasicStreamBitWriter<bit_order::msb_first>;
+    using LsbStreamBitReader = BasicStreamBitReader<bit_order::lsb_first>;
+    using LsbStreamBitWriter = BasicStreamBitWriter<bit_order::lsb_first>;
+
+    ////////////////////////////////////////////////////////////////////////////
+    ///  Line reading
+    ////////////////////////////////////////////////////////////////////////////
+
+    /**
+     * Reads lines (terminated by LF or CRLF) without copying, from memory, a memory
+     * mapped file or a ByteSource through a large buffer. Newlines are found with
+     * std::memchr, which is vectorized by the C library.
+     *
+     * Lines are returned without their terminator. A last line without newline is
+     * returned too, an empty input has no lines.
+     * Returned views stay valid while the reader lives for memory and mapped input,
+     * and until the next call to next() for streamed input.
+     */
+    class LineReader {
+        public:
+            static constexpr size_t DEFAULT_BUFFER = 1024 * 1024;
+
+        private:
+            std::string_view text;          ///< Remaining text (memory input) or buffered bytes
+            MappedFile       mapping;
+
+            // Streamed input only
+            utils::memory::unique_t<ByteSource> source;
+            std::vector<char> buffer;
+            bool              exhausted = true;
+
+            size_t line_number = 0;
+
+            /**
+             * Keep the unread bytes, fill the rest of the buffer (growing it for long lines).
+             */
+            void refill(void) {
+                const size_t offset = size_t(this->text.data() - this->buffer.data());
+                const size_t keep   = this->text.size();
+
+                std::memmove(this->buffer.data(), this->buffer.data() + offset, keep);
+
+                if (keep == this->buffer.size()) {
+                    this->buffer.resize(this->buffer.size() * 2u);
+                }
+
+                size_t filled = keep;
+
+                while (filled < this->buffer.size()) {
+                    const size_t count = this->source->read(reinterpret_cast<uint8_t*>(this->buffer.data() + filled),
+                                                            this->buffer.size() - filled);
+                    if (count == 0) {
+                        this->exhausted = true;
+                        break;
+                    }
+                    filled += count;
+                }
+
+                this->text = std::string_view(this->buffer.data(), filled);
+            }
+
+        public:
+            /**
+             * Read lines from \p input, which must outlive the reader.
+             */
+            explicit LineReader(const std::string_view input)
+                : text(input)
+            {
+                // Empty
+            }
+
+            /**
+             * Read lines from a memory mapped file, kept alive by the reader.
+             */
+            explicit LineReader(MappedFile file)
+                : text(file.str())
+                , mapping(std::move(file))
+            {
+                // Empty
+            }
+
+            /**
+             * Read lines from \p src through a buffer of \p buffer_bytes, grown for longer lines.
+             */
+            explicit LineReader(utils::memory::unique_t<ByteSource> src, size_t buffer_bytes = DEFAULT_BUFFER)
+                : source(std::move(src))
+                , buffer(std::max(buffer_bytes, size_t(64)))
+                , exhausted(false)
+            {
+                this->text = std::string_view(this->buffer.data(), 0);
+            }
+
+            /**
+             * @brief  Read the lines of a memory mapped file.
+             * @exception FileReadException
+             *      Throws FileReadException if the file could not be mapped.
+             */
+            static LineReader from_file(const std::string& filename) {
+                return LineReader(utils::io::map_file(filename, AccessAdvice::Sequential));
+            }
+
+            /**
+             * Get the next line.
+             *
+             * @param [out] line The line, without LF or CRLF.
+             * @return false when there are no more lines.
+             */
+            bool next(std::string_view& line) {
+                const char *newline = static_cast<const char*>(std::memchr(this->text.data(), '\n', this->text.size()));
+
+                while (HEDLEY_UNLIKELY(newline == nullptr && !this->exhausted)) {
+                    const size_t searched = this->text.size();
+                    this->refill();
+                    newline = static_cast<const char*>(std::memchr(this->text.data() + searched, '\n',
+                                                                   this->text.size() - searched));
+                }
+
+                size_t length, consumed;
+
+                if (HEDLEY_LIKELY(newline != nullptr)) {
+                    length   = size_t(newline - this->text.data());
+                    consumed = length + 1u;
+                } else if (!this->text.empty()) {
+                    length = consumed = this->text.size();
+                } else {
+                    return false;
+                }
+
+                line = this->text.substr(0, length);
+                if (!line.empty() && line.back() == '\r') {
+                    line.remove_suffix(1);
+                }
+
+                this->text.remove_prefix(consumed);
+                this->line_number++;
+                return true;
+            }
+
+            /**
+             * Call \p callback with every remaining line.
+             */
+            template <class F>
+            void for_each(F&& callback) {
+                static_assert(utils::traits::is_invocable_v<F, std::string_view>,
+                              "utils::io::LineReader::for_each: Callable function required.");
+
+                for (std::string_view line; this->next(line); ) {
+                    callback(line);
+                }
+            }
+
+            /**
+             * Number of lines read so far.
+             */
+            inline size_t get_line_number(void) const {
+                return this->line_number;
+            }
+    };
+
+    /**
+     * @brief  Split \p text into about \p count chunks that each end after a newline
+     *         (except the last), for parallel line processing with LineReader.
+     *
+     * @param [in] text The text to split.
+     * @param [in] count The desired amount of chunks, less are returned for short texts.
+     * @return Views on \p text, in order and covering all of it.
+     */
+    ATTR_MAYBE_UNUSED ATTR_NODISCARD
+    static std::vector<std::string_view> split_line_chunks(const std::string_view text, size_t count) {
+        std::vector<std::string_view> chunks;
+        const size_t target = std::max(text.size() / std::max(count, size_t(1)), size_t(1));
+        size_t start = 0;
+
+        while (start < text.size()) {
+            size_t end = std::min(start + target, text.size());
+
+            if (end < text.size()) {
+                const void *newline = std::memchr(text.data() + end - 1, '\n', text.size() - end + 1);
+                end = newline ? size_t(static_cast<const char*>(newline) - text.data()) + 1u : text.size();
+            }
+
+            chunks.push_back(text.substr(start, end - start));
+            start = end;
+        }
+
+        return chunks;
+    }
 }
 
 #endif // UTILS_IO_HPP
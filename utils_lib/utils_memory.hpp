@@ -4,47 +4,327 @@
 #define UTILS_MEMORY_ALLOC_LOG 0
 #define UTILS_MEMORY_NEW_LOG   1
 
+#ifndef UTILS_MEMORY_SAMPLE_RATE
+    // Default call-site sample rate for Metrics (0 = disabled)
+    #define UTILS_MEMORY_SAMPLE_RATE 0
+#endif
+
 #include "utils_compiler.hpp"
+#include "utils_exceptions.hpp"
 #include "utils_traits.hpp"
+#include "utils_threading.hpp"
 
 #include <algorithm>
+#include <array>
+#include <atomic>
 #include <vector>
 #include <memory>
+#include <mutex>
 #include <cstring>
+#include <cstdlib>
+#include <cstddef>
+#include <cstdint>
+#include <new>
 
 #if UTILS_MEMORY_ALLOC_LOG
     #include <cstdio>
 #endif
 
+#if defined(UTILS_COMPILER_MSVC)
+    #include <intrin.h>
+#endif
+
+#if defined(UTILS_OS_LINUX)
+    #include <sys/mman.h>
+#endif
+
 namespace utils::memory {
-    struct Metrics_t {
-        size_t TotalAllocated = 0;
-        size_t TotalFreed = 0;
+    namespace internal {
+        static constexpr size_t  METRICS_SHARDS           = 32;         ///< Amount of counter shards threads are spread over
+        static constexpr size_t  METRICS_SIZE_CLASSES     = 32;         ///< Power of 2 size classes in the histogram
+        static constexpr int64_t METRICS_PEAK_GRANULARITY = 16 * 1024;  ///< Bytes a shard may drift before updating usage/peak
+        static constexpr size_t  METRICS_CALL_SITES       = 1024;       ///< Slots in the call-site table (power of 2)
+        static constexpr size_t  METRICS_CALL_SITE_PROBES = 16;         ///< Max probes before a sample is dropped
 
-        inline size_t CurrentUsage() {
-            return TotalAllocated - TotalFreed;
-        }
+        /**
+         *  \brief  Counters for a group of threads, on their own cache line.
+         */
+        struct alignas(64) MetricsShard {
+            std::atomic<size_t>  allocated{0};
+            std::atomic<size_t>  freed{0};
+            std::atomic<size_t>  alloc_count{0};
+            std::atomic<size_t>  free_count{0};
+            std::atomic<int64_t> pending{0};      ///< Usage change not yet added to the global usage
+            std::atomic<size_t>  sample_tick{0};
+            std::atomic<size_t>  size_classes[METRICS_SIZE_CLASSES]{};
+        };
 
-        template<typename TChar, typename TCharTraits>
-        friend auto& operator<<(std::basic_ostream<TChar, TCharTraits>& stream, Metrics_t m) {
-            stream << "Current memory usage: "
+        struct MetricsCallSite {
+            std::atomic<uintptr_t> address{0};
+            std::atomic<size_t>    count{0};
+            std::atomic<size_t>    bytes{0};
+        };
 
-            #if UTILS_MEMORY_NEW_LOG
-                << m.CurrentUsage() << " bytes";
+        /**
+         *  \brief  Return the histogram class for \p size: class i holds sizes in (2^(i-1), 2^i].
+         */
+        ATTR_MAYBE_UNUSED ATTR_NODISCARD
+        static inline size_t metrics_size_class(size_t size) noexcept {
+            if (size <= 1) {
+                return 0;
+            }
+
+            #ifdef UTILS_COMPILER_MSVC
+                size_t cls = 0;
+                while ((size_t(1) << cls) < size) ++cls;
             #else
-                << "unavailable, set UTILS_MEMORY_ALLOC_LOG macro first"
+                const size_t cls = size_t(64 - __builtin_clzll(uint64_t(size - 1)));
             #endif
 
-            return stream;
+            return std::min(cls, METRICS_SIZE_CLASSES - 1);
+        }
+
+        /**
+         *  \brief  Return the shard index for the calling thread.
+         *          Threads are assigned round-robin on first use.
+         */
+        ATTR_MAYBE_UNUSED ATTR_NODISCARD
+        static inline size_t metrics_shard_index(void) noexcept {
+            static std::atomic<size_t> next{0};
+            static thread_local const size_t idx = next.fetch_add(1, std::memory_order_relaxed) % METRICS_SHARDS;
+            return idx;
+        }
+    }
+
+    /**
+     *  \brief  Aggregated view of Metrics_t at a point in time.
+     */
+    struct MetricsSnapshot {
+        size_t TotalAllocated = 0;
+        size_t TotalFreed     = 0;
+        size_t AllocCount     = 0;
+        size_t FreeCount      = 0;
+        size_t Peak           = 0;
+        std::array<size_t, internal::METRICS_SIZE_CLASSES> SizeClasses{};
+
+        inline size_t CurrentUsage(void) const {
+            return this->TotalAllocated - this->TotalFreed;
         }
     };
 
-    static inline Metrics_t Metrics;
+    /**
+     *  \brief  Sampled allocation call site.
+     */
+    struct CallSite {
+        uintptr_t address;  ///< Return address of the allocation (resolve with e.g. addr2line)
+        size_t    count;    ///< Amount of sampled allocations
+        size_t    bytes;    ///< Total size of sampled allocations
+    };
+
+    /**
+     *  \brief  Thread-safe allocation metrics.
+     *
+     *          Counters are sharded over cache-line aligned slots, and each thread
+     *          updates the slot it was assigned with relaxed atomics. Reading
+     *          aggregates all shards, so reads are slower than updates.
+     *
+     *          Peak usage is tracked at a granularity of METRICS_PEAK_GRANULARITY
+     *          bytes per shard.
+     *
+     *          Call-site attribution is off by default; enable it with set_sample_rate(n)
+     *          to record the caller of every n-th allocation (per shard).
+     */
+    class Metrics_t {
+        private:
+            internal::MetricsShard shards[internal::METRICS_SHARDS];
+            internal::MetricsCallSite call_sites[internal::METRICS_CALL_SITES];
+
+            std::atomic<int64_t> usage{0};
+            std::atomic<int64_t> peak{0};
+            std::atomic<size_t>  sample_rate{UTILS_MEMORY_SAMPLE_RATE};
+
+            inline void flush(internal::MetricsShard& shard, int64_t delta) noexcept {
+                const int64_t pending = shard.pending.fetch_add(delta, std::memory_order_relaxed) + delta;
+
+                if (HEDLEY_UNLIKELY(pending >= internal::METRICS_PEAK_GRANULARITY
+                                 || pending <= -internal::METRICS_PEAK_GRANULARITY))
+                {
+                    const int64_t taken = shard.pending.exchange(0, std::memory_order_relaxed);
+                    const int64_t now   = this->usage.fetch_add(taken, std::memory_order_relaxed) + taken;
+                    int64_t prev = this->peak.load(std::memory_order_relaxed);
+
+                    while (now > prev && !this->peak.compare_exchange_weak(prev, now, std::memory_order_relaxed));
+                }
+            }
+
+            void record_call_site(uintptr_t address, size_t size) noexcept {
+                // Fibonacci hashing on the address
+                size_t slot = size_t((uint64_t(address) * 0x9E3779B97F4A7C15ull) >> 32) & (internal::METRICS_CALL_SITES - 1);
+
+                for (size_t probe = 0; probe < internal::METRICS_CALL_SITE_PROBES; ++probe) {
+                    internal::MetricsCallSite& site = this->call_sites[slot];
+                    uintptr_t current = site.address.load(std::memory_order_relaxed);
+
+                    if (current == 0
+                        && site.address.compare_exchange_strong(current, address, std::memory_order_relaxed))
+                    {
+                        current = address;
+                    }
+
+                    if (current == address) {
+                        site.count.fetch_add(1, std::memory_order_relaxed);
+                        site.bytes.fetch_add(size, std::memory_order_relaxed);
+                        return;
+                    }
+
+                    slot = (slot + 1) & (internal::METRICS_CALL_SITES - 1);
+                }
+            }
+
+        public:
+            constexpr Metrics_t() = default;
+
+            Metrics_t(const Metrics_t&)            = delete;
+            Metrics_t& operator=(const Metrics_t&) = delete;
+
+            /**
+             *  \brief  Register an allocation of \p size bytes.
+             *
+             *  \param  caller
+             *      The return address of the allocation, only used when sampling.
+             */
+            inline void on_alloc(size_t size, const void *caller = nullptr) noexcept {
+                internal::MetricsShard& shard = this->shards[internal::metrics_shard_index()];
+
+                shard.allocated.fetch_add(size, std::memory_order_relaxed);
+                shard.alloc_count.fetch_add(1, std::memory_order_relaxed);
+                shard.size_classes[internal::metrics_size_class(size)].fetch_add(1, std::memory_order_relaxed);
+
+                this->flush(shard, int64_t(size));
+
+                if (const size_t rate = this->sample_rate.load(std::memory_order_relaxed);
+                    HEDLEY_UNLIKELY(rate > 0))
+                {
+                    if (shard.sample_tick.fetch_add(1, std::memory_order_relaxed) % rate == 0) {
+                        this->record_call_site(reinterpret_cast<uintptr_t>(caller), size);
+                    }
+                }
+            }
+
+            /**
+             *  \brief  Register a deallocation of \p size bytes (0 if unknown).
+             */
+            inline void on_free(size_t size) noexcept {
+                internal::MetricsShard& shard = this->shards[internal::metrics_shard_index()];
+
+                shard.freed.fetch_add(size, std::memory_order_relaxed);
+                shard.free_count.fetch_add(1, std::memory_order_relaxed);
+
+                if (size > 0) {
+                    this->flush(shard, -int64_t(size));
+                }
+            }
+
+            /**
+             *  \brief  Record the caller of every \p rate-th allocation (per shard).
+             *          A rate of 0 disables sampling.
+             */
+            inline void set_sample_rate(size_t rate) noexcept {
+                this->sample_rate.store(rate, std::memory_order_relaxed);
+            }
+
+            /**
+             *  \brief  Aggregate all shards.
+             */
+            MetricsSnapshot snapshot(void) const noexcept {
+                MetricsSnapshot snap;
+
+                for (const auto& shard : this->shards) {
+                    snap.TotalAllocated += shard.allocated.load(std::memory_order_relaxed);
+                    snap.TotalFreed     += shard.freed.load(std::memory_order_relaxed);
+                    snap.AllocCount     += shard.alloc_count.load(std::memory_order_relaxed);
+                    snap.FreeCount      += shard.free_count.load(std::memory_order_relaxed);
+
+                    for (size_t i = 0; i < internal::METRICS_SIZE_CLASSES; ++i) {
+                        snap.SizeClasses[i] += shard.size_classes[i].load(std::memory_order_relaxed);
+                    }
+                }
+
+                snap.Peak = std::max(size_t(std::max(this->peak.load(std::memory_order_relaxed), int64_t(0))),
+                                     snap.TotalAllocated >= snap.TotalFreed ? snap.CurrentUsage() : 0);
+
+                return snap;
+            }
+
+            /**
+             *  \brief  Return the \p top sampled call sites, sorted by amount of allocations.
+             */
+            std::vector<CallSite> hot_spots(size_t top = 10) const {
+                std::vector<CallSite> sites;
+
+                for (const auto& site : this->call_sites) {
+                    if (const uintptr_t address = site.address.load(std::memory_order_relaxed)) {
+                        sites.push_back(CallSite{ address,
+                                                  site.count.load(std::memory_order_relaxed),
+                                                  site.bytes.load(std::memory_order_relaxed) });
+                    }
+                }
+
+                std::sort(sites.begin(), sites.end(), [](const CallSite& a, const CallSite& b) {
+                    return a.count > b.count;
+                });
+
+                if (sites.size() > top) {
+                    sites.resize(top);
+                }
+
+                return sites;
+            }
+
+            inline size_t TotalAllocated(void) const {
+                return this->snapshot().TotalAllocated;
+            }
+
+            inline size_t TotalFreed(void) const {
+                return this->snapshot().TotalFreed;
+            }
+
+            inline size_t CurrentUsage(void) const {
+                return this->snapshot().CurrentUsage();
+            }
+
+            inline size_t Peak(void) const {
+                return this->snapshot().Peak;
+            }
+
+            template<typename TChar, typename TCharTraits>
+            friend auto& operator<<(std::basic_ostream<TChar, TCharTraits>& stream, const Metrics_t& m) {
+                #if UTILS_MEMORY_NEW_LOG
+                    const MetricsSnapshot snap = m.snapshot();
+
+                    stream << "Current memory usage: " << snap.CurrentUsage() << " bytes"
+                           << " (peak " << snap.Peak << " bytes, "
+                           << snap.AllocCount << " allocations, "
+                           << snap.FreeCount  << " deallocations)";
+                #else
+                    UNUSED(m);
+                    stream << "Current memory usage: unavailable, set UTILS_MEMORY_NEW_LOG macro first";
+                #endif
+
+                return stream;
+            }
+    };
+
+    inline Metrics_t Metrics;
 }
 
 #if UTILS_MEMORY_NEW_LOG && !defined(ENABLE_TESTS)
     void* operator new(size_t size) {
-        utils::memory::Metrics.TotalAllocated += size;
+        #if defined(UTILS_COMPILER_MSVC)
+            utils::memory::Metrics.on_alloc(size, _ReturnAddress());
+        #else
+            utils::memory::Metrics.on_alloc(size, __builtin_return_address(0));
+        #endif
         void* v = std::malloc(size);
 
         #if UTILS_MEMORY_ALLOC_LOG
@@ -55,28 +335,28 @@ namespace utils::memory {
     }
 
     void operator delete(void *v, size_t size) noexcept {
-        utils::memory::Metrics.TotalFreed += size;
+        utils::memory::Metrics.on_free(size);
 
         #if UTILS_MEMORY_ALLOC_LOG
             std::fprintf(stderr, "[delete] at 0x%p (len=%lld bytes)\n", v, size);
-        #else
-            UNUSED(size);
         #endif
         std::free(v);
     }
 
     void operator delete[](void *v, size_t size) noexcept {
-        utils::memory::Metrics.TotalFreed += size;
+        utils::memory::Metrics.on_free(size);
 
         #if UTILS_MEMORY_ALLOC_LOG
             std::fprintf(stderr, "[delete[]] at 0x%p (len=%lld bytes)\n", v, size);
-        #else
-            UNUSED(size);
         #endif
         std::free(v);
     }
 
     void operator delete(void *v) noexcept {
+        if (v != nullptr) {
+            utils::memory::Metrics.on_free(0);
+        }
+
         #if UTILS_MEMORY_ALLOC_LOG
             std::fprintf(stderr, "[delete] at 0x%p (len=? bytes)\n", v);
         #endif
@@ -84,6 +364,10 @@ namespace utils::memory {
     }
 
     void operator delete[](void *v) noexcept {
+        if (v != nullptr) {
+            utils::memory::Metrics.on_free(0);
+        }
+
         #if UTILS_MEMORY_ALLOC_LOG
             std::fprintf(stderr, "[delete[]] at 0x%p (len=? bytes)\n", v);
         #endif
@@ -242,6 +526,7 @@ namespace utils::memory {
 
     /**	\brief	Reallocate the given array to a new array with different size.
      *          Elements will be copied to the new array.
+     *          See realloc_growable_array() for a copy-free alternative on trivially copyable types.
      *
      *	\tparam	T
      *		The type of object to allocate.
@@ -304,6 +589,7 @@ namespace utils::memory {
     }
 
     /**	\brief	Allocate y arrays of objects of type T and length x on the heap.
+     *          Prefer ndarray<T, 2>, which uses a single contiguous allocation.
      *
      *	\tparam	T
      *		The type of object to allocate.
@@ -340,6 +626,7 @@ namespace utils::memory {
     }
 
     /**	\brief	Allocate z arrays of y arrays of objects of type T and length x on the heap.
+     *          Prefer ndarray<T, 3>, which uses a single contiguous allocation.
      *
      *	\tparam	T
      *		The type of object to allocate.
@@ -380,90 +667,1290 @@ namespace utils::memory {
     }
 
     ////////////////////////////////////////////////////////////////////////////
-    ///  Containers
+    ///  Aligned arrays and page backed buffers
     ////////////////////////////////////////////////////////////////////////////
-    /**	\brief	Deallocate a Container with pointers.
-     *          This can be any type where utils::traits::is_container is true.
+    static constexpr size_t CACHE_LINE_BYTES = 64;                ///< Cache line size (and SIMD friendly alignment)
+    static constexpr size_t PAGE_BYTES       = 4 * 1024;          ///< Regular page size
+    static constexpr size_t HUGE_PAGE_BYTES  = 2 * 1024 * 1024;   ///< Huge page size on x86-64
+
+    /**	\brief	Allocate an array of objects of type T and length x, aligned on \p alignment bytes.
+     *          Elements are value-initialised, like new_array.
      *
-     *          For map-like structures, if the ::mapped_type is a pointer, it will be freed,
-     *          for others if ::value_type is a pointer it will be freed.
+     *	\tparam	T
+     *		The type of object to allocate.
+     *	\param	x
+     *		The length of the array in the first dimension.
+     *	\param	alignment
+     *		The alignment in bytes, a power of 2 (e.g. CACHE_LINE_BYTES or PAGE_BYTES).
+     *	\return
+     *		A pointer to the newly allocated object, free with delete_aligned_array().
      *
-     *  \tparam Container
-     *      A container type that passes utils::traits::is_container<Container>::value.
-     *	\param	container
-     *		The container element that holds allocated pointers.
+     *  \exception Exception
+     *      Throws Exception if \p alignment is not a power of 2.
      */
-    template <
-        class Container,
-        typename = typename std::enable_if_t<utils::traits::is_container<Container>::value>
-    > ATTR_MAYBE_UNUSED
-    static void delete_container(Container *container) {
-        if constexpr (utils::traits::is_maplike_v<Container>) {
-            if constexpr (std::is_pointer_v<typename Container::mapped_type>)
-            {
-                #if UTILS_MEMORY_ALLOC_LOG
-                    std::fprintf(stderr, "[delete_map] at 0x%p\n", container);
-                #endif
-                for (auto& [key, value] : *container) {
-                    UNUSED(key);
-                    utils::memory::delete_var(value);
+    template <class T> ATTR_MAYBE_UNUSED ATTR_NODISCARD HEDLEY_MALLOC
+    static T* new_aligned_array(size_t x, size_t alignment = CACHE_LINE_BYTES) {
+        if (HEDLEY_UNLIKELY(alignment == 0 || (alignment & (alignment - 1)) != 0)) {
+            throw utils::exceptions::Exception("utils::memory::new_aligned_array",
+                                               "Alignment must be a power of 2.");
+        }
+
+        if (HEDLEY_UNLIKELY(x > SIZE_MAX / sizeof(T))) {
+            throw std::bad_alloc();
+        }
+
+        alignment = std::max(alignment, alignof(T));
+
+        T *arr = static_cast<T*>(::operator new[](std::max(x, size_t(1)) * sizeof(T),
+                                                  std::align_val_t(alignment)));
+
+        try {
+            std::uninitialized_value_construct_n(arr, x);
+        } catch (...) {
+            ::operator delete[](arr, std::align_val_t(alignment));
+            throw;
+        }
+
+        return arr;
+    }
+
+    /**	\brief	Deallocate an array that was allocated using new_aligned_array<T>(x, alignment).
+     *
+     *	\param	*a
+     *		A pointer to the object to deallocate.
+     *	\param	x
+     *		The length of the array, as passed to new_aligned_array.
+     *	\param	alignment
+     *		The alignment, as passed to new_aligned_array.
+     */
+    template <class T> ATTR_MAYBE_UNUSED
+    static void delete_aligned_array(T* a, size_t x, size_t alignment = CACHE_LINE_BYTES) {
+        #if UTILS_MEMORY_ALLOC_LOG
+            std::fprintf(stderr, "[delete_aligned_array] at 0x%p\n", a);
+        #endif
+        if (a != nullptr) {
+            std::destroy_n(a, x);
+            ::operator delete[](a, std::align_val_t(std::max(alignment, alignof(T))));
+        }
+    }
+
+    /**
+     *  Deleter for unique_aligned_arr_t, remembering the length and alignment.
+     */
+    template <class T>
+    struct AlignedArrayDeleter {
+        size_t length    = 0;
+        size_t alignment = CACHE_LINE_BYTES;
+
+        inline void operator()(T *a) const {
+            utils::memory::delete_aligned_array(a, this->length, this->alignment);
+        }
+    };
+
+    /**
+     *  Self destructing aligned array type.
+     */
+    template <class T>
+    using unique_aligned_arr_t = unique_t<T[], AlignedArrayDeleter<T>>;
+
+    /**
+     *  \brief  Create a unique_aligned_arr_t<T> variable that deletes itself.
+     *
+     *  \param  x
+     *      The length of the array in the first dimension.
+     *  \param  alignment
+     *      The alignment in bytes, a power of 2.
+     */
+    template <class T> ATTR_MAYBE_UNUSED ATTR_NODISCARD
+    static inline unique_aligned_arr_t<T> new_unique_aligned_array(size_t x, size_t alignment = CACHE_LINE_BYTES) {
+        return unique_aligned_arr_t<T>(new_aligned_array<T>(x, alignment),
+                                       AlignedArrayDeleter<T>{ x, alignment });
+    }
+
+    /**
+     *  Memory backing for large buffers.
+     */
+    enum class PageBacking : uint8_t {
+        Auto,       ///< HugePages for buffers of at least HUGE_PAGE_BYTES, Heap otherwise
+        Heap,       ///< Page aligned heap memory
+        Pages,      ///< Anonymous memory mapping
+        HugePages,  ///< Huge page aligned memory mapping, advised with MADV_HUGEPAGE (transparent huge pages)
+        HugeTLB,    ///< Explicit huge pages from hugetlbfs (MAP_HUGETLB), falls back to HugePages
+    };
+
+    namespace internal {
+        /**
+         *  Result of allocate_buffer(): the actually used backing and size in bytes.
+         */
+        struct BufferInfo {
+            void       *data;
+            size_t      bytes;
+            PageBacking backing;
+        };
+
+        ATTR_MAYBE_UNUSED ATTR_NODISCARD
+        static inline constexpr size_t round_up(size_t value, size_t multiple) {
+            return (value + multiple - 1) / multiple * multiple;
+        }
+
+        #if defined(UTILS_OS_LINUX)
+            ATTR_MAYBE_UNUSED ATTR_NODISCARD
+            static void* map_pages(size_t bytes, int flags = 0) {
+                void *p = ::mmap(nullptr, bytes, PROT_READ | PROT_WRITE,
+                                 MAP_PRIVATE | MAP_ANONYMOUS | flags, -1, 0);
+                return p == MAP_FAILED ? nullptr : p;
+            }
+
+            /**
+             *  \brief  Map \p bytes (a multiple of HUGE_PAGE_BYTES) on a huge page boundary,
+             *          by over-mapping and trimming the excess.
+             */
+            ATTR_MAYBE_UNUSED ATTR_NODISCARD
+            static void* map_huge_pages(size_t bytes) {
+                const size_t total = bytes + HUGE_PAGE_BYTES;
+                uint8_t *raw = static_cast<uint8_t*>(map_pages(total));
+
+                if (raw == nullptr) {
+                    return nullptr;
                 }
+
+                uint8_t *aligned = raw + (round_up(uintptr_t(raw), HUGE_PAGE_BYTES) - uintptr_t(raw));
+                const size_t head = size_t(aligned - raw);
+                const size_t tail = total - head - bytes;
+
+                if (head > 0) ::munmap(raw, head);
+                if (tail > 0) ::munmap(aligned + bytes, tail);
+
+                #if defined(MADV_HUGEPAGE)
+                    ::madvise(aligned, bytes, MADV_HUGEPAGE);
+                #endif
+
+                return aligned;
             }
-        } else if constexpr (std::is_pointer_v<typename Container::value_type>) {
-            #if UTILS_MEMORY_ALLOC_LOG
-                std::fprintf(stderr, "[delete_container] at 0x%p\n", container);
-            #endif
-            for (auto *value : *container) {
-                utils::memory::delete_var(value);
+        #endif
+
+        /**
+         *  \brief  Allocate \p bytes of zeroed memory with the requested backing,
+         *          falling back to Heap when mapping fails or is unsupported.
+         */
+        ATTR_MAYBE_UNUSED ATTR_NODISCARD
+        static BufferInfo allocate_buffer(size_t bytes, PageBacking backing) {
+            bytes = std::max(bytes, size_t(1));
+
+            // Rounding up to a huge page and over-mapping for alignment must not wrap
+            if (HEDLEY_UNLIKELY(bytes > SIZE_MAX - 2u * HUGE_PAGE_BYTES)) {
+                throw std::bad_alloc();
+            }
+
+            if (backing == PageBacking::Auto) {
+                backing = bytes >= HUGE_PAGE_BYTES ? PageBacking::HugePages : PageBacking::Heap;
             }
+
+            #if defined(UTILS_OS_LINUX)
+                if (backing == PageBacking::HugeTLB) {
+                    #if defined(MAP_HUGETLB)
+                        const size_t mapped = round_up(bytes, HUGE_PAGE_BYTES);
+                        if (void *p = map_pages(mapped, MAP_HUGETLB)) {
+                            return { p, mapped, PageBacking::HugeTLB };
+                        }
+                    #endif
+                    backing = PageBacking::HugePages;
+                }
+
+                if (backing == PageBacking::HugePages) {
+                    const size_t mapped = round_up(bytes, HUGE_PAGE_BYTES);
+                    if (void *p = map_huge_pages(mapped)) {
+                        return { p, mapped, PageBacking::HugePages };
+                    }
+                    backing = PageBacking::Pages;
+                }
+
+                if (backing == PageBacking::Pages) {
+                    const size_t mapped = round_up(bytes, PAGE_BYTES);
+                    if (void *p = map_pages(mapped)) {
+                        return { p, mapped, PageBacking::Pages };
+                    }
+                }
+            #endif
+
+            void *p = ::operator new(bytes, std::align_val_t(PAGE_BYTES));
+            std::memset(p, 0, bytes);
+            return { p, bytes, PageBacking::Heap };
         }
 
-        utils::memory::delete_var(container);
+        ATTR_MAYBE_UNUSED
+        static void free_buffer(void *p, size_t bytes, PageBacking backing) noexcept {
+            if (p == nullptr) {
+                return;
+            }
+
+            #if defined(UTILS_OS_LINUX)
+                if (backing != PageBacking::Heap) {
+                    ::munmap(p, bytes);
+                    return;
+                }
+            #else
+                UNUSED(bytes, backing);
+            #endif
+
+            ::operator delete(p, std::align_val_t(PAGE_BYTES));
+        }
     }
 
     /**
-     *  Self destructing container type.
-     *  Unique_ptr container that will auto dealloc all elements and itself.
+     *  Deleter for page backed buffers, remembering the size and backing used.
      */
     template <class T>
-    using unique_container_t = unique_t<T, decltype(&delete_container<T>)>;
+    struct BufferDeleter {
+        size_t      bytes   = 0;                  ///< Allocated size in bytes (may be more than requested)
+        PageBacking backing = PageBacking::Heap;  ///< The backing that was actually used
+
+        inline void operator()(T *p) const noexcept {
+            #if UTILS_MEMORY_ALLOC_LOG
+                std::fprintf(stderr, "[delete_buffer] at 0x%p\n", p);
+            #endif
+            utils::memory::internal::free_buffer(p, this->bytes, this->backing);
+        }
+    };
 
     /**
-     *  Self destructing vector type.
-     *  Unique_ptr vector that contains pointers to T.
-     *  Will auto dealloc all elements and itself.
+     *  Self destructing page backed buffer type.
      */
     template <class T>
-    using unique_vect_t = unique_container_t<std::vector<T*>>;
+    using unique_buffer_t = unique_t<T[], BufferDeleter<T>>;
 
-    template <class T, class ... Type> ATTR_MAYBE_UNUSED ATTR_NODISCARD
-    static inline auto new_unique_container(Type &&... args) {
-        return unique_container_t<T>(
-            new_var<T>(std::forward<Type>(args)...),
-            &delete_container<T>
-        );
-    }
+    /**
+     *  Shared page backed buffer type.
+     */
+    template <class T>
+    using shared_buffer_t = std::shared_ptr<T[]>;
 
     /**
-     *  \brief  Create a unique_vect_t<T> variable that deletes
-     *          its contents and itself. The vector will contain T* items.
+     *  \brief  Create a page aligned, zeroed buffer of \p x elements of T,
+     *          optionally backed by (huge) pages to reduce TLB misses on large buffers.
+     *          Falls back to page aligned heap memory if the backing is unavailable,
+     *          check get_deleter().backing for the result.
      *
-     *  \param  args
-     *      Variable argument list passed down to ctor of std::vector<T>.
+     *  \tparam T
+     *      A trivial type (zeroed memory is a valid value).
+     *  \param  x
+     *      The length of the buffer.
+     *  \param  backing
+     *      The requested memory backing.
      */
-    template <class T, class ... Type> ATTR_MAYBE_UNUSED ATTR_NODISCARD
-    static inline auto new_unique_vector(Type &&... args) {
-        return unique_vect_t<T>(
-            new_var<std::vector<T*>>(std::forward<Type>(args)...),
-            &delete_container<std::vector<T*>>
-        );
+    template <class T> ATTR_MAYBE_UNUSED ATTR_NODISCARD
+    static unique_buffer_t<T> new_unique_buffer(size_t x, PageBacking backing = PageBacking::Auto) {
+        static_assert(std::is_trivial_v<T>, "utils::memory::new_unique_buffer: Trivial type required.");
+
+        if (HEDLEY_UNLIKELY(x > SIZE_MAX / sizeof(T))) {
+            throw std::bad_alloc();
+        }
+
+        const auto info = internal::allocate_buffer(x * sizeof(T), backing);
+        return unique_buffer_t<T>(static_cast<T*>(info.data), BufferDeleter<T>{ info.bytes, info.backing });
     }
-}
 
-#ifdef UTILS_MEMORY_ALLOC_LOG
-    #undef UTILS_MEMORY_ALLOC_LOG
-#endif
-#ifdef UTILS_MEMORY_NEW_LOG
-    #undef UTILS_MEMORY_NEW_LOG
+    /**
+     *  \brief  Create a shared, page aligned, zeroed buffer of \p x elements of T.
+     *          See new_unique_buffer().
+     */
+    template <class T> ATTR_MAYBE_UNUSED ATTR_NODISCARD
+    static shared_buffer_t<T> new_shared_buffer(size_t x, PageBacking backing = PageBacking::Auto) {
+        auto buffer = utils::memory::new_unique_buffer<T>(x, backing);
+        const BufferDeleter<T> deleter = buffer.get_deleter();
+        return shared_buffer_t<T>(buffer.release(), deleter);
+    }
+
+    ////////////////////////////////////////////////////////////////////////////
+    ///  Growable arrays
+    ////////////////////////////////////////////////////////////////////////////
+    namespace internal {
+        /**
+         *  Header stored in front of every growable array.
+         */
+        struct GrowableHeader {
+            size_t bytes;   ///< Requested size in bytes
+            size_t mapped;  ///< Size of the memory mapping including header, 0 if allocated with malloc
+        };
+
+        static constexpr size_t GROWABLE_HEADER_BYTES   = round_up(sizeof(GrowableHeader), alignof(std::max_align_t));
+        static constexpr size_t GROWABLE_MMAP_THRESHOLD = 256 * 1024;  ///< Arrays from this size on are memory mapped
+
+        ATTR_MAYBE_UNUSED ATTR_NODISCARD
+        static inline GrowableHeader* growable_header(void *data) {
+            return reinterpret_cast<GrowableHeader*>(static_cast<uint8_t*>(data) - GROWABLE_HEADER_BYTES);
+        }
+
+        ATTR_MAYBE_UNUSED ATTR_NODISCARD
+        static inline void* growable_data(GrowableHeader *header) {
+            return reinterpret_cast<uint8_t*>(header) + GROWABLE_HEADER_BYTES;
+        }
+
+        /**
+         *  \brief  Allocate \p bytes of zeroed memory behind a GrowableHeader.
+         *          Small sizes use calloc, large sizes an anonymous memory mapping.
+         */
+        ATTR_MAYBE_UNUSED ATTR_NODISCARD
+        static void* growable_alloc(size_t bytes) {
+            // The header and rounding up to a page must not wrap
+            if (HEDLEY_UNLIKELY(bytes > SIZE_MAX - GROWABLE_HEADER_BYTES - PAGE_BYTES)) {
+                throw std::bad_alloc();
+            }
+
+            const size_t total = bytes + GROWABLE_HEADER_BYTES;
+            GrowableHeader *header = nullptr;
+            size_t mapped = 0;
+
+            #if defined(UTILS_OS_LINUX) && defined(MREMAP_MAYMOVE)
+                if (bytes >= GROWABLE_MMAP_THRESHOLD) {
+                    mapped = round_up(total, PAGE_BYTES);
+                    header = static_cast<GrowableHeader*>(map_pages(mapped));
+
+                    if (header == nullptr) {
+                        mapped = 0;
+                    }
+                }
+            #endif
+
+            if (header == nullptr) {
+                header = static_cast<GrowableHeader*>(std::calloc(1, total));
+
+                if (HEDLEY_UNLIKELY(header == nullptr)) {
+                    throw std::bad_alloc();
+                }
+            }
+
+            header->bytes  = bytes;
+            header->mapped = mapped;
+            return growable_data(header);
+        }
+
+        ATTR_MAYBE_UNUSED
+        static void growable_free(void *data) noexcept {
+            if (data == nullptr) {
+                return;
+            }
+
+            GrowableHeader *header = growable_header(data);
+
+            #if defined(UTILS_OS_LINUX) && defined(MREMAP_MAYMOVE)
+                if (header->mapped > 0) {
+                    ::munmap(header, header->mapped);
+                    return;
+                }
+            #endif
+
+            std::free(header);
+        }
+
+        /**
+         *  \brief  Resize the memory at \p data to \p bytes, zeroing any newly added bytes.
+         *          Mapped memory is resized with mremap (no copy, pages are moved if needed),
+         *          small memory with realloc (in-place growth where possible).
+         */
+        ATTR_MAYBE_UNUSED ATTR_NODISCARD
+        static void* growable_realloc(void *data, size_t bytes) {
+            if (data == nullptr) {
+                return growable_alloc(bytes);
+            }
+
+            if (HEDLEY_UNLIKELY(bytes > SIZE_MAX - GROWABLE_HEADER_BYTES - PAGE_BYTES)) {
+                throw std::bad_alloc();
+            }
+
+            GrowableHeader *header = growable_header(data);
+            const size_t old_bytes = header->bytes;
+            const size_t total     = bytes + GROWABLE_HEADER_BYTES;
+
+            #if defined(UTILS_OS_LINUX) && defined(MREMAP_MAYMOVE)
+                if (header->mapped > 0 && bytes >= GROWABLE_MMAP_THRESHOLD / 2) {
+                    const size_t old_mapped = header->mapped;
+                    const size_t mapped     = round_up(total, PAGE_BYTES);
+
+                    if (mapped != old_mapped) {
+                        void *p = ::mremap(header, old_mapped, mapped, MREMAP_MAYMOVE);
+
+                        if (HEDLEY_UNLIKELY(p == MAP_FAILED)) {
+                            throw std::bad_alloc();
+                        }
+
+                        header = static_cast<GrowableHeader*>(p);
+                        header->mapped = mapped;
+                    }
+
+                    // Fresh pages are zeroed, only clear stale bytes in the previous mapping
+                    if (bytes > old_bytes) {
+                        const size_t stale_end = std::min(bytes, old_mapped - GROWABLE_HEADER_BYTES);
+                        if (stale_end > old_bytes) {
+                            std::memset(static_cast<uint8_t*>(growable_data(header)) + old_bytes, 0, stale_end - old_bytes);
+                        }
+                    }
+
+                    header->bytes = bytes;
+                    return growable_data(header);
+                }
+
+                if (header->mapped > 0 || bytes >= GROWABLE_MMAP_THRESHOLD) {
+                    // Move between calloc and mapped memory
+                    void *moved = growable_alloc(bytes);
+                    std::memcpy(moved, data, std::min(old_bytes, bytes));
+                    growable_free(data);
+                    return moved;
+                }
+            #endif
+
+            void *p = std::realloc(header, total);
+
+            if (HEDLEY_UNLIKELY(p == nullptr)) {
+                throw std::bad_alloc();
+            }
+
+            header = static_cast<GrowableHeader*>(p);
+
+            if (bytes > old_bytes) {
+                std::memset(static_cast<uint8_t*>(growable_data(header)) + old_bytes, 0, bytes - old_bytes);
+            }
+
+            header->bytes = bytes;
+            return growable_data(header);
+        }
+    }
+
+    /**	\brief	Allocate a zeroed array of trivially copyable objects of type T and length x,
+     *          that can be resized cheaply with realloc_growable_array().
+     *
+     *	\tparam	T
+     *		The type of object to allocate.
+     *	\param	x
+     *		The length of the array in the first dimension.
+     *	\return
+     *		A pointer to the newly allocated object, free with delete_growable_array().
+     */
+    template <class T> ATTR_MAYBE_UNUSED ATTR_NODISCARD HEDLEY_MALLOC
+    static inline T* new_growable_array(size_t x) {
+        static_assert(std::is_trivially_copyable_v<T>, "utils::memory::new_growable_array: Trivially copyable type required.");
+
+        if (HEDLEY_UNLIKELY(x > SIZE_MAX / sizeof(T))) {
+            throw std::bad_alloc();
+        }
+
+        return static_cast<T*>(internal::growable_alloc(x * sizeof(T)));
+    }
+
+    /**	\brief	Deallocate an array that was allocated using new_growable_array<T>(size_t).
+     *
+     *	\param	*a
+     *		A pointer to the object to deallocate.
+     */
+    template <class T> ATTR_MAYBE_UNUSED
+    static inline void delete_growable_array(T* a) {
+        #if UTILS_MEMORY_ALLOC_LOG
+            std::fprintf(stderr, "[delete_growable_array] at 0x%p\n", a);
+        #endif
+        internal::growable_free(a);
+    }
+
+    /**	\brief	Resize the given growable array, fast path of realloc_array() for trivially copyable types.
+     *          Small arrays are resized with realloc, large ones are memory mapped
+     *          and grown with mremap, so elements are not copied.
+     *          New elements are zeroed.
+     *
+     *	\tparam	T
+     *		The type of object to allocate.
+     *	\param	*&a
+     *		A reference to a pointer to the array (from new_growable_array, or nullptr).
+     *	\param	&old_size
+     *		The old length of the array in the first dimension, by reference.
+     *      old_size will contain the new length after reallocation.
+     *	\param	new_size
+     *		The new length of the array in the first dimension.
+     */
+    template <class T> ATTR_MAYBE_UNUSED
+    static void realloc_growable_array(T*& a, size_t& old_size, size_t new_size) {
+        static_assert(std::is_trivially_copyable_v<T>, "utils::memory::realloc_growable_array: Trivially copyable type required.");
+
+        #if UTILS_MEMORY_ALLOC_LOG
+            std::fprintf(stderr, "[realloc_growable_array] at 0x%p from %u to %u\n",
+                         a, uint32_t(old_size), uint32_t(new_size));
+        #endif
+
+        if (HEDLEY_UNLIKELY(new_size > SIZE_MAX / sizeof(T))) {
+            throw std::bad_alloc();
+        }
+
+        a = static_cast<T*>(internal::growable_realloc(a, new_size * sizeof(T)));
+        old_size = new_size;
+    }
+
+    ////////////////////////////////////////////////////////////////////////////
+    ///  Multi-dimensional arrays
+    ////////////////////////////////////////////////////////////////////////////
+    /*
+     *  Contiguous alternatives to the T** / T*** arrays above: one allocation,
+     *  elements addressed through a layout mapping instead of pointer chasing.
+     */
+    namespace internal {
+        template <size_t N> ATTR_MAYBE_UNUSED ATTR_NODISCARD
+        static inline constexpr size_t extents_product(const std::array<size_t, N>& extents) {
+            size_t product = 1;
+            for (size_t r = 0; r < N; r++) {
+                product *= extents[r];
+            }
+            return product;
+        }
+    }
+
+    /**
+     *  Row-major layout (last index is contiguous), like C arrays.
+     */
+    struct layout_right {
+        template <size_t N>
+        struct mapping {
+            std::array<size_t, N> extents{};
+            std::array<size_t, N> strides{};
+
+            constexpr mapping() = default;
+
+            constexpr explicit mapping(const std::array<size_t, N>& e) : extents(e) {
+                size_t stride = 1;
+                for (size_t r = N; r-- > 0;) {
+                    this->strides[r] = stride;
+                    stride *= e[r];
+                }
+            }
+
+            constexpr size_t required_size() const {
+                return internal::extents_product(this->extents);
+            }
+
+            constexpr size_t operator()(const std::array<size_t, N>& idx) const {
+                size_t offset = 0;
+                for (size_t r = 0; r < N; r++) {
+                    offset += idx[r] * this->strides[r];
+                }
+                return offset;
+            }
+        };
+    };
+
+    /**
+     *  Column-major layout (first index is contiguous), like Fortran arrays.
+     */
+    struct layout_left {
+        template <size_t N>
+        struct mapping {
+            std::array<size_t, N> extents{};
+            std::array<size_t, N> strides{};
+
+            constexpr mapping() = default;
+
+            constexpr explicit mapping(const std::array<size_t, N>& e) : extents(e) {
+                size_t stride = 1;
+                for (size_t r = 0; r < N; r++) {
+                    this->strides[r] = stride;
+                    stride *= e[r];
+                }
+            }
+
+            constexpr size_t required_size() const {
+                return internal::extents_product(this->extents);
+            }
+
+            constexpr size_t operator()(const std::array<size_t, N>& idx) const {
+                size_t offset = 0;
+                for (size_t r = 0; r < N; r++) {
+                    offset += idx[r] * this->strides[r];
+                }
+                return offset;
+            }
+        };
+    };
+
+    /**
+     *  Layout with arbitrary strides (in elements), e.g. for slices and transposed views.
+     */
+    struct layout_stride {
+        template <size_t N>
+        struct mapping {
+            std::array<size_t, N> extents{};
+            std::array<size_t, N> strides{};
+
+            constexpr mapping() = default;
+
+            constexpr mapping(const std::array<size_t, N>& e, const std::array<size_t, N>& s)
+                : extents(e), strides(s) {}
+
+            constexpr size_t required_size() const {
+                size_t last = 0;
+                for (size_t r = 0; r < N; r++) {
+                    if (this->extents[r] == 0) {
+                        return 0;
+                    }
+                    last += (this->extents[r] - 1) * this->strides[r];
+                }
+                return last + 1;
+            }
+
+            constexpr size_t operator()(const std::array<size_t, N>& idx) const {
+                size_t offset = 0;
+                for (size_t r = 0; r < N; r++) {
+                    offset += idx[r] * this->strides[r];
+                }
+                return offset;
+            }
+        };
+    };
+
+    /**
+     *  2D layout storing Tile x Tile blocks contiguously (row-major within and between tiles),
+     *  so neighbours in both directions share cache lines.
+     *  Extents are padded to a multiple of Tile in storage.
+     */
+    template <size_t Tile = 8>
+    struct layout_tiled {
+        static_assert(Tile > 0 && (Tile & (Tile - 1)) == 0, "utils::memory::layout_tiled: Tile must be a power of 2.");
+
+        template <size_t N>
+        struct mapping {
+            static_assert(N == 2, "utils::memory::layout_tiled: Only 2 dimensions are supported.");
+
+            std::array<size_t, N> extents{};
+            size_t tiles_per_row = 0;
+
+            constexpr mapping() = default;
+
+            constexpr explicit mapping(const std::array<size_t, N>& e)
+                : extents(e), tiles_per_row((e[1] + Tile - 1) / Tile) {}
+
+            constexpr size_t required_size() const {
+                return internal::round_up(this->extents[0], Tile) * this->tiles_per_row * Tile;
+            }
+
+            constexpr size_t operator()(const std::array<size_t, N>& idx) const {
+                const size_t tile = (idx[0] / Tile) * this->tiles_per_row + idx[1] / Tile;
+                return tile * Tile * Tile + (idx[0] % Tile) * Tile + idx[1] % Tile;
+            }
+        };
+    };
+
+    /**
+     *  \brief  Non-owning view of a contiguous N-dimensional array.
+     *
+     *  \tparam T
+     *      The element type (const for read-only views).
+     *  \tparam N
+     *      The number of dimensions.
+     *  \tparam Layout
+     *      How indices map to offsets: layout_right (default), layout_left,
+     *      layout_stride or layout_tiled<Tile>.
+     */
+    template <class T, size_t N, class Layout = layout_right>
+    class ndspan {
+        static_assert(N > 0, "utils::memory::ndspan: At least one dimension required.");
+
+        public:
+            using element_type = T;
+            using mapping_type = typename Layout::template mapping<N>;
+
+        private:
+            T           *ptr;
+            mapping_type map;
+
+        public:
+            constexpr ndspan() : ptr(nullptr), map() {}
+
+            constexpr ndspan(T *p, const mapping_type& m) : ptr(p), map(m) {}
+
+            template <
+                typename... Sizes,
+                typename = std::enable_if_t<sizeof...(Sizes) == N && (std::is_integral_v<Sizes> && ...)>
+            >
+            constexpr ndspan(T *p, Sizes... extents)
+                : ptr(p), map(std::array<size_t, N>{ size_t(extents)... }) {}
+
+            template <typename... Indices>
+            constexpr T& operator()(Indices... idx) const {
+                static_assert(sizeof...(Indices) == N, "utils::memory::ndspan: Wrong number of indices.");
+                return this->ptr[this->map({ size_t(idx)... })];
+            }
+
+            /**
+             *  \brief  Bounds checked access.
+             *
+             *  \exception Exception
+             *      Throws Exception if an index is out of range.
+             */
+            template <typename... Indices>
+            T& at(Indices... idx) const {
+                static_assert(sizeof...(Indices) == N, "utils::memory::ndspan: Wrong number of indices.");
+                const std::array<size_t, N> indices{ size_t(idx)... };
+
+                for (size_t r = 0; r < N; r++) {
+                    if (HEDLEY_UNLIKELY(indices[r] >= this->map.extents[r])) {
+                        throw utils::exceptions::Exception("utils::memory::ndspan::at", "Index out of range.");
+                    }
+                }
+
+                return this->ptr[this->map(indices)];
+            }
+
+            /**
+             *  \brief  View of the (N-1)-dimensional sub-array at index \p i of the first dimension.
+             *          Not available for tiled layouts.
+             */
+            auto slice(size_t i) const {
+                static_assert(N > 1, "utils::memory::ndspan::slice: At least two dimensions required.");
+                std::array<size_t, N - 1> extents{}, strides{};
+
+                for (size_t r = 1; r < N; r++) {
+                    extents[r - 1] = this->map.extents[r];
+                    strides[r - 1] = this->map.strides[r];
+                }
+
+                return ndspan<T, N - 1, layout_stride>(
+                    this->ptr + i * this->map.strides[0],
+                    typename layout_stride::template mapping<N - 1>(extents, strides)
+                );
+            }
+
+            static constexpr size_t rank() {
+                return N;
+            }
+
+            constexpr size_t extent(size_t r) const {
+                return this->map.extents[r];
+            }
+
+            /**
+             *  \brief  Number of addressable elements (product of the extents).
+             */
+            constexpr size_t size() const {
+                return internal::extents_product(this->map.extents);
+            }
+
+            /**
+             *  \brief  Number of elements spanned in memory, including padding.
+             */
+            constexpr size_t required_size() const {
+                return this->map.required_size();
+            }
+
+            constexpr T* data() const {
+                return this->ptr;
+            }
+
+            constexpr const mapping_type& mapping() const {
+                return this->map;
+            }
+    };
+
+    /**
+     *  \brief  Owning N-dimensional array in one cache line aligned allocation.
+     *          Elements are value-initialised, like new_array.
+     *
+     *  \tparam T
+     *      The element type.
+     *  \tparam N
+     *      The number of dimensions.
+     *  \tparam Layout
+     *      See ndspan.
+     */
+    template <class T, size_t N, class Layout = layout_right>
+    class ndarray {
+        public:
+            using element_type = T;
+            using mapping_type = typename Layout::template mapping<N>;
+            using view_type    = ndspan<T, N, Layout>;
+
+        private:
+            mapping_type            map;
+            unique_aligned_arr_t<T> storage;
+
+        public:
+            template <
+                typename... Sizes,
+                typename = std::enable_if_t<sizeof...(Sizes) == N && (std::is_integral_v<Sizes> && ...)>
+            >
+            explicit ndarray(Sizes... extents)
+                : map(std::array<size_t, N>{ size_t(extents)... })
+                , storage(new_unique_aligned_array<T>(this->map.required_size()))
+            {
+                // Empty
+            }
+
+            ndarray(const ndarray& other)
+                : map(other.map)
+                , storage(new_unique_aligned_array<T>(other.map.required_size()))
+            {
+                std::copy_n(other.data(), this->map.required_size(), this->data());
+            }
+
+            ndarray(ndarray&&) noexcept = default;
+
+            ndarray& operator=(const ndarray& other) {
+                if (this != &other) {
+                    ndarray copy(other);
+                    *this = std::move(copy);
+                }
+                return *this;
+            }
+
+            ndarray& operator=(ndarray&&) noexcept = default;
+
+            template <typename... Indices>
+            inline T& operator()(Indices... idx) {
+                static_assert(sizeof...(Indices) == N, "utils::memory::ndarray: Wrong number of indices.");
+                return this->storage[this->map({ size_t(idx)... })];
+            }
+
+            template <typename... Indices>
+            inline const T& operator()(Indices... idx) const {
+                static_assert(sizeof...(Indices) == N, "utils::memory::ndarray: Wrong number of indices.");
+                return this->storage[this->map({ size_t(idx)... })];
+            }
+
+            template <typename... Indices>
+            inline T& at(Indices... idx) {
+                return this->view().at(idx...);
+            }
+
+            template <typename... Indices>
+            inline const T& at(Indices... idx) const {
+                return this->view().at(idx...);
+            }
+
+            inline view_type view() {
+                return view_type(this->data(), this->map);
+            }
+
+            inline ndspan<const T, N, Layout> view() const {
+                return ndspan<const T, N, Layout>(this->data(), this->map);
+            }
+
+            inline void fill(const T& value) {
+                std::fill_n(this->data(), this->map.required_size(), value);
+            }
+
+            static constexpr size_t rank() {
+                return N;
+            }
+
+            inline size_t extent(size_t r) const {
+                return this->map.extents[r];
+            }
+
+            inline size_t size() const {
+                return internal::extents_product(this->map.extents);
+            }
+
+            inline T* data() {
+                return this->storage.get();
+            }
+
+            inline const T* data() const {
+                return this->storage.get();
+            }
+    };
+
+    /**
+     *  \brief  N-dimensional row-major array with extents fixed at compile time.
+     *          Stored inline (no heap allocation), offsets fold to constants.
+     *
+     *  \tparam T
+     *      The element type.
+     *  \tparam Extents
+     *      The extent of each dimension.
+     */
+    template <class T, size_t... Extents>
+    class fixed_ndarray {
+        public:
+            static constexpr size_t N = sizeof...(Extents);
+            using element_type = T;
+            using mapping_type = typename layout_right::template mapping<N>;
+            using view_type    = ndspan<T, N, layout_right>;
+
+            static_assert(N > 0, "utils::memory::fixed_ndarray: At least one dimension required.");
+
+        private:
+            static constexpr mapping_type map{ std::array<size_t, N>{ Extents... } };
+
+            std::array<T, (Extents * ... * 1)> values{};
+
+        public:
+            template <typename... Indices>
+            constexpr T& operator()(Indices... idx) {
+                static_assert(sizeof...(Indices) == N, "utils::memory::fixed_ndarray: Wrong number of indices.");
+                return this->values[map({ size_t(idx)... })];
+            }
+
+            template <typename... Indices>
+            constexpr const T& operator()(Indices... idx) const {
+                static_assert(sizeof...(Indices) == N, "utils::memory::fixed_ndarray: Wrong number of indices.");
+                return this->values[map({ size_t(idx)... })];
+            }
+
+            inline view_type view() {
+                return view_type(this->data(), map);
+            }
+
+            inline ndspan<const T, N, layout_right> view() const {
+                return ndspan<const T, N, layout_right>(this->data(), map);
+            }
+
+            constexpr void fill(const T& value) {
+                this->values.fill(value);
+            }
+
+            static constexpr size_t rank() {
+                return N;
+            }
+
+            static constexpr size_t extent(size_t r) {
+                return map.extents[r];
+            }
+
+            static constexpr size_t size() {
+                return (Extents * ... * 1);
+            }
+
+            constexpr T* data() {
+                return this->values.data();
+            }
+
+            constexpr const T* data() const {
+                return this->values.data();
+            }
+    };
+
+    ////////////////////////////////////////////////////////////////////////////
+    ///  Containers
+    ////////////////////////////////////////////////////////////////////////////
+    /**	\brief	Deallocate a Container with pointers.
+     *          This can be any type where utils::traits::is_container is true.
+     *
+     *          For map-like structures, if the ::mapped_type is a pointer, it will be freed,
+     *          for others if ::value_type is a pointer it will be freed.
+     *
+     *  \tparam Container
+     *      A container type that passes utils::traits::is_container<Container>::value.
+     *	\param	container
+     *		The container element that holds allocated pointers.
+     */
+    template <
+        class Container,
+        typename = typename std::enable_if_t<utils::traits::is_container<Container>::value>
+    > ATTR_MAYBE_UNUSED
+    static void delete_container(Container *container) {
+        if constexpr (utils::traits::is_maplike_v<Container>) {
+            if constexpr (std::is_pointer_v<typename Container::mapped_type>)
+            {
+                #if UTILS_MEMORY_ALLOC_LOG
+                    std::fprintf(stderr, "[delete_map] at 0x%p\n", container);
+                #endif
+                for (auto& [key, value] : *container) {
+                    UNUSED(key);
+                    utils::memory::delete_var(value);
+                }
+            }
+        } else if constexpr (std::is_pointer_v<typename Container::value_type>) {
+            #if UTILS_MEMORY_ALLOC_LOG
+                std::fprintf(stderr, "[delete_container] at 0x%p\n", container);
+            #endif
+            for (auto *value : *container) {
+                utils::memory::delete_var(value);
+            }
+        }
+
+        utils::memory::delete_var(container);
+    }
+
+    /**
+     *  Self destructing container type.
+     *  Unique_ptr container that will auto dealloc all elements and itself.
+     */
+    template <class T>
+    using unique_container_t = unique_t<T, decltype(&delete_container<T>)>;
+
+    /**
+     *  Self destructing vector type.
+     *  Unique_ptr vector that contains pointers to T.
+     *  Will auto dealloc all elements and itself.
+     */
+    template <class T>
+    using unique_vect_t = unique_container_t<std::vector<T*>>;
+
+    template <class T, class ... Type> ATTR_MAYBE_UNUSED ATTR_NODISCARD
+    static inline auto new_unique_container(Type &&... args) {
+        return unique_container_t<T>(
+            new_var<T>(std::forward<Type>(args)...),
+            &delete_container<T>
+        );
+    }
+
+    /**
+     *  \brief  Create a unique_vect_t<T> variable that deletes
+     *          its contents and itself. The vector will contain T* items.
+     *
+     *  \param  args
+     *      Variable argument list passed down to ctor of std::vector<T>.
+     */
+    template <class T, class ... Type> ATTR_MAYBE_UNUSED ATTR_NODISCARD
+    static inline auto new_unique_vector(Type &&... args) {
+        return unique_vect_t<T>(
+            new_var<std::vector<T*>>(std::forward<Type>(args)...),
+            &delete_container<std::vector<T*>>
+        );
+    }
+
+    ////////////////////////////////////////////////////////////////////////////
+    ///  Pools
+    ////////////////////////////////////////////////////////////////////////////
+    /**
+     *  \brief  Fixed-size object pool (slab allocator) for objects of type T.
+     *
+     *          Memory is carved from slabs of \p BatchSize slots. Every thread
+     *          keeps its own free-list, so allocate() and deallocate() do not
+     *          lock in the common case. When a thread's list runs empty, it takes
+     *          a batch of free slots from a global depot (or a new slab), and when
+     *          it holds more than two batches, one batch is handed back to the depot.
+     *
+     *          Slabs are only returned to the system when the program exits.
+     *
+     *  \tparam T
+     *      The type of object to pool.
+     *  \tparam BatchSize
+     *      The amount of slots moved between a thread and the depot at once,
+     *      and the amount of slots per slab.
+     */
+    template <class T, size_t BatchSize = 64>
+    class ObjectPool {
+        static_assert(BatchSize > 0, "utils::memory::ObjectPool: BatchSize must be at least 1.");
+
+        private:
+            union Slot {
+                Slot *next;
+                alignas(T) unsigned char storage[sizeof(T)];
+            };
+
+            struct Batch {
+                Slot  *head;
+                size_t count;
+            };
+
+            struct Depot {
+                std::mutex lock;
+                std::vector<Batch> batches;                 ///< Free slots handed back by threads
+                std::vector<std::unique_ptr<Slot[]>> slabs; ///< All slabs ever allocated
+            };
+
+            struct Cache {
+                Slot  *head  = nullptr;
+                size_t count = 0;
+
+                ~Cache() {
+                    // Return everything to the depot when the thread exits
+                    if (this->head != nullptr) {
+                        Depot& d = ObjectPool::depot();
+                        LOCK_BLOCK(d.lock);
+                        d.batches.push_back(Batch{ this->head, this->count });
+                    }
+                }
+            };
+
+            static inline thread_local Cache cache;
+
+            static Depot& depot(void) {
+                static Depot d;
+                return d;
+            }
+
+            /**
+             *  \brief  Fill the (empty) cache with a batch from the depot,
+             *          or with a newly allocated slab if the depot is empty.
+             */
+            static void refill(Cache& c) {
+                Depot& d = ObjectPool::depot();
+
+                {
+                    LOCK_BLOCK(d.lock);
+
+                    if (!d.batches.empty()) {
+                        const Batch b = d.batches.back();
+                        d.batches.pop_back();
+                        c.head  = b.head;
+                        c.count = b.count;
+                        return;
+                    }
+                }
+
+                auto slab = std::make_unique<Slot[]>(BatchSize);
+
+                for (size_t i = 0; i < BatchSize - 1; ++i) {
+                    slab[i].next = &slab[i + 1];
+                }
+                slab[BatchSize - 1].next = nullptr;
+
+                c.head  = slab.get();
+                c.count = BatchSize;
+
+                LOCK_BLOCK(d.lock);
+                d.slabs.emplace_back(std::move(slab));
+            }
+
+            /**
+             *  \brief  Move BatchSize slots from the cache to the depot.
+             */
+            static void release(Cache& c) {
+                Slot *head = c.head;
+                Slot *tail = head;
+
+                for (size_t i = 1; i < BatchSize; ++i) {
+                    tail = tail->next;
+                }
+
+                c.head   = tail->next;
+                c.count -= BatchSize;
+                tail->next = nullptr;
+
+                Depot& d = ObjectPool::depot();
+                LOCK_BLOCK(d.lock);
+                d.batches.push_back(Batch{ head, BatchSize });
+            }
+
+        public:
+            ObjectPool() = delete;
+
+            /**
+             *  \brief  Get uninitialised memory for a single T from the pool.
+             */
+            ATTR_NODISCARD HEDLEY_MALLOC
+            static T* allocate(void) {
+                Cache& c = ObjectPool::cache;
+
+                if (HEDLEY_UNLIKELY(c.head == nullptr)) {
+                    ObjectPool::refill(c);
+                }
+
+                Slot *s = c.head;
+                c.head = s->next;
+                --c.count;
+
+                return reinterpret_cast<T*>(s->storage);
+            }
+
+            /**
+             *  \brief  Return memory obtained with allocate() to the pool.
+             *          The object must already be destroyed.
+             */
+            static void deallocate(T *p) noexcept {
+                if (HEDLEY_UNLIKELY(p == nullptr)) {
+                    return;
+                }
+
+                Cache& c = ObjectPool::cache;
+                Slot  *s = reinterpret_cast<Slot*>(p);
+
+                s->next = c.head;
+                c.head  = s;
+
+                if (HEDLEY_UNLIKELY(++c.count >= 2 * BatchSize)) {
+                    ObjectPool::release(c);
+                }
+            }
+
+            /**
+             *  \brief  Allocate and construct a T from the pool.
+             *
+             *  \param  args
+             *      Variable argument list passed down to ctor of T.
+             */
+            template <class ...Args> ATTR_NODISCARD
+            static T* create(Args&& ...args) {
+                T *p = ObjectPool::allocate();
+
+                try {
+                    return ::new (static_cast<void*>(p)) T(std::forward<Args>(args)...);
+                } catch (...) {
+                    ObjectPool::deallocate(p);
+                    throw;
+                }
+            }
+
+            /**
+             *  \brief  Destroy and deallocate a T that was created with create().
+             */
+            static void destroy(T *p) {
+                if (p != nullptr) {
+                    p->~T();
+                    ObjectPool::deallocate(p);
+                }
+            }
+
+            /**
+             *  \brief  Return the total amount of slots allocated by the pool, over all threads.
+             */
+            static size_t capacity(void) {
+                Depot& d = ObjectPool::depot();
+                LOCK_BLOCK(d.lock);
+                return d.slabs.size() * BatchSize;
+            }
+    };
+
+    /**
+     *  \brief  STL-compatible allocator backed by ObjectPool<T>.
+     *          Single-object allocations (node based containers like std::list,
+     *          std::map...) come from the pool, others fall back to std::allocator.
+     */
+    template <class T>
+    struct PoolAllocator {
+        using value_type = T;
+
+        template <class U>
+        struct rebind {
+            using other = PoolAllocator<U>;
+        };
+
+        PoolAllocator() noexcept = default;
+
+        template <class U>
+        PoolAllocator(const PoolAllocator<U>&) noexcept {}
+
+        ATTR_NODISCARD
+        T* allocate(size_t n) {
+            if (HEDLEY_LIKELY(n == 1)) {
+                return utils::memory::ObjectPool<T>::allocate();
+            }
+
+            return std::allocator<T>().allocate(n);
+        }
+
+        void deallocate(T *p, size_t n) noexcept {
+            if (HEDLEY_LIKELY(n == 1)) {
+                utils::memory::ObjectPool<T>::deallocate(p);
+            } else {
+                std::allocator<T>().deallocate(p, n);
+            }
+        }
+
+        template <class U>
+        inline bool operator==(const PoolAllocator<U>&) const noexcept {
+            return true;
+        }
+
+        template <class U>
+        inline bool operator!=(const PoolAllocator<U>&) const noexcept {
+            return false;
+        }
+    };
+}
+
+#ifdef UTILS_MEMORY_ALLOC_LOG
+    #undef UTILS_MEMORY_ALLOC_LOG
+#endif
+#ifdef UTILS_MEMORY_NEW_LOG
+    #undef UTILS_MEMORY_NEW_LOG
+#endif
+#ifdef UTILS_MEMORY_SAMPLE_RATE
+    #undef UTILS_MEMORY_SAMPLE_RATE
 #endif
 #endif // UTILS_MEMORY_HPP
@@ -0,0 +1,708 @@
+#ifndef UTILS_SERIAL_HPP
+#define UTILS_SERIAL_HPP
+
+#include "utils_compiler.hpp"
+#include "utils_exceptions.hpp"
+#include "utils_bits.hpp"
+#include "utils_io.hpp"
+#include "utils_memory.hpp"
+#include "utils_traits.hpp"
+
+#include <array>
+#include <cstring>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <variant>
+#include <vector>
+
+
+/**
+ *  \brief  Declare the members serialized for a type, in order.
+ *          Needed for types that are not aggregates (constructors, base classes,
+ *          private members) or aggregates with C array members.
+ *
+ *  e.g.
+ *      struct Point {
+ *          int x, y;
+ *          UTILS_SERIAL_FIELDS(x, y)
+ *      };
+ */
+#define UTILS_SERIAL_FIELDS(...) \
+    auto serial_fields(void)       { return std::tie(__VA_ARGS__); } \
+    auto serial_fields(void) const { return std::tie(__VA_ARGS__); }
+
+
+/*
+ *  Compact binary serialization with compile time reflection.
+ *
+ *  Layout (little endian, byte aligned):
+ *      bool, 1 byte integers       1 byte
+ *      other integers, enums       LEB128 varint, zigzag for signed
+ *      float, double               IEEE 754, little endian
+ *      strings, containers, maps   LEB128 element count, elements (pairs for maps)
+ *      std::array, C arrays        elements
+ *      pair, tuple                 elements
+ *      std::optional               1 byte presence, value
+ *      std::variant                LEB128 index, value
+ *      fixed layout structs        raw bytes (see below)
+ *      structs                     fields in declaration order
+ *
+ *  Structs are reflected automatically when they are aggregates (up to
+ *  MAX_FIELDS fields, through structured bindings), otherwise their fields are
+ *  listed with UTILS_SERIAL_FIELDS().
+ *
+ *  Versioning: a struct with a `static constexpr uint32_t serial_version` is written
+ *  as LEB128 version, LEB128 payload size and its fields. Fields may only be
+ *  appended: older readers skip the trailing fields they do not know, newer readers
+ *  leave the fields missing from older data at their default value. After reading,
+ *  `void serial_upgrade(uint32_t stored_version)` is called if the struct has one.
+ *
+ *  Fixed layout: a trivially copyable struct with `static constexpr bool
+ *  serial_fixed_layout = true` is written as its object representation. Arrays of
+ *  fixed layout types (and floats) can then be accessed in place, e.g. from a
+ *  mapped file, with Reader::view_array(). The layout is that of a little endian
+ *  host, so fixed layout types can only be written and read on one.
+ */
+namespace utils::io::serial {
+    static constexpr size_t MAX_FIELDS = 16;
+
+    namespace internal {
+        template <class T> struct is_std_array : std::false_type { };
+        template <class T, size_t N> struct is_std_array<std::array<T, N>> : std::true_type { };
+
+        template <class T> struct is_optional : std::false_type { };
+        template <class T> struct is_optional<std::optional<T>> : std::true_type { };
+
+        template <class T> struct is_variant : std::false_type { };
+        template <class... T> struct is_variant<std::variant<T...>> : std::true_type { };
+
+        template <class T> struct is_tuple : std::false_type { };
+        template <class... T> struct is_tuple<std::tuple<T...>> : std::true_type { };
+        template <class T, class U> struct is_tuple<std::pair<T, U>> : std::true_type { };
+
+        template <class T> struct is_string : std::false_type { };
+        template <class C, class Tr, class A> struct is_string<std::basic_string<C, Tr, A>> : std::true_type { };
+
+        template <class T>
+        using serial_fields_r = decltype(std::declval<T&>().serial_fields());
+
+        template <class T>
+        using serial_version_r = decltype(T::serial_version);
+
+        template <class T>
+        using serial_upgrade_r = decltype(std::declval<T&>().serial_upgrade(uint32_t()));
+
+        template <class T>
+        using reserve_r = decltype(std::declval<T&>().reserve(size_t()));
+
+        template <class T>
+        inline constexpr bool has_serial_fields_v = utils::traits::can_apply<serial_fields_r, T>::value;
+
+        template <class T>
+        inline constexpr bool has_serial_version_v = utils::traits::can_apply<serial_version_r, T>::value;
+
+        template <class T, class = void>
+        struct is_fixed_layout : std::false_type { };
+
+        template <class T>
+        struct is_fixed_layout<T, std::void_t<decltype(T::serial_fixed_layout)>>
+            : std::bool_constant<T::serial_fixed_layout>
+        {
+            static_assert(!T::serial_fixed_layout || std::is_trivially_copyable_v<T>,
+                          "utils::io::serial: Fixed layout types must be trivially copyable.");
+        };
+
+        /**
+         *  Types stored as their object representation (little endian), which can be
+         *  viewed in place.
+         */
+        template <class T>
+        inline constexpr bool is_raw_v = std::is_floating_point_v<T> || is_fixed_layout<T>::value
+                                      || (std::is_integral_v<T> && sizeof(T) == 1 && !std::is_same_v<T, bool>);
+
+        /**
+         *  Vectors of raw values, copied in bulk on little endian hosts.
+         */
+        template <class T> struct is_raw_vector : std::false_type { };
+        template <class T, class A> struct is_raw_vector<std::vector<T, A>>
+            : std::bool_constant<!utils::bits::is_big_endian && is_raw_v<T>> { };
+
+        /**
+         *  Converts to anything, to count the fields of an aggregate.
+         */
+        struct any_field {
+            template <class T>
+            operator T() const;
+        };
+
+        template <class T, class Seq, class = void>
+        struct is_initializable_with : std::false_type { };
+
+        template <class T, size_t... I>
+        struct is_initializable_with<T, std::index_sequence<I...>,
+                                     std::void_t<decltype(T{ (void(I), any_field{})... })>> : std::true_type { };
+
+        /**
+         *  \brief  Number of fields of the aggregate T: the most initializers it accepts.
+         */
+        template <class T, size_t N = MAX_FIELDS>
+        static constexpr size_t field_count(void) {
+            if constexpr (N == 0) {
+                return 0;
+            } else if constexpr (is_initializable_with<T, std::make_index_sequence<N>>::value) {
+                return N;
+            } else {
+                return field_count<T, N - 1>();
+            }
+        }
+
+        template <class T>
+        inline constexpr bool is_reflectable_v = std::is_aggregate_v<T> && !std::is_array_v<T>;
+
+        /**
+         *  \brief  Call \p f on each field of \p value, in declaration order.
+         */
+        template <class T, class F>
+        static inline void for_each_field(T& value, F&& f) {
+            using U = std::remove_const_t<T>;
+
+            if constexpr (has_serial_fields_v<T>) {
+                std::apply([&f](auto&... fields) { (f(fields), ...); }, value.serial_fields());
+            } else {
+                static_assert(is_reflectable_v<U>,
+                              "utils::io::serial: Type is not serializable, declare its fields with UTILS_SERIAL_FIELDS().");
+                constexpr size_t count = field_count<U>();
+                static_assert(count > 0 && count <= MAX_FIELDS,
+                              "utils::io::serial: Unsupported number of fields, use UTILS_SERIAL_FIELDS().");
+
+                if constexpr (count == 1) {
+                    auto& [f0] = value;
+                    f(f0);
+                } else if constexpr (count == 2) {
+                    auto& [f0, f1] = value;
+                    f(f0); f(f1);
+                } else if constexpr (count == 3) {
+                    auto& [f0, f1, f2] = value;
+                    f(f0); f(f1); f(f2);
+                } else if constexpr (count == 4) {
+                    auto& [f0, f1, f2, f3] = value;
+                    f(f0); f(f1); f(f2); f(f3);
+                } else if constexpr (count == 5) {
+                    auto& [f0, f1, f2, f3, f4] = value;
+                    f(f0); f(f1); f(f2); f(f3); f(f4);
+                } else if constexpr (count == 6) {
+                    auto& [f0, f1, f2, f3, f4, f5] = value;
+                    f(f0); f(f1); f(f2); f(f3); f(f4); f(f5);
+                } else if constexpr (count == 7) {
+                    auto& [f0, f1, f2, f3, f4, f5, f6] = value;
+                    f(f0); f(f1); f(f2); f(f3); f(f4); f(f5); f(f6);
+                } else if constexpr (count == 8) {
+                    auto& [f0, f1, f2, f3, f4, f5, f6, f7] = value;
+                    f(f0); f(f1); f(f2); f(f3); f(f4); f(f5); f(f6); f(f7);
+                } else if constexpr (count == 9) {
+                    auto& [f0, f1, f2, f3, f4, f5, f6, f7, f8] = value;
+                    f(f0); f(f1); f(f2); f(f3); f(f4); f(f5); f(f6); f(f7); f(f8);
+                } else if constexpr (count == 10) {
+                    auto& [f0, f1, f2, f3, f4, f5, f6, f7, f8, f9] = value;
+                    f(f0); f(f1); f(f2); f(f3); f(f4); f(f5); f(f6); f(f7); f(f8); f(f9);
+                } else if constexpr (count == 11) {
+                    auto& [f0, f1, f2, f3, f4, f5, f6, f7, f8, f9, f10] = value;
+                    f(f0); f(f1); f(f2); f(f3); f(f4); f(f5); f(f6); f(f7); f(f8); f(f9); f(f10);
+                } else if constexpr (count == 12) {
+                    auto& [f0, f1, f2, f3, f4, f5, f6, f7, f8, f9, f10, f11] = value;
+                    f(f0); f(f1); f(f2); f(f3); f(f4); f(f5); f(f6); f(f7); f(f8); f(f9); f(f10); f(f11);
+                } else if constexpr (count == 13) {
+                    auto& [f0, f1, f2, f3, f4, f5, f6, f7, f8, f9, f10, f11, f12] = value;
+                    f(f0); f(f1); f(f2); f(f3); f(f4); f(f5); f(f6); f(f7); f(f8); f(f9); f(f10); f(f11); f(f12);
+                } else if constexpr (count == 14) {
+                    auto& [f0, f1, f2, f3, f4, f5, f6, f7, f8, f9, f10, f11, f12, f13] = value;
+                    f(f0); f(f1); f(f2); f(f3); f(f4); f(f5); f(f6); f(f7); f(f8); f(f9); f(f10); f(f11); f(f12);
+                    f(f13);
+                } else if constexpr (count == 15) {
+                    auto& [f0, f1, f2, f3, f4, f5, f6, f7, f8, f9, f10, f11, f12, f13, f14] = value;
+                    f(f0); f(f1); f(f2); f(f3); f(f4); f(f5); f(f6); f(f7); f(f8); f(f9); f(f10); f(f11); f(f12);
+                    f(f13); f(f14);
+                } else {
+                    auto& [f0, f1, f2, f3, f4, f5, f6, f7, f8, f9, f10, f11, f12, f13, f14, f15] = value;
+                    f(f0); f(f1); f(f2); f(f3); f(f4); f(f5); f(f6); f(f7); f(f8); f(f9); f(f10); f(f11); f(f12);
+                    f(f13); f(f14); f(f15);
+                }
+            }
+        }
+
+        template <class T>
+        static inline void check_raw_host(void) {
+            static_assert(!is_fixed_layout<T>::value || !utils::bits::is_big_endian,
+                          "utils::io::serial: Fixed layout types require a little endian host.");
+        }
+    }
+
+    /**
+     *  \brief  In place view of an array of raw values (floats, 1 byte integers or
+     *          fixed layout structs), e.g. inside a mapped file.
+     *          Elements are copied out on access, so the data needs no alignment.
+     */
+    template <class T>
+    class ArrayView {
+        private:
+            const uint8_t *data = nullptr;
+            size_t count = 0;
+
+        public:
+            ArrayView() = default;
+
+            ArrayView(const uint8_t *array_data, size_t array_count) : data(array_data), count(array_count) { }
+
+            inline size_t size(void) const {
+                return this->count;
+            }
+
+            inline bool empty(void) const {
+                return this->count == 0;
+            }
+
+            /**
+             *  \brief  The underlying bytes (size() * sizeof(T)).
+             */
+            inline const uint8_t* bytes(void) const {
+                return this->data;
+            }
+
+            inline T operator[](size_t i) const {
+                if constexpr (std::is_floating_point_v<T>) {
+                    using uint_t = utils::bits::uint_of_size_t<sizeof(T)>;
+                    return utils::memory::bit_cast<T>(utils::bits::load_little_endian<uint_t>(this->data + i * sizeof(T)));
+                } else {
+                    internal::check_raw_host<T>();
+                    T value;
+                    std::memcpy(&value, this->data + i * sizeof(T), sizeof(T));
+                    return value;
+                }
+            }
+
+            std::vector<T> to_vector(void) const {
+                std::vector<T> out(this->count);
+                for (size_t i = 0; i < this->count; i++) {
+                    out[i] = (*this)[i];
+                }
+                return out;
+            }
+    };
+
+    /**
+     *  \brief  Serializes values into a growing byte buffer.
+     */
+    class Writer {
+        private:
+            std::vector<uint8_t> bytes;
+
+            template <class T>
+            inline void write_raw(const T& value) {
+                if constexpr (std::is_floating_point_v<T>) {
+                    using uint_t = utils::bits::uint_of_size_t<sizeof(T)>;
+                    uint8_t buffer[sizeof(T)];
+                    utils::bits::store_little_endian(buffer, utils::memory::bit_cast<uint_t>(value));
+                    this->write_bytes(buffer, sizeof(T));
+                } else {
+                    internal::check_raw_host<T>();
+                    this->write_bytes(&value, sizeof(T));
+                }
+            }
+
+            template <class T>
+            void write_fields(const T& value) {
+                internal::for_each_field(value, [this](const auto& field) {
+                    this->write(field);
+                });
+            }
+
+        public:
+            Writer() = default;
+
+            explicit Writer(size_t capacity) {
+                this->bytes.reserve(capacity);
+            }
+
+            inline const uint8_t* data(void) const {
+                return this->bytes.data();
+            }
+
+            inline size_t size(void) const {
+                return this->bytes.size();
+            }
+
+            inline const std::vector<uint8_t>& get_bytes(void) const {
+                return this->bytes;
+            }
+
+            /**
+             *  \brief  Move the written bytes out, leaving the writer empty.
+             */
+            inline std::vector<uint8_t> release(void) {
+                return std::exchange(this->bytes, {});
+            }
+
+            inline void write_bytes(const void *src, size_t n) {
+                const uint8_t *p = static_cast<const uint8_t*>(src);
+                this->bytes.insert(this->bytes.end(), p, p + n);
+            }
+
+            void put_varint(uint64_t value) {
+                while (value >= 0x80u) {
+                    this->bytes.push_back(uint8_t(value | 0x80u));
+                    value >>= 7u;
+                }
+                this->bytes.push_back(uint8_t(value));
+            }
+
+            /**
+             *  \brief  Serialize \p value, see the layout above.
+             */
+            template <class T>
+            void write(const T& value) {
+                if constexpr (std::is_same_v<T, bool>) {
+                    this->bytes.push_back(uint8_t(value));
+                } else if constexpr (std::is_enum_v<T>) {
+                    this->write(utils::traits::to_underlying(value));
+                } else if constexpr (internal::is_raw_v<T>) {
+                    this->write_raw(value);
+                } else if constexpr (std::is_integral_v<T> && std::is_signed_v<T>) {
+                    this->put_varint(utils::bits::zigzag_encode(int64_t(value)));
+                } else if constexpr (std::is_integral_v<T>) {
+                    this->put_varint(uint64_t(value));
+                } else if constexpr (internal::is_string<T>::value) {
+                    this->put_varint(value.size());
+                    this->write_bytes(value.data(), value.size() * sizeof(typename T::value_type));
+                } else if constexpr (internal::is_optional<T>::value) {
+                    this->write(value.has_value());
+                    if (value) {
+                        this->write(*value);
+                    }
+                } else if constexpr (internal::is_variant<T>::value) {
+                    this->put_varint(value.index());
+                    std::visit([this](const auto& alternative) { this->write(alternative); }, value);
+                } else if constexpr (internal::is_tuple<T>::value) {
+                    std::apply([this](const auto&... elements) { (this->write(elements), ...); }, value);
+                } else if constexpr (std::is_array_v<T> || internal::is_std_array<T>::value) {
+                    for (const auto& element : value) {
+                        this->write(element);
+                    }
+                } else if constexpr (internal::is_raw_vector<T>::value) {
+                    this->put_varint(value.size());
+                    this->write_bytes(value.data(), value.size() * sizeof(typename T::value_type));
+                } else if constexpr (utils::traits::is_maplike_v<T>) {
+                    this->put_varint(value.size());
+                    for (const auto& [key, mapped] : value) {
+                        this->write(key);
+                        this->write(mapped);
+                    }
+                } else if constexpr (utils::traits::is_iterable_v<T>) {
+                    this->put_varint(size_t(std::distance(std::begin(value), std::end(value))));
+                    for (const auto& element : value) {
+                        this->write(element);
+                    }
+                } else if constexpr (internal::has_serial_version_v<T>) {
+                    Writer payload;
+                    payload.write_fields(value);
+                    this->put_varint(T::serial_version);
+                    this->put_varint(payload.size());
+                    this->write_bytes(payload.data(), payload.size());
+                } else {
+                    this->write_fields(value);
+                }
+            }
+    };
+
+    /**
+     *  \brief  Deserializes values from a byte range, which must outlive the reader.
+     *
+     *  \exception  Exception
+     *      Reading throws Exception on truncated or malformed data.
+     */
+    class Reader {
+        private:
+            const uint8_t *current = nullptr;
+            const uint8_t *end     = nullptr;
+
+            ATTR_NORETURN
+            static void error(const std::string& msg) {
+                throw utils::exceptions::Exception("utils::io::serial::Reader", msg);
+            }
+
+            template <class T>
+            inline void read_raw(T& value) {
+                const uint8_t *p = this->take(sizeof(T));
+
+                if constexpr (std::is_floating_point_v<T>) {
+                    using uint_t = utils::bits::uint_of_size_t<sizeof(T)>;
+                    value = utils::memory::bit_cast<T>(utils::bits::load_little_endian<uint_t>(p));
+                } else {
+                    internal::check_raw_host<T>();
+                    std::memcpy(&value, p, sizeof(T));
+                }
+            }
+
+            template <class T>
+            void read_fields(T& value) {
+                internal::for_each_field(value, [this](auto& field) {
+                    this->read(field);
+                });
+            }
+
+            /**
+             *  \brief  Element count, bounded by the remaining bytes (elements take at least one).
+             */
+            inline size_t get_count(size_t min_element_size = 1) {
+                const uint64_t count = this->get_varint();
+
+                if (HEDLEY_UNLIKELY(min_element_size > 0 && count > this->remaining() / min_element_size)) {
+                    error("Element count exceeds the data.");
+                }
+
+                return size_t(count);
+            }
+
+            template <class V, size_t I = 0>
+            void read_variant(V& value, size_t index) {
+                if constexpr (I < std::variant_size_v<V>) {
+                    if (index == I) {
+                        std::variant_alternative_t<I, V> alternative{};
+                        this->read(alternative);
+                        value.template emplace<I>(std::move(alternative));
+                    } else {
+                        this->read_variant<V, I + 1>(value, index);
+                    }
+                } else {
+                    error("Invalid variant index.");
+                }
+            }
+
+        public:
+            Reader(const void *data, size_t size)
+                : current(static_cast<const uint8_t*>(data)), end(static_cast<const uint8_t*>(data) + size) { }
+
+            explicit Reader(const std::vector<uint8_t>& data) : Reader(data.data(), data.size()) { }
+
+            explicit Reader(const std::string_view data) : Reader(data.data(), data.size()) { }
+
+            explicit Reader(const MappedFile& file) : Reader(file.data(), file.size()) { }
+
+            inline size_t remaining(void) const {
+                return size_t(this->end - this->current);
+            }
+
+            inline const uint8_t* position(void) const {
+                return this->current;
+            }
+
+            /**
+             *  \brief  Consume \p n bytes.
+             *  \return Pointer to the consumed bytes.
+             */
+            inline const uint8_t* take(size_t n) {
+                if (HEDLEY_UNLIKELY(n > this->remaining())) {
+                    error("Unexpected end of data.");
+                }
+
+                const uint8_t *p = this->current;
+                this->current += n;
+                return p;
+            }
+
+            inline void read_bytes(void *dst, size_t n) {
+                std::memcpy(dst, this->take(n), n);
+            }
+
+            uint64_t get_varint(void) {
+                uint64_t value = 0;
+
+                for (uint_fast32_t shift = 0; shift < 64u; shift += 7u) {
+                    const uint64_t byte = *this->take(1);
+                    value |= (byte & 0x7Fu) << shift;
+
+                    if (!(byte & 0x80u)) {
+                        return value;
+                    }
+                }
+
+                error("Varint too long.");
+            }
+
+            /**
+             *  \brief  Deserialize into \p value, see the layout above.
+             */
+            template <class T>
+            void read(T& value) {
+                if constexpr (std::is_same_v<T, bool>) {
+                    value = *this->take(1) != 0;
+                } else if constexpr (std::is_enum_v<T>) {
+                    std::underlying_type_t<T> underlying;
+                    this->read(underlying);
+                    value = T(underlying);
+                } else if constexpr (internal::is_raw_v<T>) {
+                    this->read_raw(value);
+                } else if constexpr (std::is_integral_v<T> && std::is_signed_v<T>) {
+                    value = T(utils::bits::zigzag_decode(this->get_varint()));
+                } else if constexpr (std::is_integral_v<T>) {
+                    value = T(this->get_varint());
+                } else if constexpr (internal::is_string<T>::value) {
+                    using char_t = typename T::value_type;
+                    value.resize(this->get_count(sizeof(char_t)));
+                    this->read_bytes(&value[0], value.size() * sizeof(char_t));
+                } else if constexpr (internal::is_optional<T>::value) {
+                    if (*this->take(1)) {
+                        typename T::value_type contained{};
+                        this->read(contained);
+                        value = std::move(contained);
+                    } else {
+                        value.reset();
+                    }
+                } else if constexpr (internal::is_variant<T>::value) {
+                    this->read_variant(value, size_t(this->get_varint()));
+                } else if constexpr (internal::is_tuple<T>::value) {
+                    std::apply([this](auto&... elements) { (this->read(elements), ...); }, value);
+                } else if constexpr (std::is_array_v<T> || internal::is_std_array<T>::value) {
+                    for (auto& element : value) {
+                        this->read(element);
+                    }
+                } else if constexpr (internal::is_raw_vector<T>::value) {
+                    using element_t = typename T::value_type;
+                    value.resize(this->get_count(sizeof(element_t)));
+                    this->read_bytes(value.data(), value.size() * sizeof(element_t));
+                } else if constexpr (utils::traits::is_maplike_v<T>) {
+                    const size_t count = this->get_count();
+                    value.clear();
+                    for (size_t i = 0; i < count; i++) {
+                        typename T::key_type    key{};
+                        typename T::mapped_type mapped{};
+                        this->read(key);
+                        this->read(mapped);
+                        value.emplace(std::move(key), std::move(mapped));
+                    }
+                } else if constexpr (utils::traits::is_iterable_v<T>) {
+                    const size_t count = this->get_count();
+                    value.clear();
+                    if constexpr (utils::traits::can_apply<internal::reserve_r, T>::value) {
+                        value.reserve(count);
+                    }
+                    for (size_t i = 0; i < count; i++) {
+                        typename T::value_type element{};
+                        this->read(element);
+                        value.insert(value.end(), std::move(element));
+                    }
+                } else if constexpr (internal::has_serial_version_v<T>) {
+                    const uint64_t version = this->get_varint();
+                    const size_t size = size_t(this->get_varint());
+                    Reader payload(this->take(size), size);
+
+                    // Fields missing from older versions keep their defaults
+                    internal::for_each_field(value, [&payload](auto& field) {
+                        if (payload.remaining() > 0) {
+                            payload.read(field);
+                        }
+                    });
+
+                    if constexpr (utils::traits::can_apply<internal::serial_upgrade_r, T>::value) {
+                        value.serial_upgrade(uint32_t(version));
+                    }
+                } else {
+                    this->read_fields(value);
+                }
+            }
+
+            template <class T>
+            T read(void) {
+                T value{};
+                this->read(value);
+                return value;
+            }
+
+            /**
+             *  \brief  View a std::vector<T> of raw values in place, without copying it.
+             */
+            template <class T>
+            ArrayView<T> view_array(void) {
+                static_assert(internal::is_raw_v<T>, "utils::io::serial: view_array requires a raw element type.");
+                const size_t count = this->get_count(sizeof(T));
+                return ArrayView<T>(this->take(count * sizeof(T)), count);
+            }
+
+            /**
+             *  \brief  A fixed layout value, copied out of the data with bit_cast.
+             */
+            template <class T>
+            T view(void) {
+                static_assert(internal::is_raw_v<T>, "utils::io::serial: view requires a raw type.");
+                return ArrayView<T>(this->take(sizeof(T)), 1)[0];
+            }
+    };
+
+    /**
+     *  \brief  Serialize \p value into a new buffer.
+     */
+    template <class T> ATTR_MAYBE_UNUSED ATTR_NODISCARD
+    static inline std::vector<uint8_t> serialize(const T& value) {
+        Writer writer;
+        writer.write(value);
+        return writer.release();
+    }
+
+    /**
+     *  \brief  Serialize \p value into a bit stream at its current position.
+     */
+    template <class T, class Order> ATTR_MAYBE_UNUSED
+    static inline void serialize(const T& value, BasicBitStreamWriter<Order>& stream) {
+        Writer writer;
+        writer.write(value);
+        stream.write_bytes(writer.data(), writer.size());
+    }
+
+    /**
+     *  \brief  Deserialize a T from \p size bytes at \p data.
+     *  \exception  Exception
+     *      Throws Exception on truncated or malformed data.
+     */
+    template <class T> ATTR_MAYBE_UNUSED ATTR_NODISCARD
+    static inline T deserialize(const void *data, size_t size) {
+        Reader reader(data, size);
+        return reader.read<T>();
+    }
+
+    template <class T> ATTR_MAYBE_UNUSED ATTR_NODISCARD
+    static inline T deserialize(const std::vector<uint8_t>& data) {
+        return utils::io::serial::deserialize<T>(data.data(), data.size());
+    }
+
+    /**
+     *  \brief  Deserialize a T from a bit stream at its current position, and advance it.
+     *          Reads in place when the position is byte aligned.
+     *  \exception  Exception
+     *      Throws Exception on truncated or malformed data.
+     */
+    template <class T, class Order> ATTR_MAYBE_UNUSED ATTR_NODISCARD
+    static inline T deserialize(BasicBitStreamReader<Order>& stream) {
+        const size_t position = stream.get_position();
+        const size_t length   = (stream.get_size_bits() - std::min(position, stream.get_size_bits())) / 8u;
+
+        if (position % 8u == 0) {
+            Reader reader(stream.get_buffer() + position / 8u, length);
+            T value = reader.read<T>();
+            stream.set_position(position + (length - reader.remaining()) * 8u);
+            return value;
+        }
+
+        std::vector<uint8_t> bytes(length);
+        stream.read_bytes(bytes.data(), length);
+
+        Reader reader(bytes);
+        T value = reader.read<T>();
+        stream.set_position(position + (length - reader.remaining()) * 8u);
+        return value;
+    }
+}
+
+#endif // UTILS_SERIAL_HPP
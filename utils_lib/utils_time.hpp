@@ -10,6 +10,12 @@
 #include <functional>
 #include <thread>
 
+#if defined(UTILS_COMPILER_MSVC)
+    #include <intrin.h>
+#elif defined(__x86_64__) || defined(__i386__)
+    #include <x86intrin.h>
+#endif
+
 namespace utils::time {
     /**
      *  Chrono time ranges aliases
@@ -73,6 +79,27 @@ namespace utils::time {
             }
         };
 
+        /**
+         *  \brief  Return the processor's time stamp counter.
+         *
+         *          On x86 this counts at the nominal clock rate (invariant TSC), on
+         *          AArch64 it is the virtual counter, elsewhere it falls back to the
+         *          steady clock in ns. Only differences on one machine are meaningful.
+         */
+        ATTR_MAYBE_UNUSED ATTR_NODISCARD
+        static inline uint64_t Cycles(void) {
+            #if defined(UTILS_COMPILER_MSVC) || defined(__x86_64__) || defined(__i386__)
+                return __rdtsc();
+            #elif defined(__aarch64__)
+                uint64_t count;
+                asm volatile("mrs %0, cntvct_el0" : "=r"(count));
+                return count;
+            #else
+                return uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                    std::chrono::steady_clock::now().time_since_epoch()).count());
+            #endif
+        }
+
         /**
          *  \brief  Time the execution of \p f, with \p duration_struct resolution.
          *
@@ -137,6 +164,25 @@ namespace utils::time {
 
             return total_time / double(N);
         }
+
+        /**
+         *  \brief  Count the Cycles() elapsed executing \p f.
+         *
+         *  \param  f
+         *      The function to execute and time.
+         *  \param  args
+         *      The arguments to pass to \p f.
+         *  \return Returns the difference of Cycles() after and before \p f.
+         */
+        template<class F, class... Args> ATTR_MAYBE_UNUSED
+        static inline uint64_t time_cycles(F&& f, Args&& ... args) {
+            static_assert(utils::traits::is_invocable_v<F, Args...>,
+                          "utils::time::Timer::time_cycles: Callable function required.");
+
+            const uint64_t start = utils::time::Timer::Cycles();
+            std::invoke(std::forward<F>(f), std::forward<Args>(args)...);
+            return utils::time::Timer::Cycles() - start;
+        }
     }
 
     /**
@@ -0,0 +1,174 @@
+#include "test_settings.hpp"
+
+#ifdef ENABLE_TESTS
+#include "../utils_lib/external/doctest.hpp"
+
+#include "../utils_lib/utils_aio.hpp"
+#include "../utils_lib/utils_io.hpp"
+
+#include <numeric>
+
+#if defined(UTILS_OS_LINUX) || defined(UTILS_OS_MAC)
+
+static void test_async_io(utils::io::aio::AsyncIO& aio) {
+    utils::io::TemporaryFile t(false, "", "", "", "");
+
+    std::vector<uint8_t> data(100000);
+    std::iota(data.begin(), data.end(), uint8_t(0));
+
+    SUBCASE("Test utils::io::aio::AsyncIO write and read") {
+        auto file = utils::io::aio::File::open(t.get_name(), utils::io::aio::Mode::ReadWrite);
+
+        std::vector<std::future<size_t>> writes;
+        for (size_t offset = 0; offset < data.size(); offset += 10000) {
+            writes.push_back(aio.write(file.get(), data.data() + offset, 10000, offset));
+        }
+        for (auto& w : writes) {
+            CHECK(w.get() == 10000);
+        }
+
+        std::vector<uint8_t> out(data.size() + 100);
+        CHECK(aio.read(file.get(), out.data(), out.size(), 0).get() == data.size());
+        out.resize(data.size());
+        CHECK(out == data);
+    }
+
+    SUBCASE("Test utils::io::aio::AsyncIO writev, readv and batches") {
+        auto file = utils::io::aio::File::open(t.get_name(), utils::io::aio::Mode::ReadWrite);
+
+        std::vector<iovec> parts;
+        for (size_t offset = 0; offset < data.size(); offset += 30000) {
+            parts.push_back({ data.data() + offset, std::min<size_t>(30000, data.size() - offset) });
+        }
+        CHECK(aio.writev(file.get(), parts, 0).get() == data.size());
+
+        std::vector<uint8_t> head(1000), tail(1000);
+        CHECK(aio.readv(file.get(), { { head.data(), head.size() }, { tail.data(), tail.size() } }, 5000).get() == 2000);
+        CHECK(std::equal(head.begin(), head.end(), data.begin() + 5000));
+        CHECK(std::equal(tail.begin(), tail.end(), data.begin() + 6000));
+
+        std::vector<utils::io::aio::Operation> ops;
+        std::vector<std::vector<uint8_t>> blocks(10, std::vector<uint8_t>(100));
+        for (size_t i = 0; i < blocks.size(); i++) {
+            ops.push_back({ file.get(), { { blocks[i].data(), blocks[i].size() } }, i * 100, false });
+        }
+
+        auto results = aio.submit(std::move(ops));
+        for (size_t i = 0; i < blocks.size(); i++) {
+            CHECK(results[i].get() == 100);
+            CHECK(std::equal(blocks[i].begin(), blocks[i].end(), data.begin() + i * 100));
+        }
+    }
+
+    SUBCASE("Test utils::io::aio::AsyncIO callbacks and errors") {
+        auto file = utils::io::aio::File::open(t.get_name(), utils::io::aio::Mode::Write);
+
+        std::atomic<size_t> written{0};
+        for (size_t offset = 0; offset < data.size(); offset += 1000) {
+            aio.write(file.get(), data.data() + offset, 1000, offset, [&](utils::io::aio::result_t r) {
+                written += size_t(r);
+            });
+        }
+        aio.wait_all();
+        CHECK(written == data.size());
+        CHECK(*utils::io::file_to_bytes(t.get_name()) == data);
+
+        // A throwing callback still completes, wait_all() rethrows once
+        for (size_t i = 0; i < 3; i++) {
+            aio.write(file.get(), data.data(), 10, 0, [](utils::io::aio::result_t) {
+                throw utils::exceptions::Exception("test", "callback");
+            });
+        }
+        CHECK_THROWS_AS(aio.wait_all(), utils::exceptions::Exception);
+        CHECK_NOTHROW(aio.wait_all());
+
+        // Reading a write only descriptor fails
+        uint8_t byte;
+        auto failed = aio.read(file.get(), &byte, 1, 0);
+        CHECK_THROWS_AS(failed.get(), utils::exceptions::Exception);
+
+        CHECK_THROWS_AS(utils::io::aio::File::open(t.get_name() + "_missing", utils::io::aio::Mode::Read),
+                        utils::exceptions::FileReadException);
+    }
+
+    SUBCASE("Test utils::io::aio::AsyncIO registered buffers") {
+        auto file   = utils::io::aio::File::open(t.get_name(), utils::io::aio::Mode::ReadWrite);
+        auto buffer = utils::memory::new_unique_buffer<uint8_t>(2 * utils::io::aio::DIRECT_ALIGNMENT);
+
+        std::copy(data.begin(), data.begin() + utils::io::aio::DIRECT_ALIGNMENT, buffer.get());
+        aio.register_buffers({ { buffer.get(), 2 * utils::io::aio::DIRECT_ALIGNMENT } });
+
+        CHECK(aio.write_fixed(file.get(), 0, 1000, 0).get() == 1000);
+        CHECK(aio.read_fixed(file.get(), 0, 1000, 0, utils::io::aio::DIRECT_ALIGNMENT).get() == 1000);
+        CHECK(std::equal(data.begin(), data.begin() + 1000, buffer.get() + utils::io::aio::DIRECT_ALIGNMENT));
+
+        CHECK_THROWS_AS(aio.write_fixed(file.get(), 1, 10, 0), utils::exceptions::Exception);
+        CHECK_THROWS_AS(aio.write_fixed(file.get(), 0, 10, 0, 2 * utils::io::aio::DIRECT_ALIGNMENT),
+                        utils::exceptions::Exception);
+
+        aio.register_buffers({});
+    }
+
+    SUBCASE("Test utils::io::aio::AsyncIO write_file and direct I/O") {
+        CHECK(aio.write_file(t.get_name(), data).get() == data.size());
+        CHECK(*utils::io::file_to_bytes(t.get_name()) == data);
+
+        auto file   = utils::io::aio::File::open(t.get_name(), utils::io::aio::Mode::Read, true);
+        auto buffer = utils::memory::new_unique_buffer<uint8_t>(utils::io::aio::DIRECT_ALIGNMENT);
+
+        CHECK(aio.read(file.get(), buffer.get(), utils::io::aio::DIRECT_ALIGNMENT, utils::io::aio::DIRECT_ALIGNMENT).get()
+              == utils::io::aio::DIRECT_ALIGNMENT);
+        CHECK(std::equal(buffer.get(), buffer.get() + utils::io::aio::DIRECT_ALIGNMENT,
+                         data.begin() + utils::io::aio::DIRECT_ALIGNMENT));
+    }
+}
+
+TEST_CASE("Test utils::io::aio::AsyncIO thread pool") {
+    utils::io::aio::AsyncIO aio(64, utils::io::aio::Backend::ThreadPool);
+    CHECK_FALSE(aio.uses_io_uring());
+    test_async_io(aio);
+}
+
+TEST_CASE("Test utils::io::aio::AsyncIO auto") {
+    // io_uring when the kernel allows it
+    utils::io::aio::AsyncIO aio(8);
+    test_async_io(aio);
+}
+
+#if defined(UTILS_OS_LINUX)
+TEST_CASE("Test utils::io::aio::AsyncIO io_uring submit failure") {
+    utils::io::aio::AsyncIO aio(8);
+    if (!aio.uses_io_uring()) {
+        return;
+    }
+
+    // Replace the ring with /dev/null, so io_uring_enter fails
+    int ring = -1;
+    for (const auto& entry : utils::io::fs::directory_iterator("/proc/self/fd")) {
+        std::error_code ec;
+        if (utils::io::fs::read_symlink(entry.path(), ec).string() == "anon_inode:[io_uring]") {
+            ring = std::stoi(entry.path().filename().string());
+        }
+    }
+    REQUIRE(ring >= 0);
+
+    const int null = ::open("/dev/null", O_RDWR | O_CLOEXEC);
+    REQUIRE(::dup2(null, ring) == ring);
+    ::close(null);
+
+    utils::io::TemporaryFile t(false, "", "", "", "");
+    auto file = utils::io::aio::File::open(t.get_name(), utils::io::aio::Mode::ReadWrite);
+    const std::string data = "submit failure";
+
+    // Unsubmitted requests fail, later ones run on the thread pool
+    auto failed = aio.write(file.get(), data.data(), data.size(), 0);
+    CHECK_THROWS_AS(failed.get(), utils::exceptions::Exception);
+
+    CHECK(aio.write(file.get(), data.data(), data.size(), 0).get() == data.size());
+    aio.wait_all();
+    CHECK(*utils::io::file_to_string(t.get_name()) == data);
+}
+#endif
+
+#endif
+#endif
@@ -0,0 +1,188 @@
+#include "test_settings.hpp"
+
+#ifdef ENABLE_TESTS
+#include "../utils_lib/external/doctest.hpp"
+
+#include "../utils_lib/algo/algo_ans.hpp"
+#include "../utils_lib/algo/algo_huffman.hpp"
+
+#include <numeric>
+#include <string>
+
+static std::vector<uint8_t> rans_encode(const std::vector<uint8_t>& data,
+                                        size_t block_size = utils::algo::RANS::DEFAULT_BLOCK_SIZE)
+{
+    utils::io::BitStreamReader reader(data);
+    utils::algo::RANS encoder(block_size);
+    auto encoded = encoder.encode(reader);
+    REQUIRE(encoded);
+
+    return std::vector<uint8_t>(encoded->get_buffer(), encoded->get_buffer() + encoded->get_last_byte_position());
+}
+
+static std::vector<uint8_t> rans_decode(std::vector<uint8_t> frame) {
+    utils::io::BitStreamReader reader(frame);
+    utils::algo::RANS decoder;
+    auto decoded = decoder.decode(reader);
+    REQUIRE(decoded);
+
+    return std::vector<uint8_t>(decoded->get_buffer(), decoded->get_buffer() + decoded->get_size());
+}
+
+/**
+ *  Bytes that are 0 85% of the time, a Huffman code spends a whole bit on it.
+ */
+static std::vector<uint8_t> skewed_bytes(size_t size, uint32_t seed) {
+    std::vector<uint8_t> data(size);
+    for (size_t i = 0; i < size; i++) {
+        seed = seed * 1103515245u + 12345u;
+        data[i] = (seed >> 16) % 100 < 85 ? uint8_t(0) : uint8_t(1 + (seed >> 8) % 7);
+    }
+    return data;
+}
+
+TEST_CASE("Test utils::algo::RANS round trip") {
+    SUBCASE("Test utils::algo::RANS text") {
+        std::string text;
+        for (int i = 0; text.size() < 50000; i++) {
+            text += "The quick brown fox " + std::to_string(i * 7919 % 1000) + " jumps\n";
+        }
+
+        const std::vector<uint8_t> data(text.begin(), text.end());
+        CHECK(rans_decode(rans_encode(data)) == data);
+        CHECK(rans_decode(rans_encode(data, 1000)) == data);
+    }
+
+    SUBCASE("Test utils::algo::RANS small blocks") {
+        CHECK(rans_decode(rans_encode(std::vector<uint8_t>{ 42 })) == std::vector<uint8_t>{ 42 });
+
+        // Single symbol, every tail length of the interleaved states
+        for (const size_t size : { size_t(5), size_t(64), size_t(1001), size_t(1002), size_t(1003) }) {
+            const std::vector<uint8_t> data(size, uint8_t('z'));
+            CHECK(rans_decode(rans_encode(data)) == data);
+        }
+    }
+
+    SUBCASE("Test utils::algo::RANS all symbols") {
+        // Every byte value, mostly with frequency 1 after normalization
+        std::vector<uint8_t> data(20000, uint8_t(7));
+        for (size_t i = 0; i < 256; i++) {
+            data[i * 13] = uint8_t(i);
+        }
+        CHECK(rans_decode(rans_encode(data)) == data);
+    }
+
+    SUBCASE("Test utils::algo::RANS incompressible") {
+        std::vector<uint8_t> data(300000);
+        uint32_t state = 1;
+        for (size_t i = 0; i < data.size(); i++) {
+            state = state * 1103515245u + 12345u;
+            data[i] = i < 100000 ? uint8_t('a' + (state >> 16) % 4) : uint8_t(state >> 24);
+        }
+
+        const auto frame = rans_encode(data);
+        CHECK(frame.size() < data.size());
+        CHECK(rans_decode(frame) == data);
+    }
+}
+
+TEST_CASE("Test utils::algo::RANS skewed ratio") {
+    const auto data = skewed_bytes(100000, 3);
+
+    utils::io::BitStreamReader reader(data);
+    utils::algo::Huffman<uint8_t> huffman;
+    const auto huffman_frame = huffman.encode(reader);
+    REQUIRE(huffman_frame);
+
+    const auto frame = rans_encode(data);
+    CHECK(frame.size() * 100 < huffman_frame->get_last_byte_position() * 97);
+    CHECK(rans_decode(frame) == data);
+
+    utils::algo::RANS rans;
+    rans.encode(reader);
+    const auto& freqs = rans.get_freqs();
+    CHECK(std::accumulate(freqs.begin(), freqs.end(), 0u) == utils::algo::RANS::PROB_SCALE);
+}
+
+TEST_CASE("Test utils::algo::RANS parallel blocks") {
+    const auto data = skewed_bytes(200000, 11);
+    const auto frame = rans_encode(data, 4096);
+
+    utils::threading::ThreadPool pool(4);
+    utils::io::BitStreamReader frame_reader(frame);
+
+    SUBCASE("Test utils::algo::RANS parallel encode") {
+        utils::io::BitStreamReader reader(data);
+        utils::algo::RANS encoder(4096);
+        const auto parallel = encoder.encode(reader, pool);
+        REQUIRE(parallel);
+        CHECK(std::vector<uint8_t>(parallel->get_buffer(), parallel->get_buffer() + parallel->get_last_byte_position()) == frame);
+    }
+
+    SUBCASE("Test utils::algo::RANS parallel decode") {
+        utils::algo::RANS decoder;
+        const auto decoded = decoder.decode(frame_reader, pool);
+        REQUIRE(decoded);
+        CHECK(std::vector<uint8_t>(decoded->get_buffer(), decoded->get_buffer() + decoded->get_size()) == data);
+    }
+
+    SUBCASE("Test utils::algo::RANS random access") {
+        const size_t blocks = utils::algo::RANS::block_count(frame_reader);
+        REQUIRE(blocks == (data.size() + 4095) / 4096);
+
+        utils::algo::RANS decoder;
+        for (const size_t index : { size_t(0), size_t(17), blocks - 1 }) {
+            const size_t begin = index * 4096;
+            const size_t end   = std::min(begin + 4096, data.size());
+            CHECK(decoder.decode_block(frame_reader, index) == std::vector<uint8_t>(data.begin() + begin, data.begin() + end));
+        }
+    }
+}
+
+TEST_CASE("Test utils::algo::RANS corrupt frames") {
+    const auto data = skewed_bytes(10000, 5);
+    const auto frame = rans_encode(data, 4096);
+
+    const auto decode = [](std::vector<uint8_t> bytes) {
+        utils::io::BitStreamReader reader(bytes);
+        utils::algo::RANS decoder;
+        return decoder.decode(reader);
+    };
+
+    SUBCASE("Test utils::algo::RANS flipped bits") {
+        for (const size_t at : { frame.size() - 1, frame.size() - 100, frame.size() / 2 }) {
+            auto corrupt = frame;
+            corrupt[at] ^= 0x21;
+            CHECK_THROWS_AS(decode(corrupt), utils::exceptions::Exception);
+        }
+    }
+
+    SUBCASE("Test utils::algo::RANS truncated frame") {
+        CHECK_THROWS_AS(decode(std::vector<uint8_t>(frame.begin(), frame.end() - 1)), utils::exceptions::Exception);
+        CHECK_THROWS_AS(decode(std::vector<uint8_t>(frame.begin(), frame.begin() + 8)), utils::exceptions::Exception);
+    }
+
+    SUBCASE("Test utils::algo::RANS not a frame") {
+        CHECK_THROWS_AS(decode(data), utils::exceptions::Exception);
+
+        utils::io::BitStreamReader reader(data);
+        utils::algo::Huffman<uint8_t> huffman;
+        const auto huffman_frame = huffman.encode(reader);
+        REQUIRE(huffman_frame);
+        CHECK_THROWS_AS(decode(std::vector<uint8_t>(huffman_frame->get_buffer(), huffman_frame->get_buffer() + huffman_frame->get_last_byte_position())),
+                        utils::exceptions::Exception);
+    }
+
+    SUBCASE("Test utils::algo::RANS malicious frame length") {
+        utils::io::BitStreamWriter writer(64);
+        writer.put(32, utils::algo::RANS::FRAME_MAGIC);
+        writer.put(8, utils::algo::RANS::FRAME_VERSION);
+        writer.put_leb128(~uint64_t(0));
+        writer.put_leb128(2);
+
+        CHECK_THROWS_AS(decode(std::vector<uint8_t>(writer.get_buffer(), writer.get_buffer() + writer.get_last_byte_position())),
+                        utils::exceptions::Exception);
+    }
+}
+
+#endif
@@ -0,0 +1,62 @@
+#include "test_settings.hpp"
+
+#ifdef ENABLE_TESTS
+#include "../utils_lib/external/doctest.hpp"
+
+#include "../utils_lib/utils_benchmark.hpp"
+
+TEST_CASE("Test utils::benchmark::generate") {
+    for (const auto corpus : utils::benchmark::CORPORA) {
+        const auto data = utils::benchmark::generate(corpus, 5000, 7);
+
+        CHECK(data.size() == 5000);
+        CHECK(data == utils::benchmark::generate(corpus, 5000, 7));
+        CHECK(data != utils::benchmark::generate(corpus, 5000, 8));
+        CHECK(utils::benchmark::generate(corpus, 0).empty());
+    }
+
+    const auto skewed = utils::benchmark::generate(utils::benchmark::Corpus::SKEWED, 10000);
+    const auto zeros  = std::count(skewed.begin(), skewed.end(), uint8_t(0));
+    CHECK(zeros > 8000);
+    CHECK(zeros < 9000);
+
+    const auto text = utils::benchmark::generate(utils::benchmark::Corpus::TEXT, 10000);
+    CHECK(std::all_of(text.begin(), text.end(), [](uint8_t c) { return c == '\n' || (c >= ' ' && c <= 'z'); }));
+}
+
+TEST_CASE("Test utils::benchmark::measure") {
+    const utils::benchmark::Codec reverse{
+        "reverse",
+        [](const std::vector<uint8_t>& data) { return std::vector<uint8_t>(data.rbegin(), data.rend()); },
+        [](const std::vector<uint8_t>& data) { return std::vector<uint8_t>(data.rbegin(), data.rend()); }
+    };
+    const utils::benchmark::Codec broken{
+        "broken",
+        [](const std::vector<uint8_t>& data) { return std::vector<uint8_t>(data.begin(), data.begin() + data.size() / 2); },
+        [](const std::vector<uint8_t>& data) { return data; }
+    };
+
+    const auto data = utils::benchmark::generate(utils::benchmark::Corpus::RANDOM, 4096);
+
+    const auto result = utils::benchmark::measure(reverse, "random", data, 0.0, 4);
+    CHECK(result.round_trip);
+    CHECK(result.runs == 4);
+    CHECK(result.encoded_size == 4096);
+    CHECK(result.ratio() == doctest::Approx(1.0));
+    CHECK(result.encode_ns > 0.0);
+    CHECK(result.decode_mbs() > 0.0);
+
+    const auto failed = utils::benchmark::measure(broken, "random", data, 0.0, 1);
+    CHECK_FALSE(failed.round_trip);
+    CHECK(failed.ratio() == doctest::Approx(0.5));
+
+    const auto report = utils::benchmark::to_json({ result, failed }, "1.2.3");
+    CHECK(report["version"] == "1.2.3");
+    REQUIRE(report["results"].size() == 2);
+    CHECK(report["results"][0]["codec"] == "reverse");
+    CHECK(report["results"][0]["size"] == 4096);
+    CHECK(report["results"][1]["round_trip"] == false);
+    CHECK(utils::json::parse(report.dump())["results"][1]["ratio"] == doctest::Approx(0.5));
+}
+
+#endif
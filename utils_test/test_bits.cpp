@@ -351,4 +351,35 @@ TEST_CASE("Test utils::bits::to_string" ) {
     CHECK(utils::bits::to_string(test5) == "00000000010101010000000010101010");
 }
 
+TEST_CASE("Test utils::bits::byteswap" ) {
+    CHECK(utils::bits::byteswap(uint8_t(0x12)) == 0x12);
+    CHECK(utils::bits::byteswap(uint16_t(0x1234)) == 0x3412);
+    CHECK(utils::bits::byteswap(uint32_t(0x12345678)) == 0x78563412);
+    CHECK(utils::bits::byteswap(uint64_t(0x0123456789ABCDEFull)) == 0xEFCDAB8967452301ull);
+
+    uint8_t buffer[9] = { 0 };
+    utils::bits::store_big_endian<uint32_t>(buffer + 1, 0x12345678);
+    CHECK(buffer[1] == 0x12);
+    CHECK(buffer[4] == 0x78);
+    CHECK(utils::bits::load_big_endian<uint32_t>(buffer + 1) == 0x12345678);
+
+    utils::bits::store_little_endian<uint64_t>(buffer + 1, 0x0123456789ABCDEFull);
+    CHECK(buffer[1] == 0xEF);
+    CHECK(buffer[8] == 0x01);
+    CHECK(utils::bits::load_little_endian<uint64_t>(buffer + 1) == 0x0123456789ABCDEFull);
+}
+
+TEST_CASE("Test utils::bits::zigzag" ) {
+    CHECK(utils::bits::zigzag_encode(0)  == 0);
+    CHECK(utils::bits::zigzag_encode(-1) == 1);
+    CHECK(utils::bits::zigzag_encode(1)  == 2);
+    CHECK(utils::bits::zigzag_encode(-2) == 3);
+    CHECK(utils::bits::zigzag_encode(INT64_MAX) == UINT64_MAX - 1);
+    CHECK(utils::bits::zigzag_encode(INT64_MIN) == UINT64_MAX);
+
+    for (const int64_t v : { int64_t(0), int64_t(-12345), int64_t(12345), INT64_MIN, INT64_MAX }) {
+        CHECK(utils::bits::zigzag_decode(utils::bits::zigzag_encode(v)) == v);
+    }
+}
+
 #endif
@@ -47,4 +47,27 @@ TEST_CASE("Test utils::crypto::aes") {
 #endif
 }
 
+TEST_CASE("Test utils::crypto::aes chained modes") {
+    utils::crypto::AES aes;
+
+    auto key = utils::random::generate_x<uint8_t>(256 / 8);
+    auto iv  = utils::random::generate_x<uint8_t>(16);
+    auto inp = utils::random::generate_x<uint8_t>(16 * 5);
+    uint32_t out_len = 0;
+
+    SUBCASE("Test utils::crypto::aes CBC") {
+        auto enc = aes.EncryptCBC(inp.data(), uint32_t(inp.size()), key.data(), iv.data(), out_len);
+        REQUIRE(out_len == inp.size());
+        auto dec = aes.DecryptCBC(enc.get(), out_len, key.data(), iv.data());
+        CHECK(std::equal(inp.begin(), inp.end(), dec.get()));
+    }
+
+    SUBCASE("Test utils::crypto::aes CFB") {
+        auto enc = aes.EncryptCFB(inp.data(), uint32_t(inp.size()), key.data(), iv.data(), out_len);
+        REQUIRE(out_len == inp.size());
+        auto dec = aes.DecryptCFB(enc.get(), out_len, key.data(), iv.data());
+        CHECK(std::equal(inp.begin(), inp.end(), dec.get()));
+    }
+}
+
 #endif
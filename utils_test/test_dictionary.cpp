@@ -0,0 +1,177 @@
+#include "test_settings.hpp"
+
+#ifdef ENABLE_TESTS
+#include "../utils_lib/external/doctest.hpp"
+
+#include "../utils_lib/algo/algo_dictionary.hpp"
+#include "../utils_lib/algo/algo_huffman.hpp"
+#include "../utils_lib/crypto/crypto_packager.hpp"
+#include "../utils_lib/utils_json.hpp"
+
+#include <string>
+
+/**
+ *  Small UBJSON messages with the same keys and varying values.
+ */
+static std::vector<std::vector<uint8_t>> json_messages(size_t count, uint32_t seed) {
+    static const char *const names[] = { "sensor", "gateway", "relay", "probe" };
+    std::vector<std::vector<uint8_t>> messages;
+
+    for (size_t i = 0; i < count; i++) {
+        seed = seed * 1103515245u + 12345u;
+
+        const utils::json message = {
+            { "id",        seed % 100000u },
+            { "name",      std::string(names[(seed >> 8) % 4u]) + "-" + std::to_string((seed >> 4) % 64u) },
+            { "status",    (seed >> 12) % 3u == 0 ? "ok" : "degraded" },
+            { "values",    { (seed >> 3) % 1000u, (seed >> 7) % 1000u, (seed >> 11) % 1000u } },
+            { "timestamp", 1600000000u + seed % 86400u },
+        };
+
+        messages.push_back(utils::json::to_ubjson(message));
+    }
+
+    return messages;
+}
+
+static std::vector<uint8_t> dict_encode(const utils::algo::HuffmanDictionary<>& dict, const std::vector<uint8_t>& data) {
+    utils::io::BitStreamReader reader(data);
+    auto encoded = dict.encode(reader);
+    REQUIRE(encoded);
+
+    return std::vector<uint8_t>(encoded->get_buffer(), encoded->get_buffer() + encoded->get_last_byte_position());
+}
+
+static std::vector<uint8_t> dict_decode(const utils::algo::DictionaryStore<>& store, std::vector<uint8_t> message) {
+    utils::io::BitStreamReader reader(message);
+    auto decoded = store.decode(reader);
+    REQUIRE(decoded);
+
+    return std::vector<uint8_t>(decoded->get_buffer(), decoded->get_buffer() + decoded->get_size());
+}
+
+TEST_CASE("Test utils::algo::HuffmanDictionary") {
+    const auto samples  = json_messages(500, 1);
+    const auto messages = json_messages(200, 2);
+
+    const auto dict = utils::algo::HuffmanDictionary<>::train(7, samples);
+    CHECK(dict.get_id() == 7);
+    CHECK(dict.get_dict().size() == utils::algo::Huffman<uint8_t>::ALPHABET);
+
+    utils::algo::DictionaryStore<> store;
+    store.add(dict);
+
+    SUBCASE("Test utils::algo::HuffmanDictionary small messages") {
+        size_t raw = 0, framed = 0, referenced = 0;
+
+        for (const auto& message : messages) {
+            const auto encoded = dict_encode(dict, message);
+            CHECK(dict_decode(store, encoded) == message);
+
+            utils::io::BitStreamReader reader(message);
+            utils::algo::Huffman<uint8_t> huffman;
+            const auto frame = huffman.encode(reader);
+            REQUIRE(frame);
+
+            raw        += message.size();
+            framed     += frame->get_last_byte_position();
+            referenced += encoded.size();
+        }
+
+        // Tables and frames cost more than they save on messages this small
+        CHECK(framed >= raw);
+        CHECK(referenced < raw * 3 / 4);
+    }
+
+    SUBCASE("Test utils::algo::HuffmanDictionary symbols missing from the samples") {
+        std::vector<uint8_t> data(300);
+        for (size_t i = 0; i < data.size(); i++) {
+            data[i] = uint8_t(i * 37);
+        }
+
+        // Longer than the input, stored
+        const auto encoded = dict_encode(dict, data);
+        CHECK(encoded.size() == data.size() + 3);
+        CHECK(dict_decode(store, encoded) == data);
+
+        const std::vector<uint8_t> single{ 0xFF };
+        CHECK(dict_decode(store, dict_encode(dict, single)) == single);
+    }
+
+    SUBCASE("Test utils::algo::HuffmanDictionary saved form") {
+        const auto bytes  = dict.to_bytes();
+        const auto loaded = utils::algo::HuffmanDictionary<>::from_bytes(bytes.data(), bytes.size());
+
+        CHECK(loaded.get_id() == 7);
+        CHECK(loaded.to_bytes() == bytes);
+        CHECK(dict_encode(loaded, messages[0]) == dict_encode(dict, messages[0]));
+
+        auto corrupt = bytes;
+        corrupt[10] ^= 0x01;
+        CHECK_THROWS_AS(utils::algo::HuffmanDictionary<>::from_bytes(corrupt.data(), corrupt.size()), utils::exceptions::Exception);
+        CHECK_THROWS_AS(utils::algo::HuffmanDictionary<>::from_bytes(bytes.data(), bytes.size() - 1), utils::exceptions::Exception);
+        CHECK_THROWS_AS(utils::algo::HuffmanDictionary<>::from_bytes(messages[0].data(), messages[0].size()), utils::exceptions::Exception);
+
+        const std::string filename = "test_dictionary.bin";
+        dict.write_to_file(filename);
+
+        utils::algo::DictionaryStore<> file_store;
+        CHECK(file_store.load(filename) == 7);
+        CHECK(file_store.contains(7));
+        CHECK(dict_decode(file_store, dict_encode(dict, messages[1])) == messages[1]);
+
+        std::remove(filename.c_str());
+    }
+
+    SUBCASE("Test utils::algo::HuffmanDictionary corrupt messages") {
+        const auto encoded = dict_encode(dict, messages[0]);
+
+        const auto other = utils::algo::HuffmanDictionary<>::train(8, messages);
+        CHECK_THROWS_AS(dict_decode(store, dict_encode(other, messages[0])), utils::exceptions::Exception);
+
+        utils::io::BitStreamReader reader(encoded);
+        CHECK_THROWS_AS(other.decode(reader), utils::exceptions::Exception);
+
+        CHECK_THROWS_AS(dict_decode(store, std::vector<uint8_t>(encoded.begin(), encoded.end() - 1)), utils::exceptions::Exception);
+
+        auto trailing = encoded;
+        trailing.push_back(0);
+        CHECK_THROWS_AS(dict_decode(store, trailing), utils::exceptions::Exception);
+    }
+
+    SUBCASE("Test utils::algo::HuffmanDictionary 16 bit symbols") {
+        const auto wide = utils::algo::HuffmanDictionary<uint16_t>::train(9, samples);
+        const auto bytes = wide.to_bytes();
+        const auto loaded = utils::algo::HuffmanDictionary<uint16_t>::from_bytes(bytes.data(), bytes.size());
+
+        // Odd sized, the last symbol is padded
+        std::vector<uint8_t> data(messages[3].begin(), messages[3].end());
+        data.push_back(0x42);
+        if (data.size() % 2 == 0) {
+            data.push_back(0x43);
+        }
+
+        utils::io::BitStreamReader reader(data);
+        const auto encoded = wide.encode(reader);
+        REQUIRE(encoded);
+
+        utils::io::BitStreamReader message(encoded->get_buffer(), encoded->get_last_byte_position());
+        const auto decoded = loaded.decode(message);
+        REQUIRE(decoded);
+        CHECK(std::vector<uint8_t>(decoded->get_buffer(), decoded->get_buffer() + decoded->get_size()) == data);
+    }
+
+    SUBCASE("Test utils::crypto::HMDictCompress") {
+        utils::crypto::HMDictCompress packager;
+
+        utils::io::BitStreamReader reader(messages[5]);
+        auto packed = packager.Pack(reader, dict);
+        CHECK(packed.get_size() < messages[5].size());
+
+        utils::io::BitStreamReader packed_reader(packed.get_buffer(), packed.get_size());
+        auto unpacked = packager.Unpack(packed_reader, store);
+        CHECK(std::vector<uint8_t>(unpacked.get_buffer(), unpacked.get_buffer() + unpacked.get_size()) == messages[5]);
+    }
+}
+
+#endif
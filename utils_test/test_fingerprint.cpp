@@ -0,0 +1,88 @@
+#include "test_settings.hpp"
+
+#ifdef ENABLE_TESTS
+#include "../utils_lib/external/doctest.hpp"
+
+#include "../utils_lib/utils_fingerprint.hpp"
+#include "../utils_lib/utils_random.hpp"
+
+#include <fstream>
+
+
+TEST_CASE("Test utils::io::FingerprintIndex") {
+    namespace fs = utils::io::fs;
+
+    const fs::path root  = fs::temp_directory_path() / ("utils_fp_" + utils::random::generate_string<char>(8, 'a', 'z'));
+    const std::string db = (root.string() + ".index");
+
+    const auto write = [](const fs::path& path, const std::string& content) {
+        fs::create_directories(path.parent_path());
+        std::ofstream(path, std::ios::binary) << content;
+    };
+
+    for (int i = 0; i < 20; i++) {
+        write(root / ("dir" + std::to_string(i % 3)) / ("file" + std::to_string(i)), "content " + std::to_string(i));
+    }
+
+    utils::io::FingerprintIndex index;
+    auto changes = index.update(root.string(), 4);
+    CHECK(changes.added.size() == 20);
+    CHECK(changes.modified.empty());
+    CHECK(changes.removed.empty());
+    CHECK(changes.hashed == 20);
+    CHECK(index.size() == 20);
+
+    const std::string file0 = (root / "dir0" / "file0").string();
+    REQUIRE(index.find(file0) != nullptr);
+    CHECK(index.find(file0)->size == 9);
+    CHECK(index.find(file0)->hash == utils::hash::xxhash64("content 0"));
+    CHECK(*index.find(file0) == utils::io::file_fingerprint(file0));
+
+    SUBCASE("Test utils::io::FingerprintIndex incremental update") {
+        // Nothing changed: no file is read
+        changes = index.update(root.string(), 4);
+        CHECK(changes.empty());
+        CHECK(changes.hashed == 0);
+
+        // Touched only: hashed, not modified
+        const std::string file1 = (root / "dir1" / "file1").string();
+        fs::last_write_time(file1, fs::last_write_time(file1) + std::chrono::seconds(10));
+
+        // Changed, added and removed
+        const std::string file2 = (root / "dir2" / "file2").string();
+        write(file2, "changed contents");
+        fs::last_write_time(file2, fs::last_write_time(file2) + std::chrono::seconds(10));
+        write(root / "new", "new");
+        fs::remove(root / "dir0" / "file3");
+
+        changes = index.update(root.string(), 2);
+        CHECK(changes.hashed == 3);
+        CHECK(changes.modified == std::vector<std::string>{ file2 });
+        CHECK(changes.added    == std::vector<std::string>{ (root / "new").string() });
+        CHECK(changes.removed  == std::vector<std::string>{ (root / "dir0" / "file3").string() });
+        CHECK(index.size() == 20);
+    }
+
+    SUBCASE("Test utils::io::FingerprintIndex save and load") {
+        index.save(db);
+
+        auto loaded = utils::io::FingerprintIndex::load(db);
+        CHECK(loaded.get_entries() == index.get_entries());
+        CHECK(loaded.update(root.string()).hashed == 0);
+
+        CHECK(utils::io::FingerprintIndex::load(db + "_missing").size() == 0);
+
+        // Flipped byte
+        {
+            std::fstream file(db, std::ios::in | std::ios::out | std::ios::binary);
+            file.seekp(20);
+            file.put('X');
+        }
+        CHECK_THROWS_AS(utils::io::FingerprintIndex::load(db), utils::exceptions::Exception);
+        fs::remove(db);
+    }
+
+    fs::remove_all(root);
+}
+
+#endif
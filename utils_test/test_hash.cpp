@@ -0,0 +1,39 @@
+#include "test_settings.hpp"
+
+#ifdef ENABLE_TESTS
+#include "../utils_lib/external/doctest.hpp"
+
+#include "../utils_lib/utils_hash.hpp"
+
+#include <numeric>
+#include <string>
+#include <vector>
+
+
+TEST_CASE("Test utils::hash::xxhash64") {
+    // Reference values of XXH64
+    CHECK(utils::hash::xxhash64("")    == 0xEF46DB3751D8E999ull);
+    CHECK(utils::hash::xxhash64("a")   == 0xD24EC4F1A98C6E5Bull);
+    CHECK(utils::hash::xxhash64("abc") == 0x44BC2CF5AD770999ull);
+    CHECK(utils::hash::xxhash64("Nobody inspects the spammish repetition") == 0xFBCEA83C8A378BF1ull);
+    CHECK(utils::hash::xxhash64("", 1) != utils::hash::xxhash64(""));
+
+    SUBCASE("Test utils::hash::XXHash64 incremental") {
+        std::vector<uint8_t> data(1000);
+        std::iota(data.begin(), data.end(), uint8_t(7));
+
+        for (const size_t length : { size_t(0), size_t(5), size_t(31), size_t(32), size_t(33), size_t(100), size_t(1000) }) {
+            for (const size_t piece : { size_t(1), size_t(7), size_t(32), size_t(64) }) {
+                utils::hash::XXHash64 hasher(42);
+
+                for (size_t i = 0; i < length; i += piece) {
+                    hasher.update(data.data() + i, std::min(piece, length - i));
+                }
+
+                CHECK(hasher.digest() == utils::hash::xxhash64(data.data(), length, 42));
+            }
+        }
+    }
+}
+
+#endif
@@ -0,0 +1,40 @@
+#include "test_settings.hpp"
+
+#ifdef ENABLE_TESTS
+#include "../utils_lib/external/doctest.hpp"
+
+#include "../utils_lib/algo/algo_histogram.hpp"
+
+#include <algorithm>
+#include <vector>
+
+TEST_CASE("Test utils::algo::histogram") {
+    std::vector<uint8_t> data(1003);
+    for (size_t i = 0; i < data.size(); i++) {
+        data[i] = i < 500 ? uint8_t(7) : uint8_t(i * 31);
+    }
+
+    // Partial word at the end, and offsets not aligned to a word
+    for (const size_t offset : { size_t(0), size_t(3) }) {
+        uint32_t expected[utils::algo::HISTOGRAM_BINS] = {};
+        for (size_t i = offset; i < data.size(); i++) {
+            expected[data[i]]++;
+        }
+
+        uint32_t counts[utils::algo::HISTOGRAM_BINS];
+        std::fill(std::begin(counts), std::end(counts), 0xDEADu);
+        utils::algo::histogram(data.data() + offset, data.size() - offset, counts);
+
+        for (size_t bin = 0; bin < utils::algo::HISTOGRAM_BINS; bin++) {
+            CHECK(counts[bin] == expected[bin]);
+        }
+    }
+
+    SUBCASE("Test utils::algo::histogram empty") {
+        uint32_t counts[utils::algo::HISTOGRAM_BINS] = { 1u };
+        utils::algo::histogram(data.data(), 0, counts);
+        CHECK(std::all_of(std::begin(counts), std::end(counts), [](uint32_t count) { return count == 0; }));
+    }
+}
+
+#endif
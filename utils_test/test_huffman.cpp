@@ -0,0 +1,279 @@
+#include "test_settings.hpp"
+
+#ifdef ENABLE_TESTS
+#include "../utils_lib/external/doctest.hpp"
+
+#include "../utils_lib/algo/algo_huffman.hpp"
+
+#include <string>
+#include <utility>
+
+template <class T = uint8_t>
+static std::vector<uint8_t> huffman_round_trip(const std::vector<uint8_t>& data,
+                                               size_t block_size = utils::algo::Huffman<T>::DEFAULT_BLOCK_SIZE)
+{
+    utils::io::BitStreamReader reader(data);
+    utils::algo::Huffman<T> encoder(block_size);
+    auto encoded = encoder.encode(reader);
+    REQUIRE(encoded);
+
+    utils::io::BitStreamReader encoded_reader(encoded->get_buffer(), encoded->get_last_byte_position());
+    utils::algo::Huffman<T> decoder;
+    auto decoded = decoder.decode(encoded_reader);
+    REQUIRE(decoded);
+
+    return std::vector<uint8_t>(decoded->get_buffer(), decoded->get_buffer() + decoded->get_size());
+}
+
+TEST_CASE("Test utils::algo::Huffman round trip") {
+    SUBCASE("Test utils::algo::Huffman text") {
+        std::string text;
+        for (int i = 0; text.size() < 50000; i++) {
+            text += "The quick brown fox " + std::to_string(i * 7919 % 1000) + " jumps\n";
+        }
+
+        const std::vector<uint8_t> data(text.begin(), text.end());
+        CHECK(huffman_round_trip(data) == data);
+    }
+
+    SUBCASE("Test utils::algo::Huffman skewed") {
+        std::vector<uint8_t> data;
+        for (size_t i = 0; i < 12; i++) {
+            data.insert(data.end(), size_t(1) << i, uint8_t(i));
+        }
+        CHECK(huffman_round_trip(data) == data);
+    }
+
+    SUBCASE("Test utils::algo::Huffman length limit") {
+        // Fibonacci frequencies give a 19 deep unlimited Huffman tree
+        std::vector<uint8_t> data;
+        for (size_t i = 0, a = 1, b = 1; i < 20; i++, b = std::exchange(a, a + b)) {
+            data.insert(data.end(), a, uint8_t(i));
+        }
+
+        utils::io::BitStreamReader reader(data);
+        utils::algo::Huffman<uint8_t> huffman;
+        REQUIRE(huffman.encode(reader));
+
+        const auto& dict = huffman.get_dict();
+        REQUIRE(dict.size() == 20);
+        CHECK(dict.back().second.len == utils::algo::Huffman<uint8_t>::MAX_CODE_BITS);
+
+        // Canonical: lengths ascending, consecutive codes per length
+        for (size_t i = 1; i < dict.size(); i++) {
+            const auto& previous = dict[i - 1].second;
+            const auto& current  = dict[i].second;
+            CHECK(current.word == (previous.word + 1) << (current.len - previous.len));
+        }
+
+        CHECK(huffman_round_trip(data) == data);
+    }
+
+    SUBCASE("Test utils::algo::Huffman blocks") {
+        // Beyond 64 KB, compressible and incompressible (stored) blocks
+        std::vector<uint8_t> data(300000);
+        uint32_t state = 1;
+        for (size_t i = 0; i < data.size(); i++) {
+            state = state * 1103515245u + 12345u;
+            data[i] = i < 100000 ? uint8_t('a' + (state >> 16) % 4) : uint8_t(state >> 24);
+        }
+
+        CHECK(huffman_round_trip(data) == data);
+        CHECK(huffman_round_trip(data, 4096) == data);
+        CHECK(huffman_round_trip(std::vector<uint8_t>{ 42 }) == std::vector<uint8_t>{ 42 });
+    }
+
+    SUBCASE("Test utils::algo::Huffman interleaved streams") {
+        // Around the smallest block coded in streams, with uneven streams
+        for (const size_t size : { size_t(1023), size_t(1024), size_t(1027), size_t(4099) }) {
+            std::vector<uint8_t> data(size);
+            for (size_t i = 0; i < size; i++) {
+                data[i] = uint8_t("aaaabbbcdefgh"[i * 7 % 13]);
+            }
+            CHECK(huffman_round_trip(data) == data);
+        }
+    }
+
+    SUBCASE("Test utils::algo::Huffman 16 bit symbols") {
+        std::vector<uint8_t> data;
+        for (size_t i = 0; i < 20001; i++) {
+            data.push_back(uint8_t(i % 7 == 0 ? i : i % 3));
+        }
+        CHECK(huffman_round_trip<uint16_t>(data, 5000) == data);
+    }
+}
+
+TEST_CASE("Test utils::algo::Huffman corrupt frames") {
+    std::vector<uint8_t> data(10000);
+    for (size_t i = 0; i < data.size(); i++) {
+        data[i] = uint8_t(i % 13 + i % 5);
+    }
+
+    utils::io::BitStreamReader reader(data);
+    utils::algo::Huffman<uint8_t> huffman(4096);
+    const auto encoded = huffman.encode(reader);
+    REQUIRE(encoded);
+    const std::vector<uint8_t> frame(encoded->get_buffer(), encoded->get_buffer() + encoded->get_last_byte_position());
+
+    const auto decode = [](std::vector<uint8_t> bytes) {
+        utils::io::BitStreamReader frame_reader(bytes.data(), bytes.size());
+        utils::algo::Huffman<uint8_t> decoder;
+        return decoder.decode(frame_reader);
+    };
+
+    SUBCASE("Test utils::algo::Huffman flipped payload bit") {
+        auto corrupt = frame;
+        corrupt[corrupt.size() - 10] ^= 0x10;
+        CHECK_THROWS_AS(decode(corrupt), utils::exceptions::Exception);
+    }
+
+    SUBCASE("Test utils::algo::Huffman truncated frame") {
+        CHECK_THROWS_AS(decode(std::vector<uint8_t>(frame.begin(), frame.end() - 1)), utils::exceptions::Exception);
+        CHECK_THROWS_AS(decode(std::vector<uint8_t>(frame.begin(), frame.begin() + 8)), utils::exceptions::Exception);
+    }
+
+    SUBCASE("Test utils::algo::Huffman not a frame") {
+        CHECK_THROWS_AS(decode(data), utils::exceptions::Exception);
+    }
+
+    SUBCASE("Test utils::algo::Huffman malicious frame length") {
+        // Block count of a length near 2^64 must not wrap to zero
+        for (const uint64_t length : { ~uint64_t(0), ~uint64_t(0) - 1u, uint64_t(1) }) {
+            utils::io::BitStreamWriter writer(64);
+            writer.put(32, utils::algo::Huffman<uint8_t>::FRAME_MAGIC);
+            writer.put(8, utils::algo::Huffman<uint8_t>::FRAME_VERSION);
+            writer.put_leb128(length);
+            writer.put_leb128(2);
+
+            CHECK_THROWS_AS(decode(std::vector<uint8_t>(writer.get_buffer(), writer.get_buffer() + writer.get_last_byte_position())),
+                            utils::exceptions::Exception);
+        }
+    }
+}
+
+TEST_CASE("Test utils::algo::Huffman parallel blocks") {
+    std::vector<uint8_t> data(200000);
+    uint32_t state = 7;
+    for (size_t i = 0; i < data.size(); i++) {
+        state = state * 1103515245u + 12345u;
+        data[i] = i % 50000 < 30000 ? uint8_t('a' + (state >> 16) % 6) : uint8_t(state >> 24);
+    }
+
+    utils::threading::ThreadPool pool(4);
+
+    utils::io::BitStreamReader reader(data);
+    utils::algo::Huffman<uint8_t> huffman(4096);
+
+    const auto sequential = huffman.encode(reader);
+    const auto parallel   = huffman.encode(reader, pool);
+    REQUIRE(sequential);
+    REQUIRE(parallel);
+
+    const std::vector<uint8_t> frame(parallel->get_buffer(), parallel->get_buffer() + parallel->get_last_byte_position());
+    CHECK(frame == std::vector<uint8_t>(sequential->get_buffer(), sequential->get_buffer() + sequential->get_last_byte_position()));
+
+    utils::io::BitStreamReader frame_reader(frame);
+
+    SUBCASE("Test utils::algo::Huffman parallel decode") {
+        utils::algo::Huffman<uint8_t> decoder;
+        const auto decoded = decoder.decode(frame_reader, pool);
+        REQUIRE(decoded);
+        CHECK(std::vector<uint8_t>(decoded->get_buffer(), decoded->get_buffer() + decoded->get_size()) == data);
+
+        auto corrupt = frame;
+        corrupt[corrupt.size() / 2] ^= 0x04;
+        utils::io::BitStreamReader corrupt_reader(corrupt);
+        CHECK_THROWS_AS(decoder.decode(corrupt_reader, pool), utils::exceptions::Exception);
+    }
+
+    SUBCASE("Test utils::algo::Huffman random access") {
+        const size_t blocks = utils::algo::Huffman<uint8_t>::block_count(frame_reader);
+        REQUIRE(blocks == (data.size() + 4095) / 4096);
+
+        utils::algo::Huffman<uint8_t> decoder;
+        for (const size_t index : { size_t(0), size_t(9), blocks - 1 }) {
+            const size_t begin = index * 4096;
+            const size_t end   = std::min(begin + 4096, data.size());
+            CHECK(decoder.decode_block(frame_reader, index) == std::vector<uint8_t>(data.begin() + begin, data.begin() + end));
+        }
+
+        CHECK_THROWS_AS(decoder.decode_block(frame_reader, blocks), utils::exceptions::Exception);
+    }
+}
+
+TEST_CASE("Test utils::algo::HuffmanDecoder") {
+    // Codes 0, 10, 110, ... with the longest codes beyond the primary table
+    std::vector<std::pair<uint8_t, utils::algo::Codeword>> codes;
+    for (uint32_t i = 0; i < 15; i++) {
+        codes.push_back({ uint8_t(i), utils::algo::Codeword{ utils::bits::mask_lsb<uint32_t>(i + 1) - 1u, i + 1 } });
+    }
+    codes.push_back({ uint8_t(15), utils::algo::Codeword{ utils::bits::mask_lsb<uint32_t>(15), 15 } });
+
+    utils::algo::HuffmanDecoder<uint8_t> decoder;
+    decoder.build(codes);
+
+    std::vector<uint8_t> symbols;
+    for (size_t i = 0; i < 1000; i++) {
+        symbols.push_back(uint8_t((i * i) % 16));
+    }
+
+    utils::io::BitStreamWriter writer(16);
+    for (const uint8_t symbol : symbols) {
+        writer.put(codes[symbol].second.len, codes[symbol].second.word);
+    }
+
+    utils::io::BitStreamReader reader(writer.get_buffer(), writer.get_last_byte_position());
+    std::vector<uint8_t> decoded(symbols.size());
+    decoder.decode(reader, decoded.data(), decoded.size());
+    CHECK(decoded == symbols);
+    CHECK(reader.get_position() == writer.get_position());
+
+    SUBCASE("Test utils::algo::HuffmanDecoder interleaved") {
+        using Decoder = utils::algo::HuffmanDecoder<uint8_t>;
+
+        const size_t per = Decoder::stream_symbols(symbols.size() - 3);
+        utils::io::BitStreamWriter writers[Decoder::STREAMS] = { 16, 16, 16, 16 };
+
+        for (size_t i = 0; i + 3 < symbols.size(); i++) {
+            writers[i / per].put(codes[symbols[i]].second.len, codes[symbols[i]].second.word);
+        }
+
+        utils::io::BitStreamReader streams[Decoder::STREAMS] = {
+            { writers[0].get_buffer(), writers[0].get_last_byte_position() },
+            { writers[1].get_buffer(), writers[1].get_last_byte_position() },
+            { writers[2].get_buffer(), writers[2].get_last_byte_position() },
+            { writers[3].get_buffer(), writers[3].get_last_byte_position() },
+        };
+
+        std::vector<uint8_t> interleaved(symbols.size() - 3);
+        decoder.decode_interleaved(streams, interleaved.data(), interleaved.size());
+        CHECK(interleaved == std::vector<uint8_t>(symbols.begin(), symbols.end() - 3));
+
+        for (size_t i = 0; i < Decoder::STREAMS; i++) {
+            CHECK(streams[i].get_position() == writers[i].get_position());
+        }
+    }
+
+    SUBCASE("Test utils::algo::HuffmanDecoder single symbol") {
+        utils::algo::HuffmanDecoder<uint8_t> single;
+        single.build(std::vector<std::pair<uint8_t, utils::algo::Codeword>>{ { uint8_t('x'), { 0, 0 } } });
+
+        utils::io::BitStreamReader empty(writer.get_buffer(), 0);
+        single.decode(empty, decoded.data(), 10);
+        CHECK(std::all_of(decoded.begin(), decoded.begin() + 10, [](uint8_t c) { return c == 'x'; }));
+    }
+
+    SUBCASE("Test utils::algo::HuffmanDecoder invalid tables") {
+        utils::algo::HuffmanDecoder<uint8_t> invalid;
+        CHECK_THROWS_AS(invalid.build(std::vector<std::pair<uint8_t, utils::algo::Codeword>>{ { 0, { 0, 1 } }, { 1, { 1, 2 } }, { 2, { 0, 2 } } }),
+                        utils::exceptions::Exception);
+
+        // Incomplete code: "11" is not assigned
+        invalid.build(std::vector<std::pair<uint8_t, utils::algo::Codeword>>{ { 0, { 0, 1 } }, { 1, { 2, 2 } } });
+        uint8_t ones[] = { 0xFF };
+        utils::io::BitStreamReader bad(ones, 1);
+        CHECK_THROWS_AS(invalid.decode(bad, decoded.data(), 1), utils::exceptions::Exception);
+    }
+}
+
+#endif
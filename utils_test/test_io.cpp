@@ -8,6 +8,167 @@
 #include "../utils_lib/utils_string.hpp"
 #include "../utils_lib/utils_random.hpp"
 
+#include <numeric>
+#include <set>
+
+#if defined(UTILS_OS_LINUX) || defined(UTILS_OS_MAC)
+    #include <sys/wait.h>
+#endif
+#include <sstream>
+
+
+TEST_CASE("Test utils::io::scan_directory") {
+    const utils::io::fs::path root = utils::io::fs::temp_directory_path()
+                                   / ("utils_scan_" + utils::random::generate_string<char>(8, 'a', 'z'));
+
+    // Tree of 3 levels with 4 folders and 5 files per folder
+    std::function<void(const utils::io::fs::path&, int)> make_tree = [&](const utils::io::fs::path& dir, int depth) {
+        utils::io::fs::create_directories(dir);
+
+        for (int i = 0; i < 5; i++) {
+            std::ofstream(dir / ("file" + std::to_string(i) + ".txt")) << i;
+        }
+
+        if (depth > 0) {
+            for (int i = 0; i < 4; i++) {
+                make_tree(dir / ("dir" + std::to_string(i)), depth - 1);
+            }
+        }
+    };
+    make_tree(root, 3);
+
+    std::set<std::string> expected_files, expected_dirs;
+    for (const auto& entry : utils::io::fs::recursive_directory_iterator(root)) {
+        (entry.is_directory() ? expected_dirs : expected_files).insert(entry.path().string());
+    }
+    REQUIRE(expected_dirs.size() == 4 + 16 + 64);
+    REQUIRE(expected_files.size() == 5 * (1 + 4 + 16 + 64));
+
+    SUBCASE("Test utils::io::scan_directory callback") {
+        std::mutex mutex;
+        std::set<std::string> files, dirs;
+
+        utils::io::scan_directory(root.string(), [&](const utils::io::ScanEntry& entry) {
+            CHECK(entry.path.substr(entry.path.size() - entry.name.size()) == entry.name);
+
+            LOCK_BLOCK(mutex);
+            if (entry.type == utils::io::EntryType::Directory) {
+                dirs.emplace(entry.path);
+            } else if (entry.type == utils::io::EntryType::File) {
+                files.emplace(entry.path);
+            }
+        }, 4);
+
+        CHECK(files == expected_files);
+        CHECK(dirs == expected_dirs);
+    }
+
+    SUBCASE("Test utils::io::list_contents_parallel") {
+        auto files = utils::io::list_contents_parallel(root.string(), { utils::io::EntryType::File }, 3);
+        CHECK(std::set<std::string>(files->begin(), files->end()) == expected_files);
+
+        CHECK(utils::io::list_contents_parallel(root.string(), {}, 1)->size() == expected_files.size() + expected_dirs.size());
+    }
+
+    SUBCASE("Test utils::io::scan_directory errors") {
+        CHECK_THROWS_AS(utils::io::scan_directory((root / "missing").string(), [](const utils::io::ScanEntry&) {}),
+                        utils::exceptions::Exception);
+
+        std::atomic<size_t> calls{0};
+        CHECK_THROWS_AS(utils::io::scan_directory(root.string(), [&](const utils::io::ScanEntry&) {
+            if (++calls == 10) {
+                throw std::runtime_error("stop");
+            }
+        }, 2), std::runtime_error);
+        CHECK(calls < expected_files.size() + expected_dirs.size());
+
+        // With a single thread no callback follows the exception, also not in the parent directories
+        std::atomic<bool> thrown{false};
+        std::atomic<size_t> after{0};
+        CHECK_THROWS_AS(utils::io::scan_directory(root.string(), [&](const utils::io::ScanEntry& entry) {
+            if (thrown) {
+                ++after;
+            } else if (entry.type == utils::io::EntryType::File && entry.path.size() > root.string().size() + 10) {
+                thrown = true;
+                throw std::runtime_error("stop");
+            }
+        }, 1), std::runtime_error);
+        CHECK(after == 0);
+    }
+
+    utils::io::fs::remove_all(root);
+}
+
+#if defined(UTILS_OS_LINUX) || defined(UTILS_OS_MAC)
+TEST_CASE("Test utils::io::ScratchBuffer") {
+    SUBCASE("Test utils::io::ScratchBuffer anonymous") {
+        auto buffer = utils::io::ScratchBuffer::anonymous(10);
+        CHECK(buffer.size() == 10);
+        CHECK(std::all_of(buffer.begin(), buffer.end(), [](uint8_t b) { return b == 0; }));
+
+        std::vector<uint8_t> data(100000);
+        std::iota(data.begin(), data.end(), uint8_t(3));
+
+        for (size_t i = 0; i < data.size(); i += 1000) {
+            buffer.append(data.data() + i, 1000);
+        }
+        CHECK(buffer.size() == 10 + data.size());
+        CHECK(std::equal(data.begin(), data.end(), buffer.data() + 10));
+
+        buffer.resize(5);
+        CHECK(buffer.size() == 5);
+        buffer.resize(20000);
+        CHECK(buffer[19999] == 0);
+
+        // A second mapping of the same descriptor shares the bytes
+        utils::io::ScratchBuffer view(::dup(buffer.get_fd()));
+        CHECK(view.size() == 20000);
+        view[7] = 0xAB;
+        CHECK(buffer[7] == 0xAB);
+    }
+
+    SUBCASE("Test utils::io::ScratchBuffer between processes") {
+        auto buffer = utils::io::ScratchBuffer::anonymous(4096);
+        const int fd = buffer.get_fd();
+
+        const pid_t pid = ::fork();
+        REQUIRE(pid >= 0);
+
+        if (pid == 0) {
+            utils::io::ScratchBuffer child(::dup(fd));
+            child.resize(8192);
+            std::memset(child.data(), 0x5A, child.size());
+            ::_exit(0);
+        }
+
+        int status = 0;
+        ::waitpid(pid, &status, 0);
+        CHECK(WIFEXITED(status));
+
+        utils::io::ScratchBuffer grown(::dup(fd));
+        CHECK(grown.size() == 8192);
+        CHECK(buffer[4095] == 0x5A);
+        CHECK(grown[8191] == 0x5A);
+    }
+
+    SUBCASE("Test utils::io::TemporaryFile::map") {
+        utils::io::TemporaryFile t;
+        t.write("hello", 5);
+
+        auto buffer = t.map(100);
+        CHECK(buffer.size() == 100);
+        CHECK(std::string_view(reinterpret_cast<const char*>(buffer.data()), 5) == "hello");
+
+        buffer.append("world", 5);
+        buffer.sync();
+        CHECK(utils::io::file_size(t.get_name()) == 105);
+        CHECK(utils::io::file_to_string(t.get_name())->substr(100) == "world");
+
+        utils::io::TemporaryFile unopened(false, "", "", "", "");
+        CHECK_THROWS_AS(unopened.map(), utils::exceptions::Exception);
+    }
+}
+#endif
 
 TEST_CASE("Test utils::io::TemporaryFile") {
     utils::io::fs::path pp;
@@ -65,4 +226,473 @@ TEST_CASE("Test utils::io::TemporaryFile") {
     }
 }
 
+TEST_CASE("Test utils::io::map_file") {
+    std::string contents;
+    for (int i = 0; i < 10000; i++) {
+        contents += utils::string::format("Line %d\n", i);
+    }
+
+    utils::io::TemporaryFile t(false, "", "", "", "");
+    utils::io::string_to_file(t.get_name(), contents);
+
+    SUBCASE("Test utils::io::map_file contents") {
+        const auto mapped = utils::io::map_file(t.get_name());
+        REQUIRE(mapped.size() == contents.size());
+        CHECK(mapped.str() == contents);
+        CHECK(mapped[0] == 'L');
+
+        // Copies share the mapping
+        utils::io::MappedFile copy = mapped;
+        CHECK(copy.data() == mapped.data());
+    }
+
+    SUBCASE("Test utils::io::file_to_bytes and file_to_string") {
+        const auto bytes = utils::io::file_to_bytes(t.get_name());
+        REQUIRE(bytes->size() == contents.size());
+        CHECK(std::equal(bytes->begin(), bytes->end(), contents.begin()));
+        CHECK(*utils::io::file_to_string(t.get_name()) == contents);
+    }
+
+    SUBCASE("Test utils::io::BitStreamReader::from_file") {
+        auto reader = utils::io::BitStreamReader::from_file(t.get_name());
+        REQUIRE(reader->get_size() == contents.size());
+        CHECK(reader->get(8) == 'L');
+        CHECK(reader->get(8) == 'i');
+    }
+
+    SUBCASE("Test utils::io::map_file empty and missing files") {
+        utils::io::TemporaryFile empty;
+        CHECK(utils::io::map_file(empty.get_name()).empty());
+
+        CHECK_THROWS_AS(utils::io::MappedFile(t.get_name() + "_missing"),
+                        utils::exceptions::FileReadException);
+    }
+}
+
+TEST_CASE("Test utils::io::BitStream") {
+    SUBCASE("Test utils::io::BitStream put and get") {
+        utils::io::BitStreamWriter writer(size_t(2));
+
+        // Bit patterns of varying lengths, crossing byte and word boundaries
+        std::vector<std::pair<uint_fast32_t, uint64_t>> values;
+        for (uint_fast32_t i = 0; i < 500; i++) {
+            const uint_fast32_t length = i % utils::io::BitStream::MAX_WORD_BITS + 1;
+            values.emplace_back(length, (0x0123456789ABCDEFull * (i + 1)) & utils::bits::mask_lsb<uint64_t>(length));
+        }
+
+        for (const auto& [length, value] : values) {
+            writer.put(length, value);
+        }
+        writer.put_bit(1);
+        writer.flush();
+
+        REQUIRE(writer.get_size() >= writer.get_last_byte_position());
+
+        utils::io::BitStreamReader reader(writer.get_buffer(), writer.get_last_byte_position());
+        for (const auto& [length, value] : values) {
+            CHECK(reader.peek(length) == value);
+            CHECK(reader.get_bits(length) == value);
+        }
+        CHECK(reader.get_bit() == 1);
+        CHECK(reader.get(7) == 0);
+
+        // Past the end reads zeroes
+        CHECK(reader.get(32) == 0);
+    }
+
+    SUBCASE("Test utils::io::BitStream MSB first layout") {
+        uint8_t buffer[2] = { 0, 0 };
+        utils::io::BitStreamWriter writer(buffer, 2);
+        writer.put(4, 5);
+        writer.put(3, 0x7);
+        writer.put(9, 0x1FF);
+        CHECK(buffer[0] == 0x5F);
+        CHECK(buffer[1] == 0xFF);
+
+        // Overwriting clears bits
+        writer.reset();
+        writer.put(8, 0x0F);
+        CHECK(buffer[0] == 0x0F);
+        CHECK(buffer[1] == 0xFF);
+
+        // Unmanaged buffers do not grow
+        writer.set_position(12);
+        CHECK_THROWS_AS(writer.put(8, 0), utils::exceptions::Exception);
+
+        utils::io::BitStreamReader reader(buffer, 2);
+        CHECK(reader.get(4) == 0);
+        CHECK(reader.peek(12) == 0xFFF);
+        reader.skip(4);
+        CHECK(reader.get(8) == 0xFF);
+    }
+
+    SUBCASE("Test utils::io::BitStream bytes") {
+        std::vector<uint8_t> data(100);
+        std::iota(data.begin(), data.end(), uint8_t(1));
+
+        utils::io::BitStreamWriter writer(size_t(1));
+        writer.write_bytes(data.data(), data.size());
+        writer.put(3, 0x5);
+        writer.write_bytes(data.data(), data.size());
+        writer.flush();
+
+        utils::io::BitStreamReader reader(writer.get_buffer(), writer.get_last_byte_position());
+        std::vector<uint8_t> out(100);
+
+        reader.read_bytes(out.data(), out.size());
+        CHECK(out == data);
+        CHECK(reader.get(3) == 0x5);
+        reader.read_bytes(out.data(), out.size());
+        CHECK(out == data);
+    }
+
+    SUBCASE("Test utils::io::BitStream unchecked") {
+        uint8_t buffer[16] = { 0 };
+        utils::io::BitStreamWriter writer(buffer, 16);
+        writer.put_unchecked(13, 0x1ABC);
+        writer.put_unchecked(40, 0xFEDCBA9876ull);
+
+        utils::io::BitStreamReader reader(buffer, 16);
+        CHECK(reader.get_bits_unchecked(13) == 0x1ABC);
+        CHECK(reader.get_bits_unchecked(40) == 0xFEDCBA9876ull);
+    }
+
+    SUBCASE("Test utils::io::BitStream LSB first layout") {
+        uint8_t buffer[3] = { 0, 0, 0 };
+        utils::io::LsbBitStreamWriter writer(buffer, 3);
+        writer.put(3, 0x5);
+        writer.put(5, 0x1F);
+        writer.put(12, 0xABC);
+        writer.flush();
+        CHECK(buffer[0] == 0xFD);
+        CHECK(buffer[1] == 0xBC);
+        CHECK(buffer[2] == 0x0A);
+
+        utils::io::LsbBitStreamReader reader(buffer, 3);
+        CHECK(reader.get(3) == 0x5);
+        CHECK(reader.get_bit() == 1);
+        CHECK(reader.peek(4) == 0xF);
+        reader.skip(4);
+        CHECK(reader.get(12) == 0xABC);
+        CHECK(reader.get(32) == 0);
+    }
+
+    SUBCASE("Test utils::io::BitStream 64 bits") {
+        utils::io::BitStreamWriter writer(size_t(1));
+        utils::io::LsbBitStreamWriter lsb_writer(size_t(1));
+
+        for (uint_fast32_t l = 1; l <= 64; l++) {
+            writer.put64(l, 0xF0E1D2C3B4A59687ull);
+            lsb_writer.put64(l, 0xF0E1D2C3B4A59687ull);
+        }
+
+        utils::io::BitStreamReader reader(writer.get_buffer(), writer.get_last_byte_position());
+        utils::io::LsbBitStreamReader lsb_reader(lsb_writer.get_buffer(), lsb_writer.get_last_byte_position());
+
+        for (uint_fast32_t l = 1; l <= 64; l++) {
+            const uint64_t expected = 0xF0E1D2C3B4A59687ull & utils::bits::mask_lsb<uint64_t>(l);
+            CHECK(reader.get64(l) == expected);
+            CHECK(lsb_reader.get64(l) == expected);
+        }
+    }
+
+    SUBCASE("Test utils::io::BitStream variable length codes") {
+        const std::vector<int64_t> values = {
+            0, 1, -1, 2, -2, 63, -64, 64, 127, 128, 300, -300, 1 << 20,
+            INT32_MAX, INT32_MIN, INT64_MAX, INT64_MIN, INT64_MAX - 1
+        };
+
+        utils::io::BitStreamWriter writer(size_t(1));
+        writer.put_bit(1);
+        for (const int64_t v : values) {
+            writer.put_exp_golomb(uint64_t(v) >> 1u);
+            writer.put_exp_golomb(uint64_t(v) >> 3u, 3);
+            writer.put_signed_exp_golomb(v == INT64_MIN ? 0 : v);
+            writer.put_leb128(uint64_t(v));
+            writer.put_sleb128(v);
+            writer.put_zigzag_varint(v);
+        }
+        writer.flush();
+
+        utils::io::BitStreamReader reader(writer.get_buffer(), writer.get_last_byte_position());
+        CHECK(reader.get_bit() == 1);
+        for (const int64_t v : values) {
+            CHECK(reader.get_exp_golomb() == uint64_t(v) >> 1u);
+            CHECK(reader.get_exp_golomb(3) == uint64_t(v) >> 3u);
+            CHECK(reader.get_signed_exp_golomb() == (v == INT64_MIN ? 0 : v));
+            CHECK(reader.get_leb128() == uint64_t(v));
+            CHECK(reader.get_sleb128() == v);
+            CHECK(reader.get_zigzag_varint() == v);
+        }
+
+        // Known encodings
+        uint8_t buffer[4] = { 0 };
+        utils::io::BitStreamWriter known(buffer, 4);
+        known.put_exp_golomb(3);        // 00100
+        known.put_signed_exp_golomb(-1);// 011
+        CHECK(buffer[0] == 0x23);
+        known.reset();
+        known.put_leb128(300);
+        CHECK(buffer[0] == 0xAC);
+        CHECK(buffer[1] == 0x02);
+
+        // Signed edges, INT64_MIN has no 64-bit code number
+        utils::io::BitStreamWriter edges(size_t(1));
+        edges.put_signed_exp_golomb(INT64_MAX);
+        edges.put_signed_exp_golomb(INT64_MIN + 1);
+        CHECK_THROWS_AS(edges.put_signed_exp_golomb(INT64_MIN), utils::exceptions::Exception);
+        edges.flush();
+
+        utils::io::BitStreamReader edges_reader(edges.get_buffer(), edges.get_last_byte_position());
+        CHECK(edges_reader.get_signed_exp_golomb() == INT64_MAX);
+        CHECK(edges_reader.get_signed_exp_golomb() == INT64_MIN + 1);
+
+        std::stringstream stream;
+        utils::io::StreamBitWriter stream_writer(stream, 64);
+        CHECK_THROWS_AS(stream_writer.put_signed_exp_golomb(INT64_MIN), utils::exceptions::Exception);
+
+        // Too long codes
+        const uint8_t zeros[16] = { 0 };
+        utils::io::BitStreamReader bad(const_cast<uint8_t*>(zeros), 16);
+        CHECK_THROWS_AS(bad.get_exp_golomb(), utils::exceptions::Exception);
+
+        const std::vector<uint8_t> ones(11, 0xFF);
+        utils::io::BitStreamReader bad_leb(ones);
+        CHECK_THROWS_AS(bad_leb.get_leb128(), utils::exceptions::Exception);
+    }
+
+    SUBCASE("Test utils::io::BitStream arrays") {
+        std::vector<uint32_t> ints(100);
+        std::vector<double>   doubles(100);
+        for (size_t i = 0; i < ints.size(); i++) {
+            ints[i]    = uint32_t(i * 0x01020304u);
+            doubles[i] = double(i) / 3.0;
+        }
+
+        auto round_trip = [&](auto writer, auto make_reader) {
+            writer.write_array(ints.data(), ints.size());
+            writer.put(5, 0x11);
+            writer.write_array(doubles.data(), doubles.size());
+            writer.template write<uint16_t>(0xBEEF);
+            writer.flush();
+
+            auto reader = make_reader(writer);
+            std::vector<uint32_t> ints_out(ints.size());
+            std::vector<double>   doubles_out(doubles.size());
+
+            reader.read_array(ints_out.data(), ints_out.size());
+            CHECK(ints_out == ints);
+            CHECK(reader.get(5) == 0x11);
+            reader.read_array(doubles_out.data(), doubles_out.size());
+            CHECK(doubles_out == doubles);
+            CHECK(reader.template read<uint16_t>() == 0xBEEF);
+        };
+
+        round_trip(utils::io::BitStreamWriter(size_t(1)), [](auto& w) {
+            CHECK(w.get_buffer()[0] == 0x00);
+            CHECK(w.get_buffer()[7] == 0x04);     // Big endian
+            return utils::io::BitStreamReader(w.get_buffer(), w.get_last_byte_position());
+        });
+        round_trip(utils::io::LsbBitStreamWriter(size_t(1)), [](auto& w) {
+            CHECK(w.get_buffer()[4] == 0x04);     // Little endian
+            return utils::io::LsbBitStreamReader(w.get_buffer(), w.get_last_byte_position());
+        });
+    }
+}
+
+TEST_CASE("Test utils::io::StreamBitReader and StreamBitWriter") {
+    // Enough data to cycle the small windows many times
+    std::vector<std::pair<uint_fast32_t, uint64_t>> values;
+    for (uint_fast32_t i = 0; i < 5000; i++) {
+        const uint_fast32_t length = (i * 7) % utils::io::BitStream::MAX_WORD_BITS + 1;
+        values.emplace_back(length, (0x9E3779B97F4A7C15ull * (i + 1)) & utils::bits::mask_lsb<uint64_t>(length));
+    }
+
+    std::vector<uint8_t> bytes(1000);
+    std::iota(bytes.begin(), bytes.end(), uint8_t(0));
+
+    auto write_all = [&](utils::io::StreamBitWriter& writer) {
+        // Zero bit puts (e.g. Huffman padding) write nothing, also on a word boundary
+        writer.put(0, ~uint64_t(0));
+        CHECK(writer.get_position() == 0);
+
+        for (const auto& [length, value] : values) {
+            writer.put(length, value);
+            writer.put(0, value);
+        }
+        writer.put_bit(1);
+        writer.write_bytes(bytes.data(), bytes.size());
+        writer.flush();
+        writer.write_bytes(bytes.data(), bytes.size());
+        writer.finish();
+    };
+
+    auto read_all = [&](utils::io::StreamBitReader& reader) {
+        for (const auto& [length, value] : values) {
+            REQUIRE(reader.get_bits(length) == value);
+        }
+        CHECK(reader.get_bit() == 1);
+
+        std::vector<uint8_t> out(bytes.size());
+        reader.read_bytes(out.data(), out.size());
+        CHECK(out == bytes);
+
+        reader.align();
+        reader.read_bytes(out.data(), out.size());
+        CHECK(out == bytes);
+        CHECK(reader.eof());
+    };
+
+    SUBCASE("Test utils::io::StreamBitWriter std::iostream") {
+        std::stringstream stream;
+        {
+            utils::io::StreamBitWriter writer(stream, 64);
+            write_all(writer);
+            CHECK(writer.get_position() % 8 == 0);
+        }
+
+        utils::io::StreamBitReader reader(stream, 16);
+        read_all(reader);
+    }
+
+    SUBCASE("Test utils::io::StreamBitWriter chunks") {
+        std::vector<std::vector<uint8_t>> chunks;
+        {
+            utils::io::StreamBitWriter writer(utils::memory::unique_t<utils::io::ByteSink>(
+                new utils::io::ChunkSink(100, [&](const uint8_t *data, size_t n) {
+                    chunks.emplace_back(data, data + n);
+                })), 128);
+            write_all(writer);
+        }
+
+        REQUIRE(chunks.size() > 1);
+        for (size_t i = 0; i + 1 < chunks.size(); i++) {
+            CHECK(chunks[i].size() == 100);
+        }
+
+        size_t next = 0;
+        utils::io::StreamBitReader reader(utils::memory::unique_t<utils::io::ByteSource>(
+            new utils::io::ChunkSource([&]() {
+                if (next == chunks.size()) {
+                    return utils::io::ChunkSource::chunk_t{ nullptr, 0 };
+                }
+                const auto& chunk = chunks[next++];
+                return utils::io::ChunkSource::chunk_t{ chunk.data(), chunk.size() };
+            })), 50);
+        read_all(reader);
+    }
+
+    SUBCASE("Test utils::io::StreamBitWriter file descriptors") {
+        utils::io::TemporaryFile t(false, "", "", "", "");
+
+        write_all(*utils::io::StreamBitWriter::to_file(t.get_name(), 256));
+
+        auto reader = utils::io::StreamBitReader::from_file(t.get_name(), 256);
+        read_all(*reader);
+
+        CHECK_THROWS_AS(utils::io::StreamBitReader::from_file(t.get_name() + "_missing"),
+                        utils::exceptions::FileReadException);
+    }
+
+    SUBCASE("Test utils::io::LsbStreamBitWriter typed") {
+        std::stringstream stream;
+        std::vector<uint64_t> data(1000);
+        std::iota(data.begin(), data.end(), uint64_t(1) << 40u);
+
+        {
+            utils::io::LsbStreamBitWriter writer(stream, 64);
+            for (size_t i = 0; i < 1000; i++) {
+                writer.put_exp_golomb(i * i);
+                writer.put_zigzag_varint(-int64_t(i * 1000));
+                writer.put64(64, data[i]);
+            }
+            writer.write_array(data.data(), data.size());
+        }
+
+        utils::io::LsbStreamBitReader reader(stream, 32);
+        for (size_t i = 0; i < 1000; i++) {
+            CHECK(reader.get_exp_golomb() == i * i);
+            CHECK(reader.get_zigzag_varint() == -int64_t(i * 1000));
+            CHECK(reader.get64(64) == data[i]);
+        }
+
+        std::vector<uint64_t> out(data.size());
+        reader.read_array(out.data(), out.size());
+        CHECK(out == data);
+        reader.align();
+        CHECK(reader.eof());
+    }
+}
+
+TEST_CASE("Test utils::io::LineReader") {
+    const auto read_all = [](utils::io::LineReader& reader) {
+        std::vector<std::string> lines;
+        reader.for_each([&](std::string_view line) { lines.emplace_back(line); });
+        return lines;
+    };
+
+    SUBCASE("Test utils::io::LineReader LF, CRLF and last line") {
+        utils::io::LineReader reader("a\nbc\r\n\n\r\nlast");
+        CHECK(read_all(reader) == std::vector<std::string>{ "a", "bc", "", "", "last" });
+        CHECK(reader.get_line_number() == 5);
+
+        utils::io::LineReader trailing("a\n");
+        CHECK(read_all(trailing) == std::vector<std::string>{ "a" });
+
+        utils::io::LineReader empty("");
+        std::string_view line;
+        CHECK_FALSE(empty.next(line));
+    }
+
+    std::string text;
+    std::vector<std::string> expected;
+    for (size_t i = 0; i < 2000; i++) {
+        expected.push_back(std::string(i % 97, char('a' + i % 26)) + std::to_string(i));
+        text += expected.back() + (i % 3 ? "\n" : "\r\n");
+    }
+    expected.push_back(std::string(5000, 'x'));     // Longer than the stream buffer, no newline
+    text += expected.back();
+
+    SUBCASE("Test utils::io::LineReader streamed") {
+        std::stringstream stream(text);
+        utils::io::LineReader reader(utils::memory::unique_t<utils::io::ByteSource>(
+            utils::memory::new_var<utils::io::IStreamSource>(stream)), 100);
+        CHECK(read_all(reader) == expected);
+    }
+
+    SUBCASE("Test utils::io::LineReader from_file") {
+        utils::io::TemporaryFile t(false, "", "", "", "");
+        utils::io::string_to_file(t.get_name(), text);
+
+        auto reader = utils::io::LineReader::from_file(t.get_name());
+        CHECK(read_all(reader) == expected);
+    }
+
+    SUBCASE("Test utils::io::split_line_chunks") {
+        for (const size_t count : { 1, 3, 8, 100000 }) {
+            const auto chunks = utils::io::split_line_chunks(text, count);
+            CHECK(chunks.size() <= std::max<size_t>(count, 1) + 1);
+
+            std::vector<std::string> lines;
+            std::string joined;
+            for (size_t i = 0; i < chunks.size(); i++) {
+                if (i + 1 < chunks.size()) {
+                    CHECK(chunks[i].back() == '\n');
+                }
+                joined += chunks[i];
+
+                utils::io::LineReader reader(chunks[i]);
+                for (auto& line : read_all(reader)) {
+                    lines.push_back(line);
+                }
+            }
+
+            CHECK(joined == text);
+            CHECK(lines == expected);
+        }
+
+        CHECK(utils::io::split_line_chunks("", 4).empty());
+    }
+}
+
 #endif
@@ -0,0 +1,163 @@
+#include "test_settings.hpp"
+
+#ifdef ENABLE_TESTS
+#include "../utils_lib/external/doctest.hpp"
+
+#include "../utils_lib/algo/algo_lz.hpp"
+#include "../utils_lib/crypto/crypto_packager.hpp"
+
+#include <sstream>
+#include <string>
+
+static std::vector<uint8_t> lz_round_trip(const std::vector<uint8_t>& data, utils::algo::LZ& lz, size_t *compressed = nullptr) {
+    utils::io::BitStreamReader reader(data);
+    const auto frame = lz.compress(reader);
+    REQUIRE(frame);
+
+    if (compressed) {
+        *compressed = frame->get_last_byte_position();
+    }
+
+    utils::io::BitStreamReader frame_reader(frame->get_buffer(), frame->get_last_byte_position());
+    utils::algo::LZ decoder;
+    const auto decoded = decoder.decompress(frame_reader);
+    REQUIRE(decoded);
+
+    return std::vector<uint8_t>(decoded->get_buffer(), decoded->get_buffer() + decoded->get_size());
+}
+
+static std::vector<uint8_t> lz_repetitive(size_t size) {
+    std::string text;
+    for (int i = 0; text.size() < size; i++) {
+        text += "{\"id\": " + std::to_string(i) + ", \"name\": \"entry\", \"tags\": [\"a\", \"b\"], \"value\": " + std::to_string(i * 7919 % 100) + "}\n";
+    }
+    return std::vector<uint8_t>(text.begin(), text.begin() + size);
+}
+
+TEST_CASE("Test utils::algo::LZ round trip") {
+    const std::vector<uint8_t> data = lz_repetitive(300000);
+
+    SUBCASE("Test utils::algo::LZ levels") {
+        size_t previous = SIZE_MAX;
+
+        for (const int level : { 1, 6, 9 }) {
+            utils::algo::LZ lz(level);
+            size_t compressed = 0;
+            CHECK(lz_round_trip(data, lz, &compressed) == data);
+            CHECK(compressed <= previous);
+            CHECK(compressed < data.size() / 4);
+            previous = compressed;
+        }
+    }
+
+    SUBCASE("Test utils::algo::LZ entropy coding") {
+        utils::algo::LZ plain(6, false), entropy(6, true);
+        size_t plain_size = 0, entropy_size = 0;
+        CHECK(lz_round_trip(data, plain, &plain_size) == data);
+        CHECK(lz_round_trip(data, entropy, &entropy_size) == data);
+        CHECK(entropy_size < plain_size);
+    }
+
+    SUBCASE("Test utils::algo::LZ small and incompressible") {
+        utils::algo::LZ lz(9, true, 4096);
+
+        for (size_t size = 0; size < 40; size++) {
+            const std::vector<uint8_t> small(data.begin(), data.begin() + size);
+            CHECK(lz_round_trip(small, lz) == small);
+        }
+
+        // Runs need overlapping matches
+        const std::vector<uint8_t> run(10000, uint8_t('z'));
+        CHECK(lz_round_trip(run, lz) == run);
+
+        std::vector<uint8_t> noise(20000);
+        uint32_t state = 3;
+        for (auto& byte : noise) {
+            state = state * 1103515245u + 12345u;
+            byte = uint8_t(state >> 24);
+        }
+        size_t compressed = 0;
+        CHECK(lz_round_trip(noise, lz, &compressed) == noise);
+        CHECK(compressed < noise.size() + 100);
+    }
+}
+
+TEST_CASE("Test utils::algo::LZ streaming") {
+    const std::vector<uint8_t> data = lz_repetitive(100000);
+    const std::string text(data.begin(), data.end());
+
+    std::stringstream input(text), compressed, output;
+    {
+        utils::io::StreamBitReader reader(input, 1000);
+        utils::io::StreamBitWriter writer(compressed, 1000);
+        utils::algo::LZ lz(6, true, 8192);
+        lz.compress(reader, writer);
+        writer.finish();
+    }
+
+    // Same frame as compressing in memory
+    utils::io::BitStreamReader memory_reader(data);
+    utils::algo::LZ memory_lz(6, true, 8192);
+    const auto frame = memory_lz.compress(memory_reader);
+    CHECK(compressed.str() == std::string(frame->get_buffer(), frame->get_buffer() + frame->get_last_byte_position()));
+
+    {
+        utils::io::StreamBitReader reader(compressed, 1000);
+        utils::io::StreamBitWriter writer(output, 1000);
+        utils::algo::LZ lz;
+        lz.decompress(reader, writer);
+        writer.finish();
+    }
+    CHECK(output.str() == text);
+}
+
+TEST_CASE("Test utils::algo::LZ corrupt frames") {
+    const std::vector<uint8_t> data = lz_repetitive(20000);
+
+    utils::io::BitStreamReader reader(data);
+    utils::algo::LZ lz(6, false, 4096);
+    const auto encoded = lz.compress(reader);
+    const std::vector<uint8_t> frame(encoded->get_buffer(), encoded->get_buffer() + encoded->get_last_byte_position());
+
+    const auto decompress = [](std::vector<uint8_t> bytes) {
+        utils::io::BitStreamReader frame_reader(bytes.data(), bytes.size());
+        utils::algo::LZ decoder;
+        return decoder.decompress(frame_reader);
+    };
+
+    SUBCASE("Test utils::algo::LZ flipped bits") {
+        for (const size_t at : { size_t(30), frame.size() / 2, frame.size() - 8 }) {
+            auto corrupt = frame;
+            corrupt[at] ^= 0x21;
+            CHECK_THROWS_AS(decompress(corrupt), utils::exceptions::Exception);
+        }
+    }
+
+    SUBCASE("Test utils::algo::LZ truncated frame") {
+        CHECK_THROWS_AS(decompress(std::vector<uint8_t>(frame.begin(), frame.end() - 3)), utils::exceptions::Exception);
+        CHECK_THROWS_AS(decompress(std::vector<uint8_t>(frame.begin(), frame.begin() + frame.size() / 2)), utils::exceptions::Exception);
+    }
+
+    SUBCASE("Test utils::algo::LZ not a frame") {
+        CHECK_THROWS_AS(decompress(data), utils::exceptions::Exception);
+    }
+}
+
+TEST_CASE("Test utils::crypto::LZCompress") {
+    utils::crypto::LZCompress packager;
+
+    const std::string text = "LZCompress packs and unpacks, LZCompress packs and unpacks again.";
+    const std::vector<uint8_t> data(text.begin(), text.end());
+
+    utils::io::BitStreamReader reader(data);
+    auto packed = packager.Pack(reader);
+
+    utils::io::BitStreamReader packed_reader(packed.get_buffer(), packed.get_size());
+    auto unpacked = packager.Unpack(packed_reader);
+    CHECK(std::vector<uint8_t>(unpacked.get_buffer(), unpacked.get_buffer() + unpacked.get_size()) == data);
+
+    utils::io::BitStreamReader empty(nullptr, 0);
+    CHECK(packager.Unpack(empty).get_size() == 0);
+}
+
+#endif
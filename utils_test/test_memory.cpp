@@ -5,6 +5,11 @@
 
 #include "../utils_lib/utils_memory.hpp"
 #include <numeric>
+#include <list>
+#include <map>
+#include <set>
+#include <tuple>
+#include <thread>
 
 
 TEST_CASE("Test utils::memory::bit_cast") {
@@ -146,6 +151,93 @@ TEST_CASE("Test utils::memory::reallocArray") {
     utils::memory::delete_array(empty);
 }
 
+TEST_CASE("Test utils::memory::realloc_growable_array") {
+    size_t length = 0;
+    auto test = utils::memory::new_growable_array<int>(length);
+    REQUIRE(test != nullptr);
+
+    SUBCASE("Small arrays") {
+        utils::memory::realloc_growable_array(test, length, 10ull);
+        REQUIRE(test != nullptr);
+        REQUIRE(length == 10);
+
+        std::iota(test, test + 10, 0);
+
+        utils::memory::realloc_growable_array(test, length, 5ull);
+        REQUIRE(length == 5);
+        for (int i = 0; i < 5; i++) {
+            CHECK(test[i] == i);
+        }
+
+        utils::memory::realloc_growable_array(test, length, 10ull);
+        REQUIRE(length == 10);
+        for (int i = 0; i < 5; i++) {
+            CHECK(test[i] == i);
+        }
+        for (int i = 5; i < 10; i++) {
+            CHECK(test[i] == 0);
+        }
+    }
+
+    SUBCASE("Growing past the mapping threshold") {
+        size_t size = 1;
+        utils::memory::realloc_growable_array(test, length, size);
+        test[0] = 42;
+
+        // Grow by 50% each step, like BitStream::resize
+        while (size < 4 * 1024 * 1024) {
+            size += size / 2 + 1;
+            utils::memory::realloc_growable_array(test, length, size);
+            REQUIRE(length == size);
+            REQUIRE(test[0] == 42);
+            CHECK(test[size - 1] == 0);
+            test[size - 1] = int(size);
+        }
+
+        // Shrinking and regrowing must zero the stale tail
+        size_t old_size = size;
+        utils::memory::realloc_growable_array(test, length, size / 2);
+        utils::memory::realloc_growable_array(test, length, old_size);
+        CHECK(test[0] == 42);
+        CHECK(test[old_size - 1] == 0);
+
+        // Back to small
+        utils::memory::realloc_growable_array(test, length, 3ull);
+        REQUIRE(length == 3);
+        CHECK(test[0] == 42);
+    }
+
+    SUBCASE("Sizes that overflow with the header") {
+        CHECK_THROWS_AS(std::ignore = utils::memory::new_growable_array<uint8_t>(SIZE_MAX - 8), std::bad_alloc);
+
+        auto *bytes = utils::memory::new_growable_array<uint8_t>(16);
+        size_t bytes_length = 16;
+        CHECK_THROWS_AS(utils::memory::realloc_growable_array(bytes, bytes_length, SIZE_MAX - 8), std::bad_alloc);
+        CHECK(bytes_length == 16);
+        utils::memory::delete_growable_array(bytes);
+
+        // Element counts whose byte size wraps
+        CHECK_THROWS_AS(std::ignore = utils::memory::new_growable_array<uint64_t>(SIZE_MAX / 4), std::bad_alloc);
+
+        auto *words = utils::memory::new_growable_array<uint64_t>(4);
+        size_t words_length = 4;
+        CHECK_THROWS_AS(utils::memory::realloc_growable_array(words, words_length, SIZE_MAX / 4), std::bad_alloc);
+        CHECK(words_length == 4);
+        utils::memory::delete_growable_array(words);
+    }
+
+    int *empty = nullptr;
+    length = 0;
+    utils::memory::realloc_growable_array(empty, length, 10ull);
+    REQUIRE(empty != nullptr);
+    for (int i = 0; i < 10; i++) {
+        CHECK(empty[i] == 0);
+    }
+
+    utils::memory::delete_growable_array(test);
+    utils::memory::delete_growable_array(empty);
+}
+
 TEST_CASE("Test utils::memory::new_unique_array") {
     auto test_0  = utils::memory::new_unique_array<int>(0);
     auto test_10 = utils::memory::new_unique_array<int>(10);
@@ -185,6 +277,153 @@ TEST_CASE("Test utils::memory::new_unique_flat_array") {
     }
 }
 
+TEST_CASE("Test utils::memory::new_aligned_array") {
+    for (const size_t alignment : { size_t(16), utils::memory::CACHE_LINE_BYTES, utils::memory::PAGE_BYTES }) {
+        auto test = utils::memory::new_aligned_array<int>(100, alignment);
+        REQUIRE(test != nullptr);
+        CHECK(reinterpret_cast<uintptr_t>(test) % alignment == 0);
+
+        for (int i = 0; i < 100; i++) {
+            CHECK(test[i] == 0);
+        }
+
+        std::iota(test, test + 100, 0);
+        CHECK(std::accumulate(test, test + 100, 0) == 4950);
+
+        utils::memory::delete_aligned_array(test, 100, alignment);
+    }
+
+    CHECK_THROWS_AS(std::ignore = utils::memory::new_aligned_array<int>(10, 48), utils::exceptions::Exception);
+    CHECK_THROWS_AS(std::ignore = utils::memory::new_aligned_array<uint64_t>(SIZE_MAX / 4), std::bad_alloc);
+
+    auto test_u = utils::memory::new_unique_aligned_array<double>(33);
+    REQUIRE(test_u.get() != nullptr);
+    CHECK(reinterpret_cast<uintptr_t>(test_u.get()) % utils::memory::CACHE_LINE_BYTES == 0);
+    CHECK(test_u.get_deleter().length == 33);
+}
+
+TEST_CASE("Test utils::memory::new_unique_buffer") {
+    using utils::memory::PageBacking;
+
+    for (const auto backing : { PageBacking::Heap, PageBacking::Pages, PageBacking::HugePages, PageBacking::HugeTLB }) {
+        auto buffer = utils::memory::new_unique_buffer<uint8_t>(10000, backing);
+        REQUIRE(buffer.get() != nullptr);
+        CHECK(reinterpret_cast<uintptr_t>(buffer.get()) % utils::memory::PAGE_BYTES == 0);
+        CHECK(buffer.get_deleter().bytes >= 10000);
+
+        if (buffer.get_deleter().backing == PageBacking::HugePages) {
+            CHECK(reinterpret_cast<uintptr_t>(buffer.get()) % utils::memory::HUGE_PAGE_BYTES == 0);
+        }
+
+        CHECK(std::all_of(buffer.get(), buffer.get() + 10000, [](uint8_t v){ return v == 0; }));
+        std::fill_n(buffer.get(), 10000, uint8_t(0xAB));
+        CHECK(buffer[9999] == 0xAB);
+    }
+
+    CHECK_THROWS_AS(std::ignore = utils::memory::new_unique_buffer<uint8_t>(SIZE_MAX - 8, PageBacking::HugePages), std::bad_alloc);
+    CHECK_THROWS_AS(std::ignore = utils::memory::new_unique_buffer<uint64_t>(SIZE_MAX / 4), std::bad_alloc);
+
+    auto small = utils::memory::new_unique_buffer<uint32_t>(16);
+    CHECK(small.get_deleter().backing == PageBacking::Heap);
+
+    auto shared = utils::memory::new_shared_buffer<uint64_t>(utils::memory::HUGE_PAGE_BYTES / 8);
+    REQUIRE(shared.get() != nullptr);
+    {
+        auto copy = shared;
+        copy[0] = 42;
+    }
+    CHECK(shared[0] == 42);
+    CHECK(shared.use_count() == 1);
+}
+
+TEST_CASE("Test utils::memory::ndarray") {
+    SUBCASE("Row-major") {
+        utils::memory::ndarray<int, 3> arr(2, 3, 4);
+        REQUIRE(arr.size() == 24);
+        REQUIRE(arr.extent(0) == 2);
+        REQUIRE(arr.extent(2) == 4);
+        CHECK(reinterpret_cast<uintptr_t>(arr.data()) % utils::memory::CACHE_LINE_BYTES == 0);
+
+        for (size_t i = 0; i < 2; i++) {
+            for (size_t j = 0; j < 3; j++) {
+                for (size_t k = 0; k < 4; k++) {
+                    CHECK(arr(i, j, k) == 0);
+                    arr(i, j, k) = int(i * 100 + j * 10 + k);
+                }
+            }
+        }
+
+        // Contiguous, last index fastest
+        CHECK(arr.data()[0] == 0);
+        CHECK(arr.data()[1] == 1);
+        CHECK(arr.data()[4] == 10);
+        CHECK(arr.data()[12] == 100);
+
+        auto slice = arr.view().slice(1);
+        REQUIRE(slice.rank() == 2);
+        CHECK(slice(2, 3) == 123);
+
+        const auto copy = arr;
+        arr(0, 0, 0) = 42;
+        CHECK(copy(0, 0, 0) == 0);
+        CHECK(copy(1, 2, 3) == 123);
+
+        CHECK_THROWS_AS(arr.at(2, 0, 0), utils::exceptions::Exception);
+        CHECK(arr.at(1, 1, 1) == 111);
+    }
+
+    SUBCASE("Column-major") {
+        utils::memory::ndarray<int, 2, utils::memory::layout_left> arr(3, 2);
+        arr(1, 0) = 1;
+        arr(0, 1) = 2;
+        CHECK(arr.data()[1] == 1);
+        CHECK(arr.data()[3] == 2);
+    }
+
+    SUBCASE("Tiled") {
+        utils::memory::ndarray<int, 2, utils::memory::layout_tiled<4>> arr(5, 6);
+        REQUIRE(arr.view().required_size() == 8 * 8);
+
+        std::set<size_t> offsets;
+        for (size_t i = 0; i < 5; i++) {
+            for (size_t j = 0; j < 6; j++) {
+                arr(i, j) = int(i * 6 + j);
+                offsets.insert(size_t(&arr(i, j) - arr.data()));
+            }
+        }
+        CHECK(offsets.size() == 30);
+        CHECK(arr(4, 5) == 29);
+
+        // Neighbours within a tile are close in memory
+        CHECK(&arr(1, 0) - &arr(0, 0) == 4);
+        CHECK(&arr(0, 4) - &arr(0, 0) == 16);
+    }
+
+    SUBCASE("Static extents") {
+        utils::memory::fixed_ndarray<uint8_t, 4, 4> arr;
+        static_assert(sizeof(arr) == 16);
+        static_assert(decltype(arr)::size() == 16);
+
+        arr(3, 2) = 7;
+        CHECK(arr.data()[14] == 7);
+        CHECK(arr.view().at(3, 2) == 7);
+    }
+
+    SUBCASE("View over existing memory") {
+        std::vector<int> buffer(12);
+        std::iota(buffer.begin(), buffer.end(), 0);
+
+        utils::memory::ndspan<int, 2> view(buffer.data(), 3, 4);
+        CHECK(view(2, 1) == 9);
+
+        // Transposed view through strides
+        utils::memory::ndspan<int, 2, utils::memory::layout_stride> transposed(
+            buffer.data(), { { 4, 3 }, { 1, 4 } });
+        CHECK(transposed(1, 2) == 9);
+        CHECK(transposed.required_size() == 12);
+    }
+}
+
 TEST_CASE("Test utils::memory::deallocContainer") {
     auto uv_p = utils::memory::new_var<std::vector<int*>>();
     REQUIRE(uv_p != nullptr);
@@ -245,6 +484,182 @@ TEST_CASE("Test utils::memory::new_unique_container") {
     }
 }
 
+TEST_CASE("Test utils::memory::ObjectPool") {
+    struct Item {
+        uint64_t a;
+        uint32_t b;
+        Item(uint64_t a, uint32_t b) : a(a), b(b) {}
+    };
+
+    using pool_t = utils::memory::ObjectPool<Item, 16>;
+
+    SUBCASE("Test utils::memory::ObjectPool create and reuse") {
+        std::vector<Item*> items;
+
+        for (uint32_t i = 0; i < 100; i++) {
+            items.push_back(pool_t::create(uint64_t(i) * 3, i));
+        }
+
+        for (uint32_t i = 0; i < 100; i++) {
+            CHECK(items[i]->a == uint64_t(i) * 3);
+            CHECK(items[i]->b == i);
+            CHECK(reinterpret_cast<uintptr_t>(items[i]) % alignof(Item) == 0);
+        }
+
+        const size_t capacity = pool_t::capacity();
+        REQUIRE(capacity >= 100);
+
+        for (auto *item : items) {
+            pool_t::destroy(item);
+        }
+        items.clear();
+
+        // Freed slots are reused, no new slabs needed
+        for (uint32_t i = 0; i < 100; i++) {
+            items.push_back(pool_t::create(0, i));
+        }
+        CHECK(pool_t::capacity() == capacity);
+
+        for (auto *item : items) {
+            pool_t::destroy(item);
+        }
+    }
+
+    SUBCASE("Test utils::memory::ObjectPool multi-threaded") {
+        std::vector<std::thread> threads;
+        std::vector<int> ok(4, 0);
+
+        for (size_t t = 0; t < ok.size(); t++) {
+            threads.emplace_back([&ok, t]() {
+                std::vector<Item*> items;
+                bool valid = true;
+
+                for (int round = 0; round < 10; round++) {
+                    for (uint32_t i = 0; i < 500; i++) {
+                        items.push_back(pool_t::create(t, i));
+                    }
+                    for (uint32_t i = 0; i < 500; i++) {
+                        valid &= items[i]->a == t && items[i]->b == i;
+                    }
+                    for (auto *item : items) {
+                        pool_t::destroy(item);
+                    }
+                    items.clear();
+                }
+
+                ok[t] = valid;
+            });
+        }
+
+        for (auto& th : threads) {
+            th.join();
+        }
+
+        for (const int valid : ok) {
+            CHECK(valid);
+        }
+    }
+}
+
+TEST_CASE("Test utils::memory::PoolAllocator") {
+    std::list<int, utils::memory::PoolAllocator<int>> l;
+    for (int i = 0; i < 200; i++) {
+        l.push_back(i);
+    }
+    REQUIRE(l.size() == 200);
+    CHECK(std::accumulate(l.begin(), l.end(), 0) == 199 * 200 / 2);
+
+    std::map<int, int, std::less<int>, utils::memory::PoolAllocator<std::pair<const int, int>>> m;
+    for (int i = 0; i < 200; i++) {
+        m[i] = i * 2;
+    }
+    for (int i = 0; i < 200; i++) {
+        CHECK(m[i] == i * 2);
+    }
+
+    std::vector<int, utils::memory::PoolAllocator<int>> v(50, 7);
+    CHECK(std::accumulate(v.begin(), v.end(), 0) == 350);
+}
+
+TEST_CASE("Test utils::memory::Metrics_t") {
+    static utils::memory::Metrics_t m;
+
+    SUBCASE("Test utils::memory::Metrics_t counters") {
+        m.on_alloc(100);
+        m.on_alloc(1000);
+        m.on_free(100);
+
+        const auto snap = m.snapshot();
+        CHECK(snap.TotalAllocated == 1100);
+        CHECK(snap.TotalFreed     == 100);
+        CHECK(snap.AllocCount     == 2);
+        CHECK(snap.FreeCount      == 1);
+        CHECK(snap.CurrentUsage() == 1000);
+        CHECK(snap.Peak           >= 1000);
+
+        CHECK(snap.SizeClasses[7]  == 1);  // (64, 128]
+        CHECK(snap.SizeClasses[10] == 1);  // (512, 1024]
+
+        m.on_free(1000);
+        CHECK(m.CurrentUsage() == 0);
+    }
+
+    SUBCASE("Test utils::memory::Metrics_t multi-threaded") {
+        const auto before = m.snapshot();
+        std::vector<std::thread> threads;
+
+        for (int t = 0; t < 4; t++) {
+            threads.emplace_back([]() {
+                for (int i = 0; i < 10000; i++) {
+                    m.on_alloc(16);
+                    m.on_free(16);
+                }
+            });
+        }
+
+        for (auto& th : threads) {
+            th.join();
+        }
+
+        const auto after = m.snapshot();
+        CHECK(after.AllocCount     - before.AllocCount     == 40000);
+        CHECK(after.FreeCount      - before.FreeCount      == 40000);
+        CHECK(after.TotalAllocated - before.TotalAllocated == 40000 * 16);
+        CHECK(after.CurrentUsage() == before.CurrentUsage());
+    }
+
+    SUBCASE("Test utils::memory::Metrics_t peak") {
+        constexpr size_t chunk = 4096, chunks = 256;
+
+        for (size_t i = 0; i < chunks; i++) {
+            m.on_alloc(chunk);
+        }
+        for (size_t i = 0; i < chunks; i++) {
+            m.on_free(chunk);
+        }
+
+        CHECK(m.Peak() + size_t(utils::memory::internal::METRICS_PEAK_GRANULARITY) >= chunk * chunks);
+    }
+
+    SUBCASE("Test utils::memory::Metrics_t sampled call sites") {
+        static const int site_a = 0, site_b = 0;
+
+        m.set_sample_rate(1);
+        for (int i = 0; i < 5; i++) m.on_alloc(8, &site_a);
+        for (int i = 0; i < 2; i++) m.on_alloc(8, &site_b);
+        m.set_sample_rate(0);
+        m.on_alloc(8, &site_b);
+
+        const auto sites = m.hot_spots(2);
+        REQUIRE(sites.size() == 2);
+        CHECK(sites[0].address == reinterpret_cast<uintptr_t>(&site_a));
+        CHECK(sites[0].count   == 5);
+        CHECK(sites[0].bytes   == 40);
+        CHECK(sites[1].address == reinterpret_cast<uintptr_t>(&site_b));
+        CHECK(sites[1].count   == 2);
+    }
+}
+
 // TODO Other allocator tests
 // T** allocArray(size_t x, size_t y)
 // deallocArray(T** a, size_t y)
@@ -0,0 +1,195 @@
+#include "test_settings.hpp"
+
+#ifdef ENABLE_TESTS
+#include "../utils_lib/external/doctest.hpp"
+
+#include "../utils_lib/utils_serial.hpp"
+
+#include <list>
+#include <map>
+#include <set>
+#include <tuple>
+
+namespace {
+    enum class Colour : uint16_t { Red = 1, Green = 300 };
+
+    struct Inner {
+        int32_t x;
+        double  y;
+
+        bool operator==(const Inner& other) const {
+            return this->x == other.x && this->y == other.y;
+        }
+    };
+
+    struct Record {
+        bool                                  flag;
+        int64_t                               id;
+        Colour                                colour;
+        std::string                           name;
+        std::vector<Inner>                    points;
+        std::map<std::string, uint32_t>       counts;
+        std::optional<std::string>            note;
+        std::variant<int, std::string, Inner> value;
+        std::array<uint8_t, 3>                rgb;
+        std::pair<float, std::list<int>>      pair;
+    };
+
+    class Private {
+        private:
+            std::string key;
+            std::set<int> values;
+
+        public:
+            Private() = default;
+            Private(std::string k, std::set<int> v) : key(std::move(k)), values(std::move(v)) { }
+
+            bool operator==(const Private& other) const {
+                return this->key == other.key && this->values == other.values;
+            }
+
+            UTILS_SERIAL_FIELDS(key, values)
+    };
+
+    struct Sample {
+        static constexpr bool serial_fixed_layout = true;
+
+        uint32_t time;
+        float    value;
+    };
+
+    struct ConfigV1 {
+        static constexpr uint32_t serial_version = 1;
+
+        std::string name;
+        uint32_t    size;
+    };
+
+    struct ConfigV2 {
+        static constexpr uint32_t serial_version = 2;
+
+        std::string name;
+        uint32_t    size;
+        uint32_t    threads = 4;
+        uint32_t    upgraded_from = 0;
+
+        void serial_upgrade(uint32_t version) {
+            this->upgraded_from = version;
+        }
+    };
+}
+
+TEST_CASE("Test utils::io::serial layout") {
+    CHECK(utils::io::serial::serialize(uint32_t(300)) == std::vector<uint8_t>{ 0xAC, 0x02 });
+    CHECK(utils::io::serial::serialize(int16_t(-2))   == std::vector<uint8_t>{ 0x03 });
+    CHECK(utils::io::serial::serialize(uint8_t(200))  == std::vector<uint8_t>{ 200 });
+    CHECK(utils::io::serial::serialize(Colour::Green) == std::vector<uint8_t>{ 0xAC, 0x02 });
+    CHECK(utils::io::serial::serialize(1.0f)          == std::vector<uint8_t>{ 0x00, 0x00, 0x80, 0x3F });
+    CHECK(utils::io::serial::serialize(std::string("ab")) == std::vector<uint8_t>{ 2, 'a', 'b' });
+    CHECK(utils::io::serial::serialize(std::optional<int>()) == std::vector<uint8_t>{ 0 });
+    CHECK(utils::io::serial::serialize(std::variant<int, bool>(true)) == std::vector<uint8_t>{ 1, 1 });
+    CHECK(utils::io::serial::serialize(Inner{ -1, 0.0 }).size() == 9);
+
+    CHECK(utils::io::serial::internal::field_count<Record>() == 10);
+    CHECK(utils::io::serial::internal::field_count<Inner>() == 2);
+}
+
+TEST_CASE("Test utils::io::serial round trip") {
+    SUBCASE("Test utils::io::serial reflected aggregate") {
+        Record r{ true, -1234567890123, Colour::Green, "record",
+                  { { 1, 2.5 }, { -3, 4.25 } }, { { "a", 1 }, { "b", 100000 } },
+                  std::string("note"), Inner{ 7, 8.5 }, { 1, 2, 3 }, { 1.5f, { 4, 5, 6 } } };
+
+        const auto bytes = utils::io::serial::serialize(r);
+        const Record out = utils::io::serial::deserialize<Record>(bytes);
+
+        CHECK(out.flag == r.flag);
+        CHECK(out.id == r.id);
+        CHECK(out.colour == r.colour);
+        CHECK(out.name == r.name);
+        CHECK(out.points == r.points);
+        CHECK(out.counts == r.counts);
+        CHECK(out.note == r.note);
+        CHECK(out.value == r.value);
+        CHECK(out.rgb == r.rgb);
+        CHECK(out.pair == r.pair);
+    }
+
+    SUBCASE("Test utils::io::serial declared fields") {
+        const std::vector<Private> values{ { "x", { 1, 2, 3 } }, { "y", {} } };
+        CHECK(utils::io::serial::deserialize<std::vector<Private>>(utils::io::serial::serialize(values)) == values);
+    }
+
+    SUBCASE("Test utils::io::serial bit streams") {
+        utils::io::LsbBitStreamWriter writer(16);
+        writer.put(3, 5);
+        utils::io::serial::serialize(std::string("unaligned"), writer);
+        writer.flush();
+        utils::io::serial::serialize(Inner{ 1, 2.0 }, writer);
+        writer.put_leb128(42);
+        writer.flush();
+
+        utils::io::LsbBitStreamReader reader(writer.get_buffer(), writer.get_last_byte_position());
+        CHECK(reader.get_bits(3) == 5);
+        CHECK(utils::io::serial::deserialize<std::string>(reader) == "unaligned");
+        reader.flush();
+        CHECK(utils::io::serial::deserialize<Inner>(reader) == Inner{ 1, 2.0 });
+        CHECK(reader.get_leb128() == 42);
+    }
+
+    SUBCASE("Test utils::io::serial malformed data") {
+        auto bytes = utils::io::serial::serialize(std::vector<std::string>{ "abc", "def" });
+        bytes.pop_back();
+        CHECK_THROWS_AS((std::ignore = utils::io::serial::deserialize<std::vector<std::string>>(bytes)), utils::exceptions::Exception);
+
+        const std::vector<uint8_t> huge{ 0xFF, 0xFF, 0xFF, 0xFF, 0x0F };
+        CHECK_THROWS_AS((std::ignore = utils::io::serial::deserialize<std::vector<int>>(huge)), utils::exceptions::Exception);
+        CHECK_THROWS_AS((std::ignore = utils::io::serial::deserialize<std::variant<int, bool>>(std::vector<uint8_t>{ 2, 0 })),
+                        utils::exceptions::Exception);
+    }
+}
+
+TEST_CASE("Test utils::io::serial versioning") {
+    const auto v1 = utils::io::serial::serialize(ConfigV1{ "old", 10 });
+    const ConfigV2 upgraded = utils::io::serial::deserialize<ConfigV2>(v1);
+    CHECK(upgraded.name == "old");
+    CHECK(upgraded.size == 10);
+    CHECK(upgraded.threads == 4);
+    CHECK(upgraded.upgraded_from == 1);
+
+    // Older readers skip appended fields
+    const auto v2 = utils::io::serial::serialize(std::make_pair(ConfigV2{ "new", 20, 8, 0 }, uint8_t(99)));
+    const auto [downgraded, next] = utils::io::serial::deserialize<std::pair<ConfigV1, uint8_t>>(v2);
+    CHECK(downgraded.name == "new");
+    CHECK(downgraded.size == 20);
+    CHECK(next == 99);
+}
+
+TEST_CASE("Test utils::io::serial fixed layout views") {
+    std::vector<Sample> samples(1000);
+    for (uint32_t i = 0; i < samples.size(); i++) {
+        samples[i] = { i, float(i) * 0.5f };
+    }
+
+    utils::io::TemporaryFile t(false, "", "", "", "");
+    utils::io::serial::Writer writer;
+    writer.write(uint8_t(1));   // Misaligns the array
+    writer.write(samples);
+    writer.write(std::vector<double>{ 1.0, -2.0 });
+    utils::io::bytes_to_file(t.get_name(), writer.data(), writer.size());
+
+    const utils::io::MappedFile file = utils::io::map_file(t.get_name());
+    utils::io::serial::Reader reader(file);
+    CHECK(reader.view<uint8_t>() == 1);
+
+    const auto view = reader.view_array<Sample>();
+    REQUIRE(view.size() == samples.size());
+    CHECK(view.bytes() == file.data() + 1 + 2);
+    CHECK(view[999].time == 999);
+    CHECK(view[999].value == 499.5f);
+
+    CHECK(reader.view_array<double>().to_vector() == std::vector<double>{ 1.0, -2.0 });
+    CHECK(reader.remaining() == 0);
+}
+
+#endif